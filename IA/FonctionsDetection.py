@@ -15,6 +15,8 @@ from pathlib import Path
 from typing import List, Dict, Tuple, Optional, Iterable
 import numpy as np
 
+from datagramme_detection import encoder_datagramme
+
 from libcamera import Transform  # ajout à faire en haut du fichier
 
 try:
@@ -968,25 +970,40 @@ def save_obstacles_to_json(
         json.dump(payload, out, ensure_ascii=ensure_ascii, indent=indent)
 
 
+# Numéro d'image du datagramme binaire : la voiture compte les sauts (images perdues)
+_udp_id_image = 0
+
+
 def send_obstacles_udp(
     obstacles: List[Obstacle],
     host: str,
     port: int,
     *,
     timeout: Optional[float] = None,
+    binaire: bool = True,
+    t_capture: Optional[float] = None,
 ) -> int:
     """
-    Envoie la liste des obstacles détectés sur un socket UDP sous forme d'un message JSON unique.
+    Envoie la liste des obstacles détectés sur un socket UDP en un seul datagramme.
+    Par défaut au format binaire versionné (datagramme_detection.py) ; binaire=False
+    conserve l'ancien message JSON, toujours accepté par la voiture.
     Le message contient uniquement des coordonnées relatives (points gauche/droite normalisés), le label,
     la classe numérique et la confiance associée.
 
     Retourne le nombre d'octets envoyés. Lève RuntimeError en cas d'échec d'envoi.
     """
+    global _udp_id_image
     if not host:
         raise ValueError("Le paramètre 'host' ne peut pas être vide.")
 
-    payload = _build_obstacle_payload(obstacles)
-    data = json.dumps(payload, ensure_ascii=True, separators=(",", ":")).encode("utf-8")
+    if binaire:
+        data = encoder_datagramme(
+            obstacles, _udp_id_image, t_capture if t_capture is not None else time.time()
+        )
+        _udp_id_image = (_udp_id_image + 1) & 0xFFFFFFFF
+    else:
+        payload = _build_obstacle_payload(obstacles)
+        data = json.dumps(payload, ensure_ascii=True, separators=(",", ":")).encode("utf-8")
 
     sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
     try:
@@ -1019,11 +1036,15 @@ def run_imx500_detection_stream(
     display: bool = False,
     max_frames: Optional[int] = None,
     udp_timeout: Optional[float] = None,
+    udp_binaire: bool = True,
+    shm: bool = False,
 ) -> None:
     """
     Boucle de détection continue directement depuis la caméra IMX500.
     Capture les frames, exécute le modèle TFLite (float16 recommandé) via l'accélérateur
     et transmet les obstacles via UDP sans sauvegarder d'image intermédiaire.
+    Avec shm=True, les obstacles sont écrits dans l'anneau en mémoire partagée
+    de la voiture (anneau_detection.py) au lieu d'être envoyés en UDP.
     """
     if Picamera2 is None:
         raise RuntimeError(
@@ -1065,6 +1086,11 @@ def run_imx500_detection_stream(
         )
         class_filter = _normalize_classes_arg(classes)
 
+        anneau = None
+        if shm:
+            from anneau_detection import AnneauDetection
+            anneau = AnneauDetection()
+
         window_name = "IMX500 – Détection temps réel"
         target_frames = max_frames if (max_frames and max_frames > 0) else None
         frame_idx = 0
@@ -1073,6 +1099,7 @@ def run_imx500_detection_stream(
 
         while target_frames is None or frame_idx < target_frames:
             array = picam2.capture_array("main")
+            t_capture = time.time()
             if array is None:
                 continue
             if array.ndim == 3 and array.shape[2] == 3:
@@ -1085,9 +1112,12 @@ def run_imx500_detection_stream(
 
             print(f"[IMX500] frame={frame_idx} obstacles={len(obstacles)}")
 
-            if send_udp:
+            if anneau is not None:
+                anneau.publier_obstacles(obstacles, frame_idx, t_capture)
+            elif send_udp:
                 try:
-                    send_obstacles_udp(obstacles, host, port, timeout=udp_timeout)
+                    send_obstacles_udp(obstacles, host, port, timeout=udp_timeout,
+                                       binaire=udp_binaire, t_capture=t_capture)
                 except RuntimeError as exc:
                     print(f"[IMX500][UDP] {exc}")
 
@@ -1172,6 +1202,8 @@ def main():
     )
     parser.add_argument("--max-frames", type=int, default=0, help="Limite de frames en mode --imx500-live (0 = infini).")
     parser.add_argument("--udp-timeout", type=float, default=None, help="Timeout UDP en secondes (optionnel).")
+    parser.add_argument("--shm", action="store_true", help="Mode --imx500-live : écrit dans l'anneau en mémoire partagée de la voiture au lieu de l'UDP.")
+    parser.add_argument("--json", action="store_true", help="Envoie l'ancien message JSON au lieu du datagramme binaire.")
     args = parser.parse_args()
 
     delegate = args.delegate or None
@@ -1208,6 +1240,8 @@ def main():
                 display=args.display,
                 max_frames=args.max_frames if args.max_frames > 0 else None,
                 udp_timeout=args.udp_timeout,
+                udp_binaire=not args.json,
+                shm=args.shm,
             )
         except Exception as exc:
             print(f"Erreur lors de la détection IMX500 en continu: {exc}")
@@ -1250,7 +1284,8 @@ def main():
     print(f"{len(obstacles)} obstacle(s) détecté(s).")
 
     try:
-        nbytes = send_obstacles_udp(obstacles, args.host, args.port, timeout=args.udp_timeout)
+        nbytes = send_obstacles_udp(obstacles, args.host, args.port, timeout=args.udp_timeout,
+                                    binaire=not args.json)
         print(f"Obstacles envoyés ({nbytes} octets) à {args.host}:{args.port}")
     except RuntimeError as e:
         print(f"Erreur UDP: {e}")
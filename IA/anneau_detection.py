@@ -0,0 +1,107 @@
+"""
+Producteur de l'anneau de détections en mémoire partagée, pendant Python de
+voiture_autonome_ws/src/voiture/CommunicationUDP/anneau_detection.h
+(la disposition du segment y est documentée).
+
+Chaque image est un datagramme binaire (datagramme_detection.py) écrit dans
+la case tete % nb_cases sous seqlock, puis la voiture est réveillée par
+FUTEX_WAKE sur le compteur de publications. Si l'appel futex n'est pas
+disponible, la voiture relit le segment périodiquement.
+
+La voiture crée le segment au démarrage (USE_ANNEAU_DETECTION=1) ;
+ouvrir() échoue tant qu'il n'existe pas.
+
+Le seqlock exige des écritures ordonnées et une écriture atomique de tete
+(8 octets). Python ne garantit ni l'un ni l'autre : la publication passe par
+libanneau_publication.so (anneau_publication.c, stores release) quand elle est
+compilée à côté de ce module. Sans elle, seul x86 est accepté (ordre total des
+écritures, stores alignés par ctypes) ; sur le Pi (aarch64), compiler :
+    gcc -O2 -shared -fPIC -o libanneau_publication.so anneau_publication.c
+"""
+
+import ctypes
+import mmap
+import os
+import platform
+import struct
+
+from datagramme_detection import encoder_datagramme
+
+NOM = "/voiture_detections"       # ANNEAU_DETECTION_NOM (config.h)
+MAGIC = b"SDRG"
+VERSION = 1
+
+_ENTETE = struct.Struct("<4sIIIII")   # magic, version, nb_cases, taille_case, publications, réservé
+_OFF_PUBLICATIONS = 16
+_OFF_TETE = 24
+_TAILLE_ENTETE = 64
+_CASE = struct.Struct("<II")           # seq, taille
+
+_SYS_FUTEX = {"x86_64": 202, "aarch64": 98, "armv7l": 240, "armv6l": 240}.get(platform.machine())
+_FUTEX_WAKE = 1
+_X86 = platform.machine() in ("x86_64", "i686", "AMD64")
+_AIDE = os.path.join(os.path.dirname(os.path.abspath(__file__)), "libanneau_publication.so")
+
+
+def _charger_aide():
+    if not os.path.exists(_AIDE):
+        return None
+    lib = ctypes.CDLL(_AIDE)
+    lib.anneau_publier.argtypes = [ctypes.c_void_p, ctypes.c_uint32, ctypes.c_uint32,
+                                   ctypes.c_char_p, ctypes.c_uint32]
+    lib.anneau_publier.restype = None
+    return lib
+
+
+class AnneauDetection:
+    def __init__(self, nom: str = NOM):
+        fd = os.open("/dev/shm" + nom, os.O_RDWR)
+        try:
+            self._mm = mmap.mmap(fd, 0, mmap.MAP_SHARED, mmap.PROT_READ | mmap.PROT_WRITE)
+        finally:
+            os.close(fd)
+        magic, version, self.nb_cases, self.taille_case, _, _ = _ENTETE.unpack_from(self._mm, 0)
+        if magic != MAGIC or version != VERSION:
+            raise RuntimeError(f"Segment {nom} inattendu (magic={magic!r}, version={version})")
+        self._aide = _charger_aide()
+        if self._aide is None and not _X86:
+            self._mm.close()
+            raise RuntimeError(f"{_AIDE} absente : publication sans barrières mémoire "
+                               f"impossible sur {platform.machine()} (voir anneau_publication.c)")
+        self._base = ctypes.c_char.from_buffer(self._mm)
+        self._libc = ctypes.CDLL(None, use_errno=True) if _SYS_FUTEX else None
+        self._publications = ctypes.c_uint32.from_buffer(self._mm, _OFF_PUBLICATIONS)
+        self._tete = ctypes.c_uint64.from_buffer(self._mm, _OFF_TETE)
+
+    def publier(self, datagramme: bytes) -> None:
+        if len(datagramme) > self.taille_case - _CASE.size:
+            raise ValueError("Datagramme trop grand pour une case de l'anneau")
+        if self._aide is not None:
+            self._aide.anneau_publier(ctypes.addressof(self._base), self.nb_cases, self.taille_case,
+                                      datagramme, len(datagramme))
+            return
+        # x86 uniquement : les écritures ne sont pas réordonnées entre elles et
+        # les stores ctypes alignés de 4/8 octets sont atomiques
+        tete = self._tete.value
+        case = _TAILLE_ENTETE + (tete % self.nb_cases) * self.taille_case
+        seq = ctypes.c_uint32.from_buffer(self._mm, case)
+        taille = ctypes.c_uint32.from_buffer(self._mm, case + 4)
+        s = seq.value
+        seq.value = (s + 1) & 0xFFFFFFFF
+        taille.value = len(datagramme)
+        self._mm[case + _CASE.size: case + _CASE.size + len(datagramme)] = datagramme
+        seq.value = (s + 2) & 0xFFFFFFFF
+        del seq, taille
+        self._tete.value = tete + 1
+        self._publications.value = (self._publications.value + 1) & 0xFFFFFFFF
+        if self._libc is not None:
+            self._libc.syscall(_SYS_FUTEX, ctypes.byref(self._publications),
+                               _FUTEX_WAKE, 0x7FFFFFFF, None, None, 0)
+
+    def publier_obstacles(self, obstacles, id_image: int, t_capture: float,
+                          ligne_gauche=(), ligne_droite=()) -> None:
+        self.publier(encoder_datagramme(obstacles, id_image, t_capture, ligne_gauche, ligne_droite))
+
+    def fermer(self) -> None:
+        del self._publications, self._tete, self._base   # sinon mmap refuse de se fermer (tampons exportés)
+        self._mm.close()
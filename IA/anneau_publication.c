@@ -0,0 +1,41 @@
+/*
+ * Publication d'une image dans l'anneau de détections, pour anneau_detection.py.
+ *
+ * Le seqlock demande des écritures ordonnées (seq impair, données, seq pair,
+ * tete, publications) et une écriture atomique de tete (8 octets) : Python ne
+ * le garantit pas hors x86 (aarch64 du Pi). Même séquence que le producteur de
+ * référence du benchmark (voiture_autonome_ws/src/voiture/CommunicationUDP/anneau_detection.c).
+ *
+ * Compilation, dans IA/ :
+ *     gcc -O2 -shared -fPIC -o libanneau_publication.so anneau_publication.c
+ */
+#include <limits.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+#define OFF_PUBLICATIONS 16
+#define OFF_TETE 24
+#define TAILLE_ENTETE 64
+#define TAILLE_CASE_ENTETE 8   // seq u32, taille u32
+
+void anneau_publier(uint8_t* base, uint32_t nb_cases, uint32_t taille_case,
+                    const uint8_t* datagramme, uint32_t n) {
+    uint64_t* tete = (uint64_t*)(base + OFF_TETE);
+    uint32_t* publications = (uint32_t*)(base + OFF_PUBLICATIONS);
+    uint64_t t = __atomic_load_n(tete, __ATOMIC_RELAXED);
+    uint8_t* c = base + TAILLE_ENTETE + (t % nb_cases) * taille_case;
+    uint32_t* seq = (uint32_t*)c;
+
+    uint32_t s = __atomic_load_n(seq, __ATOMIC_RELAXED);
+    __atomic_store_n(seq, s + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);   // seq impair visible avant les données
+    *(uint32_t*)(c + 4) = n;
+    memcpy(c + TAILLE_CASE_ENTETE, datagramme, n);
+    __atomic_store_n(seq, s + 2, __ATOMIC_RELEASE);
+    __atomic_store_n(tete, t + 1, __ATOMIC_RELEASE);
+    __atomic_add_fetch(publications, 1, __ATOMIC_RELEASE);
+    syscall(SYS_futex, publications, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
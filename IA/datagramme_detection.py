@@ -0,0 +1,113 @@
+"""
+Datagramme binaire de détection (caméra -> voiture), pendant Python de
+voiture_autonome_ws/src/voiture/CommunicationUDP/datagramme_detection.h.
+
+Format little-endian, version 1 :
+    en-tête (24 octets) : magic "SDET", version u8, drapeaux u8, taille_entete u16,
+                          id_image u32, t_capture_us u64,
+                          nb_obstacles u8, nb_points_gauche u8, nb_points_droite u8, réservé u8
+    obstacle (20 octets) : class_id u8, confiance u8 (x/255), réservé u16, point_gauche, point_droit
+    point (8 octets)     : x, y, z en mm (int16), theta en 1e-4 rad (int16)
+Les obstacles sont suivis des points de la ligne gauche puis de la ligne droite.
+
+Les coordonnées d'entrée sont en m et rad, comme pour le JSON ; la voiture
+accepte toujours le JSON (tout datagramme sans le magic).
+"""
+
+import struct
+from typing import Iterable, List, Optional, Tuple
+
+MAGIC = b"SDET"
+VERSION = 1
+
+_ENTETE = struct.Struct("<4sBBHIQBBBB")
+_OBSTACLE = struct.Struct("<BBH")
+_POINT = struct.Struct("<hhhh")
+
+MAX_OBSTACLES = 5          # MAX_OBSTACLES_SIMULTANES (config.h)
+MAX_POINTS_MARQUAGE = 64   # MAX_POINTS_MARQUAGE (config.h)
+
+
+def _saturer_i16(v: int) -> int:
+    return max(-32768, min(32767, v))
+
+
+def _pack_point(pt) -> bytes:
+    # int() tronque vers zéro, comme (int)(v*1000) côté C pour le JSON
+    return _POINT.pack(
+        _saturer_i16(int(pt.x * 1000)),
+        _saturer_i16(int(pt.y * 1000)),
+        _saturer_i16(int(pt.z * 1000)),
+        _saturer_i16(int(round(pt.theta * 1e4))),
+    )
+
+
+def encoder_datagramme(
+    obstacles: Iterable,
+    id_image: int,
+    t_capture: float,
+    ligne_gauche: Iterable = (),
+    ligne_droite: Iterable = (),
+) -> bytes:
+    """
+    Encode les obstacles (objets avec class_id, confidence, point_left, point_right)
+    et les points de marquage (objets avec x, y, z, theta) ; t_capture en secondes (epoch).
+    Les listes sont tronquées aux capacités de la voiture.
+    """
+    obstacles = list(obstacles)[:MAX_OBSTACLES]
+    gauche = list(ligne_gauche)[:MAX_POINTS_MARQUAGE]
+    droite = list(ligne_droite)[:MAX_POINTS_MARQUAGE]
+
+    parts = [_ENTETE.pack(
+        MAGIC, VERSION, 0, _ENTETE.size,
+        id_image & 0xFFFFFFFF, int(t_capture * 1e6),
+        len(obstacles), len(gauche), len(droite), 0,
+    )]
+    for obs in obstacles:
+        confiance = max(0, min(255, int(round(obs.confidence * 255))))
+        parts.append(_OBSTACLE.pack(int(obs.class_id) & 0xFF, confiance, 0))
+        parts.append(_pack_point(obs.point_left))
+        parts.append(_pack_point(obs.point_right))
+    parts.extend(_pack_point(pt) for pt in gauche)
+    parts.extend(_pack_point(pt) for pt in droite)
+    return b"".join(parts)
+
+
+def decoder_datagramme(data: bytes) -> Optional[dict]:
+    """
+    Décode un datagramme (outils et vérifications) ; coordonnées rendues en m et rad.
+    Retourne None si le datagramme n'est pas un datagramme binaire valide.
+    """
+    if len(data) < _ENTETE.size:
+        return None
+    magic, version, _, taille_entete, id_image, t_us, nbo, ng, nd, _ = _ENTETE.unpack_from(data)
+    if magic != MAGIC or version != VERSION or taille_entete < _ENTETE.size:
+        return None
+    if len(data) != taille_entete + nbo * 20 + (ng + nd) * _POINT.size:
+        return None
+
+    def point(off: int) -> Tuple[float, float, float, float]:
+        x, y, z, t = _POINT.unpack_from(data, off)
+        return (x / 1000.0, y / 1000.0, z / 1000.0, t * 1e-4)
+
+    off = taille_entete
+    obstacles: List[dict] = []
+    for _ in range(nbo):
+        class_id, confiance, _ = _OBSTACLE.unpack_from(data, off)
+        obstacles.append({
+            "class_id": class_id,
+            "confidence": confiance / 255.0,
+            "point_left": point(off + 4),
+            "point_right": point(off + 4 + _POINT.size),
+        })
+        off += 20
+    gauche = [point(off + k * _POINT.size) for k in range(ng)]
+    off += ng * _POINT.size
+    droite = [point(off + k * _POINT.size) for k in range(nd)]
+    return {
+        "id_image": id_image,
+        "t_capture": t_us / 1e6,
+        "obstacles": obstacles,
+        "ligne_gauche": gauche,
+        "ligne_droite": droite,
+    }
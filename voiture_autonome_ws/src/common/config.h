@@ -29,6 +29,103 @@
 #endif
 #define MEGAPI_BAUDRATE          115200
 
+// === Réacteur d'entrées/sorties (epoll/timerfd, Linux uniquement) ===
+#ifdef __linux__
+#define USE_REACTEUR             1    // 1 = un seul thread pour série, Marvelmind, UDP et TCP
+#else
+#define USE_REACTEUR             0
+#endif
+#define TCP_RECONNEXION_S        5.0  // période des tentatives de connexion au contrôleur
+#define SERIE_PROTOCOLE_BINAIRE  1    // 1 = négocie le protocole binaire (COBS), repli texte sinon
+#define SERIE_NEGOCIATION_MS     500  // attente max de l'acquittement MegaPi
+#define SERIE_CONSIGNE_ZONE_MORTE 1   // écart (unités consigne) en dessous duquel on ne renvoie pas
+#define SERIE_KEEPALIVE_MS       250  // renvoi de la dernière consigne au moins à cette période
+#define UDP_CAMERA_LOT           8    // datagrammes lus par recvmmsg ; seul le plus récent est décodé
+#define UDP_CAMERA_TAILLE_MAX    16384 // au-delà, datagramme tronqué et rejeté (JSON complet ~10 Ko)
+#define UDP_CAMERA_BILAN_S       10.0 // période max du bilan des compteurs caméra dans le journal
+#define USE_ANNEAU_DETECTION     0    // 1 = lit aussi les détections dans l'anneau en mémoire partagée
+#define ANNEAU_DETECTION_NOM     "/voiture_detections"  // segment shm_open (voir anneau_detection.h)
+#define ANNEAU_DETECTION_CASES   8    // images conservées dans l'anneau
+#define ANNEAU_ATTENTE_MS        100  // relecture du segment si le producteur ne réveille pas
+#define POSE_EXTRAPOLATION_MAX_S 0.2  // pose d'une image : position extrapolée au plus de ce délai
+
+// === Suivi d'obstacles (pistes, filtre de Kalman à vitesse constante) ===
+#define SUIVI_CONFIRMATION       3    // associations avant publication d'une piste
+#define SUIVI_MANQUES_MAX        5    // images sans détection avant suppression
+#define SUIVI_PORTE_MM           400  // distance max d'association détection/piste
+#define SUIVI_BRUIT_MESURE_MM    30   // écart-type de la position mesurée
+#define SUIVI_BRUIT_ACCEL        200  // mm/s², écart-type de l'accélération non modélisée
+
+// === Ajustement de la voie sur le marquage (cf. ajustement_voie.h) ===
+#define VOIE_LARGEUR_DEFAUT_MM   400  // largeur a priori, seule contrainte sur un bord non vu
+#define VOIE_LARGEUR_MIN_MM      250  // largeur ajustée plausible...
+#define VOIE_LARGEUR_MAX_MM      700  // ...au-delà, confiance nulle
+#define VOIE_ITERATIONS          4    // ajustements au plus par image (rejet des aberrants entre deux)
+#define VOIE_SEUIL_RESIDU_MM     25   // résidu toujours accepté
+#define VOIE_K_SIGMA             3.0f // au-delà de VOIE_K_SIGMA écarts-types, un point est rejeté
+#define VOIE_POINTS_MIN          4    // points retenus pour qu'une ligne compte
+#define VOIE_POINTS_PLEINS       16   // points retenus pour une confiance pleine sur une ligne
+#define VOIE_CONFIANCE_MIN       0.5f // en deçà, les modules reviennent aux points bruts
+
+// === Grille d'occupation locale (cf. grille_occupation.h) ===
+#define GRILLE_CELLULE_MM        20   // côté d'une cellule
+#define GRILLE_LOG2_CELLULES     8    // 256 x 256 cellules : 5,12 m de côté, 64 Ko
+#define GRILLE_LOG_OCCUPE        40   // log-odds ajouté par une détection (unités de 1/16)
+#define GRILLE_LOG_LIBRE         8    // log-odds retiré le long d'un rayon libre
+#define GRILLE_LOG_MAX           100  // saturation des log-odds (en valeur absolue)
+#define GRILLE_SEUIL_OCCUPE      32   // au-delà, la cellule bloque un chemin
+#define GRILLE_OUBLI             0.85f // log-odds multipliés par ce facteur à chaque image
+#define GRILLE_EPAISSEUR_MM      60   // profondeur marquée derrière la face vue d'un obstacle
+
+// === Génération de trajectoire (fenêtre incrémentale sur l'itinéraire) ===
+#define GENERATION_RECHERCHE_POINTS 20   // points examinés après le plus proche précédent
+#define GENERATION_RECALAGE_MM      300  // au-delà, le point le plus proche est recherché sur tout l'itinéraire
+#define COMPORTEMENT_PERIODE_S      0.1  // période de la boucle de comportement
+#define PROJECTION_HORIZON_MM       3000 // obstacles projetés sur l'itinéraire jusqu'à cette distance devant
+#define PROJECTION_LATERALE_MAX_MM  400  // au-delà de cet écart au chemin, un obstacle est ignoré
+#define DISTANCE_ARRET_MM           100  // arrêt à cette distance (le long du chemin) avant un obstacle
+
+// === Réservation des structures auprès du contrôleur (cf. reservation_structure.h) ===
+#define PONT_STRUCTURE_ID        0    // identifiant du pont chez le contrôleur (< MAX_STRUCTURE)
+#define RESERVATION_DELAI_S      1.0  // sans consigne après ce délai, la demande est renvoyée
+#define RESERVATION_REESSAI_S    0.5  // structure occupée : nouvelle demande après ce délai
+#define RESERVATION_ESSAIS_MAX   5    // demandes sans réponse avant abandon
+#define RESERVATION_ANTICIPATION_MM 500  // demande envoyée à cette distance de l'entrée de la structure
+#define PONT_LONGUEUR_MM         1500 // pont vu par la caméra seulement : libéré à cette distance après son entrée
+
+// === Planificateur en treillis (évitement, cf. planificateur_treillis.h) ===
+#define TREILLIS_NB_LATERAUX     9    // décalages latéraux finaux échantillonnés
+#define TREILLIS_LATERAL_MAX_MM  400  // décalage final extrême (voie voisine si dépassement autorisé)
+#define TREILLIS_NB_LONGITUDINAUX 4   // longueurs de manœuvre échantillonnées
+#define TREILLIS_MANOEUVRE_MIN_MM 400 // plus courte manœuvre ; les suivantes par pas de 300 mm
+#define TREILLIS_HORIZON_MM      2000 // longueur évaluée de chaque candidat
+#define TREILLIS_PAS_MM          50   // pas d'échantillonnage le long du candidat
+#define TREILLIS_PREDICTION_MAX_S 3.0 // prédiction des pistes bornée à ce délai
+#define TREILLIS_DEMI_VOIE_MM    200  // demi-largeur de voie sans marquage
+#define TREILLIS_MARGE_MM        50   // distance minimale aux obstacles et aux lignes
+#define TREILLIS_MARGE_CONFORT_MM 150 // en deçà, la proximité d'un obstacle est pénalisée
+#define TREILLIS_BUDGET_US       2000 // candidats non évalués passé ce délai
+#define TREILLIS_NB_THREADS      2
+#define TREILLIS_MAX_THREADS     4
+#define TREILLIS_POIDS_CONFORT   1e4f // intégrale de d''(s)² (mm⁻¹)
+#define TREILLIS_POIDS_LATERAL   1e-3f // décalage final² (mm²)
+#define TREILLIS_POIDS_PROGRES   1.0f  // distance non parcourue avant collision (mm)
+#define TREILLIS_POIDS_PROXIMITE 1e-2f // empiètement² sur la marge de confort (mm²)
+
+// === Collision par boîtes orientées (cf. collision_boites.h) ===
+#define COLLISION_MAX_ECHANTILLONS 64  // échantillons d'un chemin (multiple de 4)
+#define COLLISION_PAS_MM         50   // pas d'échantillonnage d'une trajectoire publiée
+#define COLLISION_PREDICTION_MAX_S 3.0 // prédiction des pistes bornée à ce délai
+
+// === Horizon de la trajectoire publiée ===
+#define TRAJECTOIRE_HORIZON_S      5.0  // distance couverte = vitesse x ce délai...
+#define TRAJECTOIRE_HORIZON_MIN_MM 200  // ...bornée à l'arrêt...
+#define TRAJECTOIRE_HORIZON_MAX_MM 2000 // ...et à grande vitesse
+
+// === Arbitrage des trajectoires (cf. arbitrage_trajectoire.h) ===
+#define ARBITRAGE_VALIDITE_COMPORTEMENT_S (3 * COMPORTEMENT_PERIODE_S) // proposition de la génération nominale
+#define ARBITRAGE_VALIDITE_EVITEMENT_S    1.0  // manœuvre d'évitement conservée sans nouvelle proposition
+
 
 // === Paramètres système ===
 #define MAX_VOITURES 2 // Nombre de voiture maximal qui peuvent etre géré par le controleur
@@ -41,18 +138,51 @@
 #define MAX_TRAJ_OFFSET 80 // mm
 
 // === Paramètres Types/Messages ===
-#define MAX_POINTS_TRAJECTOIRE 5
+#define NB_CHEMINS_PARTAGES 8    // chemins référencés par les trajectoires (itinéraire, manœuvres, lecteurs)
+#define MAX_POINTS_CHEMIN MAX_ITI
 #define MAX_POINTS_MARQUAGE 64
 #define MAX_PANNEAUX_SIMULTANES 5
 #define MAX_OBSTACLES_SIMULTANES 5
+#define MAX_PISTES_OBSTACLES (2 * MAX_OBSTACLES_SIMULTANES)
 #define MAX_ITI 1000
+#define MAX_INTERVALLES_ITI 32   // structures (et zones de dépassement) par itinéraire
 
 // === Parametre géométriques de la voiture ===
 #define RAYON_ROUE 30.0 // mm
 #define ECARTEMENT_ROUE 150 // mm
+#define LARGEUR_VOITURE_MM 140 // mm
+#define LONGUEUR_VOITURE_MM 240 // mm
 
 // === Coefficients de fusion de données de localisation ===
 #define FUSION_ODO_ALPHA 0.5   // Pondération de l'historique de la position marvelmind lors d'un nouvelle position
 #define FUSION_POSITION_GLOBALE_WEIGHT 0.8  // Pondération odométrie dans la fusion avec les données marvelmind
 
+// === Multilatération à partir des distances brutes Marvelmind ===
+#define USE_MULTILATERATION 1          // 1 = position calculée localement, 0 = solution du modem
+#define MARVELMIND_HAUTEUR_HEDGE 0.0f  // mm, hauteur du hedge monté sur la voiture
+#define MULTILAT_SEUIL_ABERRANT 150.0f // mm, résidu au-delà duquel une balise est rejetée
+#define MULTILAT_RMS_MAX 100.0f        // mm, résidu moyen au-delà duquel la solution est invalide
+#define MULTILAT_RESIDU_MAX 100.0f     // mm, résidu d'une balise retenue au-delà duquel la solution est invalide
+#define MULTILAT_FALLBACK_S 1.0        // s sans solution locale avant de reprendre celle du modem
+
+// === Map-matching sur le graphe routier ===
+#define USE_MAP_MATCHING 1
+#define MAP_NODES_FILE "src/tools/Map/nodes.csv"
+#define MAP_ARCS_FILE  "src/tools/Map/arcs_oriented.csv"
+#define MAP_MATCHING_DIST_MAX 150.0f   // mm, distance max entre la voiture et un arc candidat
+#define MAP_MATCHING_SIGMA_LAT 40.0f   // mm, écart-type latéral du modèle d'observation
+#define MAP_MATCHING_SIGMA_CAP 30.0f   // degrés, écart-type de cap du modèle d'observation
+#define MAP_MATCHING_GAIN 0.2f         // part de l'écart latéral corrigée à chaque cycle
+
+// === Filtre particulaire (alternative à la fusion pondérée) ===
+#define USE_FILTRE_PARTICULES 0
+#define PF_NB_PARTICULES 4096
+#define PF_NB_THREADS 4
+#define PF_MAX_THREADS 8
+#define PF_SIGMA_MARVELMIND 80.0f      // mm
+#define PF_SIGMA_ROUTE 60.0f           // mm, écart-type de la distance à la ligne centrale
+#define PF_BRUIT_DISTANCE 0.05f        // part de la distance parcourue
+#define PF_BRUIT_CAP 2.0f              // degrés par cycle
+#define PF_VRAISEMBLANCE_KIDNAPPING 0.02f // vraisemblance moyenne sous laquelle on réinitialise
+
 #endif
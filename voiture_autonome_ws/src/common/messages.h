@@ -52,8 +52,8 @@ typedef struct {
     float y; // mm
     float z; // mm
     float theta; // degrés
-    int pont;
-    int depacement;
+    int pont;        // 0 hors structure, sinon identifiant de la structure + 1
+    int depacement;  // 1 si le dépassement est autorisé sur ce point
 } Point;
 
 
@@ -123,19 +123,39 @@ typedef struct {
     Tache écrivaine : Gestion de comportement
     Tache lectrice : Suiveur de trajectoire
     Description : Donne les points que la voiture doit suivre, la vitesse, et si la voiture 
-        doit se garer.
+        doit se garer. Les points ne sont pas recopiés : ils sont une vue sur un chemin
+        partagé (itinéraire ou manœuvre, cf. voiture_globals.h) sur un horizon qui
+        s'allonge avec la vitesse.
 */
 
 
 typedef struct {
     int nb_points;
-    Point points[MAX_POINTS_TRAJECTOIRE]; // Tableau des points absolus représentant la trajectoire que la voiture doit suivre
+    const Point* points; // Vue sur les points absolus du chemin partagé que la voiture doit suivre
+    int chemin; // Chemin partagé qui porte les points (-1 : aucun)
+    float horizon; // [mm] longueur couverte par les points
+    unsigned int sequence; // Change quand la trajectoire gagnante change (cf. arbitrage_trajectoire.h)
     float vitesse; // [mm/s] vitesse vers laquelle la voiture doit converger
     float vitesse_max; // [mm/s] vitesse maximale autorisée que la voiture ne doit jamais dépasser
     int arreter_fin; // Indique si la voiture doit conserver sa vitesse ou si elle doit prévoir de l'arreter  
 } Trajectoire;
 
 
+/*  Type Communication Interne : PositionCarte
+    Tache écrivaine : Localisation (map-matching)
+    Tache lectrice : Gestion de comportement, Suivi de trajectoire
+    Description : Position de la voiture rapportée au graphe routier : arc le plus
+        probable, abscisse le long de l'arc et écart latéral à sa ligne centrale.
+*/
+typedef struct {
+    int arc_id;      // -1 si aucun arc n'est associé
+    float s;         // mm, abscisse curviligne depuis le noeud de départ de l'arc
+    float d_lat;     // mm, écart latéral signé (> 0 à gauche du sens de l'arc)
+    float cap_arc;   // degrés, direction de l'arc au point projeté
+    float confiance; // [0, 1]
+} PositionCarte;
+
+
 /*  Type Utilitaire : Panneau 
     Description : Indique la présence d'un panneau sur la voie
 */
@@ -161,6 +181,28 @@ typedef struct {
     Point ligne_droite[MAX_POINTS_MARQUAGE];
 } MarquageSol;
 
+/*  Type Communication Interne : ModeleVoie
+    Tache écrivaine : Réception caméra (ajustement_voie.h, une fois par image)
+    Tache lectrice : Gestion de comportement, évitement
+    Description : Bords de la voie ajustés sur le marquage au sol, en repère voiture
+        à l'arrivée de l'image (x devant, y à gauche) : deux bords parallèles
+        y = bord + a1.x + a2.x², la ligne centrale étant à mi-chemin.
+*/
+typedef struct {
+    int valide;             // 0 si aucune ligne n'a assez de points retenus
+    float gauche, droite;   // mm, ordonnée des bords en x = 0
+    float a1;               // pente commune
+    float a2;               // 1/mm, terme quadratique commun
+    float portee;           // mm, x maximal des points retenus (au-delà : extrapolation)
+    float largeur;          // mm, gauche - droite
+    float decalage;         // mm, ordonnée de la ligne centrale en x = 0 (> 0 : voiture à droite du centre)
+    float cap;              // degrés, direction de la voie par rapport à la voiture (> 0 : vers la gauche)
+    float courbure;         // 1/mm en x = 0 (> 0 : virage à gauche)
+    float residu;           // mm, écart quadratique moyen des points retenus
+    int retenus_gauche, retenus_droite;
+    float confiance;        // [0, 1]
+} ModeleVoie;
+
 /*  Message TCP IA/V : DonneesDetection 
     Tache émetrice/ecrivaine : Detection Environnement
     Tache réceptrice/lectrice : Gestion de comportement
@@ -175,12 +217,87 @@ typedef struct {
 } DonneesDetection;
 
 
+/*  Type Communication Interne : AnnotationItineraire
+    Tache écrivaine : Réception de l'itinéraire (une fois par Itineraire reçu)
+    Tache lectrice : Gestion de comportement
+    Description : Intervalles de points consécutifs de l'itinéraire (structures,
+        zones de dépassement), repérés par indices et par abscisse curviligne
+        (mm le long de l'itinéraire depuis son premier point). Chaque liste est
+        triée par abscisse et sans recouvrement : recherche dichotomique.
+*/
+typedef struct {
+    int id;                 // structure : Point.pont - 1 ; dépassement : -1
+    int entree, sortie;     // indices du premier et du dernier point de l'intervalle
+    float s_entree, s_sortie;
+} IntervalleItineraire;
+
+typedef struct {
+    int nb_structures;
+    IntervalleItineraire structure[MAX_INTERVALLES_ITI];
+    int nb_depassements;
+    IntervalleItineraire depassement[MAX_INTERVALLES_ITI];
+    float abscisse[MAX_ITI];  // abscisse curviligne de chaque point
+} AnnotationItineraire;
+
+
+/*  Type Communication Interne : DetectionMonde
+    Tache écrivaine : Réception caméra (une fois par DonneesDetection reçue)
+    Tache lectrice : Suivi d'obstacles, Gestion de comportement, évitement
+    Description : La même image de détection ramenée en repère monde avec la pose
+        de la voiture à l'arrivée de l'image ; évite aux modules de refaire la
+        conversion. Les z sont ceux de la détection (non transformés). Le modèle
+        de voie reste en repère voiture (pose ci-dessous).
+*/
+typedef struct {
+    PositionVoiture pose;     // pose utilisée pour la conversion
+    int pose_valide;          // 0 si la localisation n'a encore rien publié
+    int count;
+    Obstacle obstacle[MAX_OBSTACLES_SIMULTANES];  // coins gauche/droite en repère monde
+    Point centre[MAX_OBSTACLES_SIMULTANES];       // milieu des deux coins
+    MarquageSol marquage_sol;                     // lignes en repère monde
+    ModeleVoie voie;                              // bords ajustés, en repère voiture
+} DetectionMonde;
+
+
+/*  Type Communication Interne : ObstaclesSuivis
+    Tache écrivaine : Suivi d'obstacles (à chaque DonneesDetection reçue)
+    Tache lectrice : Gestion de comportement, évitement
+    Description : Obstacles associés d'une image à l'autre, avec un identifiant
+        stable et une vitesse estimée en repère monde. Seules les pistes confirmées
+        sont publiées ; une piste supprimée l'est une dernière fois avec PISTE_TERMINEE.
+*/
+typedef enum {
+    PISTE_NOUVELLE = 0,   // confirmée à cette image
+    PISTE_MISE_A_JOUR,    // associée à une détection de cette image
+    PISTE_PREDITE,        // non vue à cette image, position extrapolée
+    PISTE_TERMINEE        // supprimée à cette image (dernière publication)
+} EtatPiste;
+
+typedef struct {
+    int id;               // stable tant que la piste existe, jamais réutilisé
+    ObstacleType type;
+    EtatPiste etat;
+    float x, y;           // mm, centre filtré (repère monde)
+    float vx, vy;         // mm/s
+    Point pointg, pointd; // repère monde : centre filtré + demi-largeur mesurée
+    int age;              // images depuis la création
+    int manques;          // images consécutives sans détection associée
+} PisteObstacle;
+
+typedef struct {
+    unsigned long image;  // numéro de l'image de détection qui a produit ces pistes
+    int count;
+    PisteObstacle piste[MAX_PISTES_OBSTACLES];
+} ObstaclesSuivis;
+
+
 typedef struct {
     int overrun;
     float ref1, ref2;
     float speed1, speed2;
     float angle;
     float vfiltre1, vfiltre2;
+    unsigned int t_megapi_us; // horodatage MegaPi (protocole binaire uniquement, 0 sinon)
 } SensorData;
 
 
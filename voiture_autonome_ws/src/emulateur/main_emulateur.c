@@ -0,0 +1,319 @@
+#define _GNU_SOURCE  // posix_openpt(), ppoll()
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <termios.h>
+#include <time.h>
+#include "logger.h"
+#include "utils.h"
+#include "messages.h"
+#include "protocole_binaire.h"
+#include "modele_megapi.h"
+
+#define TAG "emulateur"
+
+/*  Émulateur de la MegaPi sur pseudo-terminal
+
+    Crée un pty dont l'esclave joue le rôle de /dev/ttyAMA0 :
+        ./build/emulateur/emulateur_megapi -l /tmp/megapi &
+        ./build/voiture/voiture -p /tmp/megapi
+    Côté protocole, se comporte comme le firmware : démarre en texte (lignes
+    capteurs, consignes JSON), passe en binaire sur PROTO_BINAIRE_REQUETE et
+    coupe les moteurs si aucune consigne n'arrive pendant le délai de garde.
+*/
+
+#define LIGNE_MAX 256
+
+typedef struct {
+    double frequence_hz;
+    bool binaire_autorise;
+    const char* lien;
+    double duree_s;
+    double garde_s;
+    unsigned int graine;
+    ParamsMegaPi modele;
+} OptionsEmulateur;
+
+typedef struct {
+    unsigned long capteurs_emis;
+    unsigned long emissions_perdues;    // pty plein (la voiture ne lit plus assez vite)
+    unsigned long consignes_recues;
+    unsigned long consignes_invalides;
+    unsigned long echeances_manquees;
+    unsigned long coupures_garde;
+} StatsEmulateur;
+
+static volatile sig_atomic_t arret = 0;
+static StatsEmulateur stats;
+static ModeleMegaPi modele;
+static bool binaire = false;    // protocole négocié par la voiture
+static DecodeurTrames decodeur;
+static uint8_t seq_emission = 0;
+static char ligne[LIGNE_MAX];
+static size_t ligne_len = 0;
+static struct timespec t_derniere_consigne;
+static struct timespec t_debut;
+
+static void sur_signal(int s) {
+    (void)s;
+    arret = 1;
+}
+
+static void print_usage(const char* prog) {
+    fprintf(stderr,
+            "Usage: %s [-f <Hz>] [-l <lien>] [-d <s>] [-w <s>] [-b <ratio>] [-s <graine>] [-t]\n"
+            "  -f  fréquence d'émission des capteurs (défaut 50 Hz)\n"
+            "  -l  lien symbolique vers l'esclave du pty (ex. /tmp/megapi)\n"
+            "  -d  durée de fonctionnement en s (défaut : jusqu'à Ctrl-C)\n"
+            "  -w  délai de garde sans consigne avant arrêt des moteurs (défaut 1 s, 0 = aucun)\n"
+            "  -b  bruit relatif des codeurs (défaut 0.02)\n"
+            "  -s  graine du bruit\n"
+            "  -t  texte uniquement (ignore la demande de protocole binaire)\n",
+            prog);
+}
+
+static void lire_options(int argc, char* argv[], OptionsEmulateur* o) {
+    o->frequence_hz = 50.0;
+    o->binaire_autorise = true;
+    o->lien = NULL;
+    o->duree_s = 0.0;
+    o->garde_s = 1.0;
+    o->graine = 1;
+    params_megapi_defaut(&o->modele);
+
+    int c;
+    while ((c = getopt(argc, argv, "f:l:d:w:b:s:th")) != -1) {
+        switch (c) {
+            case 'f': o->frequence_hz = atof(optarg); break;
+            case 'l': o->lien = optarg; break;
+            case 'd': o->duree_s = atof(optarg); break;
+            case 'w': o->garde_s = atof(optarg); break;
+            case 'b': o->modele.bruit_ratio = atof(optarg); break;
+            case 's': o->graine = (unsigned int)strtoul(optarg, NULL, 10); break;
+            case 't': o->binaire_autorise = false; break;
+            case 'h': print_usage(argv[0]); exit(EXIT_SUCCESS);
+            default:  print_usage(argv[0]); exit(EXIT_FAILURE);
+        }
+    }
+    if (o->frequence_hz <= 0.0) {
+        fprintf(stderr, "Fréquence invalide\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+// Crée le pty. On garde l'esclave ouvert (en mode brut) pour que le maître ne
+// voie pas d'erreur tant que la voiture n'est pas connectée, ni entre deux lancements.
+static int ouvrir_pty(const char* lien, int* esclave) {
+    int maitre = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (maitre < 0 || grantpt(maitre) != 0 || unlockpt(maitre) != 0) {
+        ERR(TAG, "Impossible de créer le pty : errno %d", errno);
+        if (maitre >= 0) close(maitre);
+        return -1;
+    }
+    const char* nom = ptsname(maitre);
+    *esclave = open(nom, O_RDWR | O_NOCTTY);
+    struct termios tty;
+    if (*esclave < 0 || tcgetattr(*esclave, &tty) != 0) {
+        ERR(TAG, "Impossible d'ouvrir %s : errno %d", nom, errno);
+        close(maitre);
+        return -1;
+    }
+    cfmakeraw(&tty);
+    tcsetattr(*esclave, TCSANOW, &tty);
+
+    if (lien) {
+        unlink(lien);
+        if (symlink(nom, lien) != 0)
+            WARN(TAG, "Impossible de créer le lien %s : errno %d", lien, errno);
+    }
+    INFO(TAG, "MegaPi émulée sur %s%s%s", nom, lien ? " -> " : "", lien ? lien : "");
+    return maitre;
+}
+
+static uint32_t micros(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint32_t)(timespec_diff_s(t_debut, t) * 1e6);
+}
+
+// Écriture non bloquante : si la voiture ne lit plus, la donnée est perdue (comme sur l'UART)
+static void emettre(int fd, const void* buf, size_t len) {
+    ssize_t n = write(fd, buf, len);
+    if (n != (ssize_t)len) stats.emissions_perdues++;
+}
+
+// Le 0x00 de tête sépare l'acquittement des lignes texte encore en transit
+static void envoyer_hello(int fd) {
+    uint8_t payload[1] = { PROTO_BINAIRE_VERSION };
+    uint8_t trame[TRAME_ENCODEE_MAX + 1];
+    trame[0] = 0x00;
+    size_t n = encoder_trame(MSG_SERIE_HELLO, seq_emission++, micros(), payload, sizeof(payload), trame + 1);
+    emettre(fd, trame, n + 1);
+}
+
+static void envoyer_capteurs(int fd, int overrun) {
+    SensorData data = {0};
+    modele_capteurs(&modele, &data);
+    data.overrun = overrun;
+
+    if (binaire) {
+        uint8_t payload[PAYLOAD_CAPTEURS];
+        uint8_t trame[TRAME_ENCODEE_MAX];
+        serialiser_capteurs(&data, payload);
+        size_t n = encoder_trame(MSG_SERIE_CAPTEURS, seq_emission++, micros(), payload, sizeof(payload), trame);
+        emettre(fd, trame, n);
+    } else {
+        char buf[LIGNE_MAX];
+        int n = snprintf(buf, sizeof(buf),
+                         "overrun:%d, ref1:%.0f, ref2:%.0f, speed1:%.4f, speed2:%.4f, angle:%.2f, vfiltre1:%.2f, vfiltre2:%.2f\n",
+                         data.overrun, data.ref1, data.ref2, data.speed1, data.speed2,
+                         data.angle, data.vfiltre1, data.vfiltre2);
+        emettre(fd, buf, (size_t)n);
+    }
+    stats.capteurs_emis++;
+}
+
+static void nouvelle_consigne(int consigneD, int consigneG) {
+    modele_appliquer_consigne(&modele, consigneD, consigneG);
+    clock_gettime(CLOCK_MONOTONIC, &t_derniere_consigne);
+    stats.consignes_recues++;
+}
+
+// Ligne texte complète : demande de protocole ou consigne JSON
+static void traiter_ligne(int fd, const OptionsEmulateur* o) {
+    while (ligne_len > 0 && (ligne[ligne_len - 1] == '\r' || ligne[ligne_len - 1] == '\n'))
+        ligne_len--;
+    ligne[ligne_len] = '\0';
+    if (ligne_len == 0) return;
+
+    if (strncmp(ligne, PROTO_BINAIRE_REQUETE, strlen(PROTO_BINAIRE_REQUETE) - 1) == 0) {
+        if (!o->binaire_autorise) return;   // firmware ancien : la voiture reste en texte
+        envoyer_hello(fd);
+        if (!binaire) INFO(TAG, "Passage en protocole binaire");
+        binaire = true;
+        init_decodeur_trames(&decodeur);
+        return;
+    }
+
+    int d, g;
+    if (sscanf(ligne, "{\"consigneD\":%d,\"consigneG\":%d}", &d, &g) == 2) {
+        // Une voiture relancée en texte : on la suit
+        if (binaire) INFO(TAG, "Retour au protocole texte");
+        binaire = false;
+        nouvelle_consigne(d, g);
+    } else if (!binaire) {
+        stats.consignes_invalides++;
+    }
+}
+
+static void traiter_octets(int fd, const uint8_t* buf, size_t n, const OptionsEmulateur* o) {
+    for (size_t i = 0; i < n; i++) {
+        if (binaire) {
+            TrameSerie trame;
+            int d, g;
+            if (decoder_octet(&decodeur, buf[i], &trame)) {
+                if (deserialiser_consigne(&trame, &d, &g)) nouvelle_consigne(d, g);
+                else stats.consignes_invalides++;
+            }
+            // Une trame ne contient pas de 0x00 : on y remet la ligne texte à zéro
+            if (buf[i] == 0x00) { ligne_len = 0; continue; }
+        }
+        if (buf[i] == '\n') {
+            traiter_ligne(fd, o);
+            ligne_len = 0;
+        } else if (ligne_len < LIGNE_MAX - 1) {
+            ligne[ligne_len++] = (char)buf[i];
+        }
+    }
+}
+
+static void afficher_stats(void) {
+    INFO(TAG, "Capteurs émis : %lu (perdus : %lu, échéances manquées : %lu), consignes reçues : %lu "
+              "(invalides : %lu), coupures de garde : %lu",
+         stats.capteurs_emis, stats.emissions_perdues, stats.echeances_manquees,
+         stats.consignes_recues, stats.consignes_invalides, stats.coupures_garde);
+}
+
+int main(int argc, char* argv[]) {
+    OptionsEmulateur o;
+    lire_options(argc, argv, &o);
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = sur_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    int esclave;
+    int maitre = ouvrir_pty(o.lien, &esclave);
+    if (maitre < 0) return EXIT_FAILURE;
+
+    init_modele_megapi(&modele, &o.modele, o.graine);
+    init_decodeur_trames(&decodeur);
+    INFO(TAG, "Capteurs à %.0f Hz, protocole binaire %s, garde %.1f s",
+         o.frequence_hz, o.binaire_autorise ? "accepté" : "refusé", o.garde_s);
+
+    const double periode = 1.0 / o.frequence_hz;
+    struct timespec t_modele, t;
+    clock_gettime(CLOCK_MONOTONIC, &t_debut);
+    t_modele = t_derniere_consigne = t_debut;
+    double prochaine = periode;   // échéance suivante, en s depuis t_debut
+    int overrun = 0;
+
+    struct pollfd pfd = { .fd = maitre, .events = POLLIN };
+    while (!arret) {
+        clock_gettime(CLOCK_MONOTONIC, &t);
+        double maintenant = timespec_diff_s(t_debut, t);
+        if (o.duree_s > 0.0 && maintenant >= o.duree_s) break;
+
+        if (maintenant >= prochaine) {
+            modele_avancer(&modele, timespec_diff_s(t_modele, t));
+            t_modele = t;
+
+            if (o.garde_s > 0.0 && (modele.consigneD != 0 || modele.consigneG != 0) &&
+                timespec_diff_s(t_derniere_consigne, t) > o.garde_s) {
+                modele_appliquer_consigne(&modele, 0, 0);
+                stats.coupures_garde++;
+                WARN(TAG, "Aucune consigne depuis %.1f s : arrêt des moteurs", o.garde_s);
+            }
+
+            envoyer_capteurs(maitre, overrun);
+            overrun = 0;
+            prochaine += periode;
+            if (prochaine < maintenant) {
+                // Retard (machine chargée) : on ne rattrape pas, on le signale dans overrun
+                int manquees = (int)((maintenant - prochaine) / periode) + 1;
+                overrun = manquees;
+                stats.echeances_manquees += manquees;
+                prochaine += manquees * periode;
+            }
+        }
+
+        double attente = prochaine - maintenant;
+        if (attente < 0.0) attente = 0.0;
+        struct timespec ts = { .tv_sec = (time_t)attente, .tv_nsec = (long)((attente - (time_t)attente) * 1e9) };
+        int r = ppoll(&pfd, 1, &ts, NULL);
+        if (r < 0 && errno != EINTR) {
+            ERR(TAG, "ppoll : errno %d", errno);
+            break;
+        }
+        if (r > 0 && (pfd.revents & POLLIN)) {
+            uint8_t buf[1024];
+            ssize_t n;
+            while ((n = read(maitre, buf, sizeof(buf))) > 0)
+                traiter_octets(maitre, buf, (size_t)n, &o);
+        }
+    }
+
+    afficher_stats();
+    if (o.lien) unlink(o.lien);
+    close(esclave);
+    close(maitre);
+    return 0;
+}
@@ -0,0 +1,76 @@
+// modele_megapi.c
+#include "modele_megapi.h"
+#include "config.h"
+#include "utils.h"
+#include <math.h>
+#include <stdlib.h>
+
+void params_megapi_defaut(ParamsMegaPi* p) {
+    p->tau_s = 0.12;
+    p->vitesse_max = 400.0;
+    p->ticks_par_tour = 360;
+    p->bruit_ratio = 0.02;
+    p->alpha_filtre = 0.2;
+    p->bruit_cap_deg = 0.05;
+}
+
+void init_modele_megapi(ModeleMegaPi* m, const ParamsMegaPi* p, unsigned int graine) {
+    ModeleMegaPi zero = {0};
+    *m = zero;
+    m->p = *p;
+    m->graine = graine;
+}
+
+// Box-Muller, tirage N(0, 1)
+static double gaussienne(unsigned int* graine) {
+    double u1 = (rand_r(graine) + 1.0) / ((double)RAND_MAX + 2.0);
+    double u2 = (rand_r(graine) + 1.0) / ((double)RAND_MAX + 2.0);
+    return sqrt(-2.0 * log(u1)) * cos(2.0 * PI * u2);
+}
+
+static double saturer(double v, double max) {
+    return v > max ? max : (v < -max ? -max : v);
+}
+
+void modele_appliquer_consigne(ModeleMegaPi* m, int consigneD, int consigneG) {
+    m->consigneD = consigneD;
+    m->consigneG = consigneG;
+}
+
+void modele_avancer(ModeleMegaPi* m, double dt) {
+    if (dt <= 0.0) return;
+
+    // Moteurs : premier ordre vers la consigne saturée
+    double k = 1.0 - exp(-dt / m->p.tau_s);
+    m->vG += (saturer(m->consigneG, m->p.vitesse_max) - m->vG) * k;
+    m->vD += (saturer(m->consigneD, m->p.vitesse_max) - m->vD) * k;
+
+    m->rouesG += m->vG / RAYON_ROUE * dt;
+    m->rouesD += m->vD / RAYON_ROUE * dt;
+    m->cap_rad += (m->vD - m->vG) / (2.0 * ECARTEMENT_ROUE) * dt;
+
+    // Codeurs : la mesure n'est connue qu'au tick près, puis bruitée
+    double rad_par_tick = 2.0 * PI / m->p.ticks_par_tour;
+    long ticksG = (long)floor(m->rouesG / rad_par_tick);
+    long ticksD = (long)floor(m->rouesD / rad_par_tick);
+    m->mesureG = (ticksG - m->ticksG) * rad_par_tick / dt * (1.0 + m->p.bruit_ratio * gaussienne(&m->graine));
+    m->mesureD = (ticksD - m->ticksD) * rad_par_tick / dt * (1.0 + m->p.bruit_ratio * gaussienne(&m->graine));
+    m->ticksG = ticksG;
+    m->ticksD = ticksD;
+
+    m->filtreG += m->p.alpha_filtre * (m->mesureG - m->filtreG);
+    m->filtreD += m->p.alpha_filtre * (m->mesureD - m->filtreD);
+}
+
+void modele_capteurs(ModeleMegaPi* m, SensorData* data) {
+    double cap_deg = fmod(m->cap_rad * 180.0 / PI + m->p.bruit_cap_deg * gaussienne(&m->graine), 360.0);
+    if (cap_deg < 0.0) cap_deg += 360.0;
+
+    data->ref1 = (float)m->consigneG;
+    data->ref2 = (float)m->consigneD;
+    data->speed1 = (float)m->mesureG;
+    data->speed2 = (float)m->mesureD;
+    data->angle = (float)cap_deg;
+    data->vfiltre1 = (float)m->filtreG;
+    data->vfiltre2 = (float)m->filtreD;
+}
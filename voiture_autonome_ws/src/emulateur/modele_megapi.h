@@ -0,0 +1,44 @@
+// modele_megapi.h
+#ifndef MODELE_MEGAPI_H
+#define MODELE_MEGAPI_H
+
+#include "messages.h"
+
+/*  Modèle de la MegaPi et de la base roulante (différentiel)
+
+    Unités identiques au vrai firmware, telles que les lit la voiture :
+    - consignes (ref1/ref2) : vitesse linéaire de roue [mm/s], 1 = gauche, 2 = droite
+    - speed1/speed2 : vitesse de roue mesurée par les codeurs [rad/s], bruitée
+    - vfiltre1/vfiltre2 : même mesure passée dans un passe-bas [rad/s]
+    - angle : cap intégré [deg] dans [0, 360[
+*/
+
+typedef struct {
+    double tau_s;           // constante de temps des moteurs (1er ordre)
+    double vitesse_max;     // saturation des roues [mm/s]
+    int ticks_par_tour;     // résolution des codeurs
+    double bruit_ratio;     // bruit gaussien relatif sur la vitesse mesurée
+    double alpha_filtre;    // passe-bas de vfiltre (0 = figé, 1 = pas de filtrage)
+    double bruit_cap_deg;   // bruit gaussien sur le cap
+} ParamsMegaPi;
+
+typedef struct {
+    ParamsMegaPi p;
+    int consigneG, consigneD;
+    double vG, vD;              // vitesses réelles des roues [mm/s]
+    double rouesG, rouesD;      // angle réel des roues [rad]
+    long ticksG, ticksD;        // dernier relevé des codeurs
+    double mesureG, mesureD;    // [rad/s]
+    double filtreG, filtreD;    // [rad/s]
+    double cap_rad;
+    unsigned int graine;
+} ModeleMegaPi;
+
+void params_megapi_defaut(ParamsMegaPi* p);
+void init_modele_megapi(ModeleMegaPi* m, const ParamsMegaPi* p, unsigned int graine);
+void modele_appliquer_consigne(ModeleMegaPi* m, int consigneD, int consigneG);
+// Fait évoluer les moteurs de dt secondes et relève les codeurs
+void modele_avancer(ModeleMegaPi* m, double dt);
+void modele_capteurs(ModeleMegaPi* m, SensorData* data);
+
+#endif
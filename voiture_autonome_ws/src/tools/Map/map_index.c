@@ -0,0 +1,179 @@
+#include "map_index.h"
+#include <stdlib.h>
+#include <math.h>
+
+#define NB_ECHANTILLONS_BOITE 16
+
+// --- Fonctions auxiliaires ---
+static double angle_positif(double a) {
+    a = fmod(a, 2.0 * M_PI);
+    return (a < 0.0) ? a + 2.0 * M_PI : a;
+}
+
+static void etendre_boite(GeometrieArc *geo, double x, double y) {
+    if (x < geo->xmin) geo->xmin = x;
+    if (x > geo->xmax) geo->xmax = x;
+    if (y < geo->ymin) geo->ymin = y;
+    if (y > geo->ymax) geo->ymax = y;
+}
+
+// Le signe du rayon dans le CSV n'est pas fiable pour le sens de parcours :
+// on choisit le sens dont la longueur d'arc correspond à celle du fichier.
+static void calculer_geometrie(const Arc *a, GeometrieArc *geo) {
+    geo->xmin = geo->xmax = a->u->x;
+    geo->ymin = geo->ymax = a->u->y;
+    etendre_boite(geo, a->v->x, a->v->y);
+
+    if (isinf(a->radius) || isnan(a->cx) || isnan(a->cy)) {
+        geo->circulaire = 0;
+        geo->longueur = hypot(a->v->x - a->u->x, a->v->y - a->u->y);
+        return;
+    }
+
+    geo->circulaire = 1;
+    geo->rayon = fabs(a->radius);
+    geo->angle_debut = atan2(a->u->y - a->cy, a->u->x - a->cx);
+    double ccw = angle_positif(atan2(a->v->y - a->cy, a->v->x - a->cx) - geo->angle_debut);
+    double cw = ccw - 2.0 * M_PI;
+    if (isfinite(a->length) && a->length > 0.0)
+        geo->balayage = (fabs(geo->rayon * ccw - a->length) <= fabs(geo->rayon * -cw - a->length)) ? ccw : cw;
+    else
+        geo->balayage = (ccw <= M_PI) ? ccw : cw;
+    geo->longueur = geo->rayon * fabs(geo->balayage);
+
+    for (int i = 1; i < NB_ECHANTILLONS_BOITE; i++) {
+        double t = geo->angle_debut + geo->balayage * i / NB_ECHANTILLONS_BOITE;
+        etendre_boite(geo, a->cx + geo->rayon * cos(t), a->cy + geo->rayon * sin(t));
+    }
+}
+
+static int cellule_x(const IndexSpatial *idx, double x) {
+    int i = (int)floor((x - idx->x0) / idx->taille_cellule);
+    return i < 0 ? 0 : (i >= idx->nx ? idx->nx - 1 : i);
+}
+
+static int cellule_y(const IndexSpatial *idx, double y) {
+    int j = (int)floor((y - idx->y0) / idx->taille_cellule);
+    return j < 0 ? 0 : (j >= idx->ny ? idx->ny - 1 : j);
+}
+
+// --- Construction de l'index ---
+IndexSpatial *construire_index_spatial(const Graph *g, double taille_cellule, double marge) {
+    if (!g || g->n_arcs <= 0 || taille_cellule <= 0.0) return NULL;
+
+    IndexSpatial *idx = calloc(1, sizeof(IndexSpatial));
+    if (!idx) return NULL;
+    idx->graph = g;
+    idx->taille_cellule = taille_cellule;
+    idx->geo = malloc(g->n_arcs * sizeof(GeometrieArc));
+    if (!idx->geo) {
+        free(idx);
+        return NULL;
+    }
+
+    double xmin = INFINITY, ymin = INFINITY, xmax = -INFINITY, ymax = -INFINITY;
+    for (int i = 0; i < g->n_arcs; i++) {
+        calculer_geometrie(&g->arcs[i], &idx->geo[i]);
+        if (idx->geo[i].xmin < xmin) xmin = idx->geo[i].xmin;
+        if (idx->geo[i].ymin < ymin) ymin = idx->geo[i].ymin;
+        if (idx->geo[i].xmax > xmax) xmax = idx->geo[i].xmax;
+        if (idx->geo[i].ymax > ymax) ymax = idx->geo[i].ymax;
+    }
+    idx->x0 = xmin - marge;
+    idx->y0 = ymin - marge;
+    idx->nx = (int)ceil((xmax - xmin + 2.0 * marge) / taille_cellule) + 1;
+    idx->ny = (int)ceil((ymax - ymin + 2.0 * marge) / taille_cellule) + 1;
+
+    int n_cellules = idx->nx * idx->ny;
+    idx->debut = calloc(n_cellules + 1, sizeof(int));
+    if (!idx->debut) {
+        free_index_spatial(idx);
+        return NULL;
+    }
+
+    // Première passe : nombre d'arcs par cellule
+    for (int a = 0; a < g->n_arcs; a++) {
+        const GeometrieArc *geo = &idx->geo[a];
+        for (int j = cellule_y(idx, geo->ymin - marge); j <= cellule_y(idx, geo->ymax + marge); j++)
+            for (int i = cellule_x(idx, geo->xmin - marge); i <= cellule_x(idx, geo->xmax + marge); i++)
+                idx->debut[j * idx->nx + i + 1]++;
+    }
+    for (int c = 0; c < n_cellules; c++)
+        idx->debut[c + 1] += idx->debut[c];
+
+    idx->arcs = malloc((idx->debut[n_cellules] > 0 ? idx->debut[n_cellules] : 1) * sizeof(int));
+    int *remplissage = malloc(n_cellules * sizeof(int));
+    if (!idx->arcs || !remplissage) {
+        free(remplissage);
+        free_index_spatial(idx);
+        return NULL;
+    }
+    for (int c = 0; c < n_cellules; c++)
+        remplissage[c] = idx->debut[c];
+
+    // Deuxième passe : remplissage
+    for (int a = 0; a < g->n_arcs; a++) {
+        const GeometrieArc *geo = &idx->geo[a];
+        for (int j = cellule_y(idx, geo->ymin - marge); j <= cellule_y(idx, geo->ymax + marge); j++)
+            for (int i = cellule_x(idx, geo->xmin - marge); i <= cellule_x(idx, geo->xmax + marge); i++)
+                idx->arcs[remplissage[j * idx->nx + i]++] = a;
+    }
+    free(remplissage);
+    return idx;
+}
+
+// --- Libération mémoire ---
+void free_index_spatial(IndexSpatial *idx) {
+    if (!idx) return;
+    free(idx->geo);
+    free(idx->debut);
+    free(idx->arcs);
+    free(idx);
+}
+
+// --- Requêtes ---
+int index_candidats(const IndexSpatial *idx, double x, double y, const int **arcs) {
+    if (x < idx->x0 || y < idx->y0 ||
+        x >= idx->x0 + idx->nx * idx->taille_cellule ||
+        y >= idx->y0 + idx->ny * idx->taille_cellule) {
+        *arcs = NULL;
+        return 0;
+    }
+    int c = cellule_y(idx, y) * idx->nx + cellule_x(idx, x);
+    *arcs = &idx->arcs[idx->debut[c]];
+    return idx->debut[c + 1] - idx->debut[c];
+}
+
+void projeter_sur_arc(const IndexSpatial *idx, int arc_id, double x, double y, ProjectionArc *p) {
+    const Arc *a = &idx->graph->arcs[arc_id];
+    const GeometrieArc *geo = &idx->geo[arc_id];
+    double tx, ty;
+
+    if (!geo->circulaire) {
+        double dx = a->v->x - a->u->x, dy = a->v->y - a->u->y;
+        double L = geo->longueur > 1e-9 ? geo->longueur : 1e-9;
+        tx = dx / L;
+        ty = dy / L;
+        double s = (x - a->u->x) * tx + (y - a->u->y) * ty;
+        if (s < 0.0) s = 0.0;
+        if (s > geo->longueur) s = geo->longueur;
+        p->s = s;
+        p->x = a->u->x + s * tx;
+        p->y = a->u->y + s * ty;
+    } else {
+        double sens = (geo->balayage >= 0.0) ? 1.0 : -1.0;
+        double ouverture = fabs(geo->balayage);
+        double t = angle_positif(sens * (atan2(y - a->cy, x - a->cx) - geo->angle_debut));
+        if (t > ouverture)
+            t = (t - ouverture < 2.0 * M_PI - t) ? ouverture : 0.0;
+        double phi = geo->angle_debut + sens * t;
+        p->s = geo->rayon * t;
+        p->x = a->cx + geo->rayon * cos(phi);
+        p->y = a->cy + geo->rayon * sin(phi);
+        tx = -sens * sin(phi);
+        ty = sens * cos(phi);
+    }
+
+    p->cap = atan2(ty, tx);
+    p->d_lat = tx * (y - p->y) - ty * (x - p->x);
+}
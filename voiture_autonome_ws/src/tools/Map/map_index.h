@@ -0,0 +1,46 @@
+#ifndef MAP_INDEX_H
+#define MAP_INDEX_H
+
+#include "map.h"
+
+// Géométrie précalculée d'un arc (segment ou arc de cercle)
+typedef struct {
+    int circulaire;      // 0 = segment [u, v], 1 = arc de cercle de centre (cx, cy)
+    double rayon;        // valeur absolue du rayon (arc de cercle)
+    double angle_debut;  // rad, angle polaire de u autour du centre
+    double balayage;     // rad, signé : > 0 sens trigonométrique
+    double longueur;     // longueur géométrique de l'arc
+    double xmin, ymin, xmax, ymax; // boîte englobante
+} GeometrieArc;
+
+// Projection d'un point sur un arc orienté
+typedef struct {
+    double s;            // abscisse curviligne depuis u, bornée à [0, longueur]
+    double d_lat;        // écart latéral signé (> 0 à gauche du sens de parcours)
+    double cap;          // rad, direction de la tangente au point projeté
+    double x, y;         // point projeté
+} ProjectionArc;
+
+// Grille régulière : chaque cellule liste les arcs passant à moins de `marge`
+// Stockage compact (CSR) : les arcs de la cellule c sont arcs[debut[c] .. debut[c+1]-1]
+typedef struct {
+    const Graph *graph;
+    GeometrieArc *geo;   // une entrée par arc
+    double x0, y0;       // coin de la grille
+    double taille_cellule;
+    int nx, ny;
+    int *debut;          // nx*ny + 1 entrées
+    int *arcs;
+} IndexSpatial;
+
+// --- Fonctions ---
+IndexSpatial *construire_index_spatial(const Graph *g, double taille_cellule, double marge);
+void free_index_spatial(IndexSpatial *idx);
+
+// Renvoie le nombre d'arcs candidats autour de (x, y) et un pointeur vers leurs ids
+int index_candidats(const IndexSpatial *idx, double x, double y, const int **arcs);
+
+// Projette (x, y) sur l'arc arc_id
+void projeter_sur_arc(const IndexSpatial *idx, int arc_id, double x, double y, ProjectionArc *p);
+
+#endif // MAP_INDEX_H
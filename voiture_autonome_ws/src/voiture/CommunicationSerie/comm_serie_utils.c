@@ -5,6 +5,9 @@
 #include <fcntl.h>
 #include <string.h>
 #include <stdio.h>
+#include <poll.h>
+
+static unsigned long compteur_read = 0;
 
 int open_serial_port(const char* port_name, int baudrate) {
     int fd = open(port_name, O_RDWR | O_NOCTTY | O_SYNC);
@@ -18,7 +21,7 @@ int open_serial_port(const char* port_name, int baudrate) {
     cfsetispeed(&tty, baudrate == 115200 ? B115200 : B9600);
 
     tty.c_cflag = (tty.c_cflag & ~CSIZE) | CS8;
-    tty.c_iflag &= ~IGNBRK;
+    tty.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL); // octets bruts (protocole binaire)
     tty.c_lflag = 0;
     tty.c_oflag = 0;
     tty.c_cc[VMIN] = 0;
@@ -39,6 +42,7 @@ int read_line(int fd, char* buffer, size_t max_len) {
     char c;
     while (pos < max_len - 1) {
         int n = read(fd, &c, 1);
+        compteur_read++;
         if (n <= 0) break;
         if (c == '\n') { buffer[pos] = '\0'; return pos; }
         buffer[pos++] = c;
@@ -56,3 +60,69 @@ int write_all(int fd, const char* data, size_t len) {
     }
     return 0;
 }
+
+unsigned long nb_appels_read(void) {
+    return compteur_read;
+}
+
+// --- Lecteur de lignes tamponné ---
+void init_lecteur_lignes(LecteurLignes* l, int fd) {
+    l->fd = fd;
+    l->debut = l->fin = l->analyse = 0;
+    l->lignes_tronquees = 0;
+}
+
+ssize_t lecteur_lire(LecteurLignes* l) {
+    // Les lignes déjà rendues ne sont plus référencées : on ramène le reste en tête
+    if (l->debut > 0) {
+        memmove(l->tampon, l->tampon + l->debut, l->fin - l->debut);
+        l->fin -= l->debut;
+        l->analyse -= l->debut;
+        l->debut = 0;
+    }
+    // Ligne plus longue que le tampon : on la jette
+    if (l->fin == sizeof(l->tampon)) {
+        l->fin = l->analyse = 0;
+        l->lignes_tronquees++;
+    }
+
+    ssize_t n = read(l->fd, l->tampon + l->fin, sizeof(l->tampon) - l->fin);
+    compteur_read++;
+    if (n > 0) l->fin += n;
+    return n;
+}
+
+ssize_t lecteur_remplir(LecteurLignes* l, int timeout_ms) {
+    struct pollfd pfd = { .fd = l->fd, .events = POLLIN };
+    int r = poll(&pfd, 1, timeout_ms);
+    if (r == 0) return 0;
+    if (r < 0 || (pfd.revents & (POLLERR | POLLNVAL))) return -1;
+
+    ssize_t n = lecteur_lire(l);
+    if (n <= 0) return (pfd.revents & POLLHUP || n < 0) ? -1 : 0;
+    return n;
+}
+
+int lecteur_ligne_suivante(LecteurLignes* l, VueLigne* ligne) {
+    char* fin_ligne = memchr(l->tampon + l->analyse, '\n', l->fin - l->analyse);
+    if (!fin_ligne) {
+        l->analyse = l->fin;
+        return 0;
+    }
+    char* debut = l->tampon + l->debut;
+    size_t len = fin_ligne - debut;
+    if (len > 0 && debut[len - 1] == '\r') len--;
+    debut[len] = '\0';
+
+    ligne->data = debut;
+    ligne->len = len;
+    l->debut = l->analyse = (fin_ligne - l->tampon) + 1;
+    return 1;
+}
+
+size_t lecteur_prendre_tout(LecteurLignes* l, const char** data) {
+    size_t n = l->fin - l->debut;
+    *data = l->tampon + l->debut;
+    l->debut = l->analyse = l->fin;
+    return n;
+}
@@ -3,9 +3,43 @@
 #define COMM_SERIE_UTILS_H
 
 #include <stddef.h>
+#include <sys/types.h>
+
+#define LECTEUR_TAILLE 1024
+
+// Lecteur de lignes tamponné : lectures en bloc, lignes rendues sans copie
+typedef struct {
+    int fd;
+    char tampon[LECTEUR_TAILLE];
+    size_t debut;       // début des octets non consommés
+    size_t fin;         // fin des octets reçus
+    size_t analyse;     // position jusqu'où '\n' a déjà été cherché
+    unsigned long lignes_tronquees;
+} LecteurLignes;
+
+// Vue sur une ligne du tampon (terminée par '\0' à la place du '\n', sans '\r').
+// Valide jusqu'au prochain appel à lecteur_remplir().
+typedef struct {
+    const char* data;
+    size_t len;
+} VueLigne;
 
 int open_serial_port(const char* port_name, int baudrate);
 int read_line(int fd, char* buffer, size_t max_len);
 int write_all(int fd, const char* data, size_t len);
 
+void init_lecteur_lignes(LecteurLignes* l, int fd);
+// Attend des données avec poll() (timeout_ms < 0 : illimité) puis fait un seul read().
+// Retourne le nombre d'octets lus, 0 sur timeout, -1 en erreur ou fin de fichier.
+ssize_t lecteur_remplir(LecteurLignes* l, int timeout_ms);
+// Un seul read() sans attente, quand fd est déjà signalé prêt (ex. par le réacteur)
+ssize_t lecteur_lire(LecteurLignes* l);
+// Rend la prochaine ligne complète déjà reçue (1), ou 0 s'il n'y en a pas
+int lecteur_ligne_suivante(LecteurLignes* l, VueLigne* ligne);
+// Rend tous les octets reçus non consommés (flux binaire)
+size_t lecteur_prendre_tout(LecteurLignes* l, const char** data);
+
+// Nombre total d'appels read() faits par ce module (mesures de performance)
+unsigned long nb_appels_read(void);
+
 #endif
@@ -1,6 +1,8 @@
+#define _GNU_SOURCE  // posix_openpt() pour le benchmark
 #include <time.h>
 #include <string.h>
 #include <unistd.h>  // pour close()
+#include <stdlib.h>
 #include "logger.h"
 #include "communication_serie.h"
 #include "config.h"
@@ -8,65 +10,302 @@
 #include "messages.h"
 #include "voiture_globals.h"
 #include "comm_serie_utils.h"
+#include "protocole_binaire.h"
+#include "parseur_capteurs.h"
+#include "reacteur.h"
 
-#define READ_SENSOR_FREQ 20
 #define TAG "comm_serie"
 
 
 static int fd_serial = -1;
 static pthread_t read_thread;
 static pthread_mutex_t serial_write_mutex = PTHREAD_MUTEX_INITIALIZER;
+static ProtocoleSerie protocole = PROTOCOLE_TEXTE;
+static DecodeurTrames decodeur;
+static uint8_t seq_emission = 0;
+static LecteurLignes lecteur;
+
+static unsigned long lignes_invalides = 0;
+
+// --- Boîte aux lettres des consignes moteur ---
+// Une seule case : la loi de commande dépose la dernière consigne sans jamais
+// toucher au port, le thread d'écriture n'émet que la plus récente.
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int consigneG, consigneD;
+    bool nouvelle;           // déposée mais pas encore prise par l'écrivain
+    bool arret;
+    bool actif;
+    unsigned long deposees;
+    unsigned long ecrasees;  // remplacées avant d'avoir été émises
+    unsigned long ignorees;  // dans la zone morte de la dernière émise
+    unsigned long emises;
+    unsigned long keepalive;
+    unsigned long perdues;   // échec d'écriture sur le port
+} BoiteConsigne;
+
+static BoiteConsigne boite = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+};
+static pthread_t write_thread;
 
 // overrun:0, ref1:100, ref2:80, speed1:59.2637, speed2:51.1728, angle:92.12, vfiltre1:59, vfiltre2:51
-static void parse_sensor_line(const char* line, SensorData* data) {
-    sscanf(line,
-           "overrun:%d, ref1:%f, ref2:%f, speed1:%f, speed2:%f, angle:%f, vfiltre1:%f, vfiltre2:%f",
-           &data->overrun,
-           &data->ref1, &data->ref2,
-           &data->speed1, &data->speed2,
-           &data->angle,
-           &data->vfiltre1, &data->vfiltre2);
+// Retourne false (et laisse data intact) si la ligne est tronquée ou corrompue
+static bool parse_sensor_line(const char* line, size_t len, SensorData* data) {
+    ResultatParse r = parser_ligne_capteurs(line, len, data);
+    if (r == PARSE_OK) return true;
+    // Journal limité : une ligne corrompue toutes les 100 au plus
+    if (lignes_invalides++ % 100 == 0)
+        WARN(TAG, "Ligne capteurs rejetée (%s), %lu au total : %.60s",
+             resultat_parse_str(r), lignes_invalides, line);
+    return false;
+}
+
+static uint32_t horodatage_us(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint32_t)((uint64_t)t.tv_sec * 1000000u + t.tv_nsec / 1000);
+}
+
+// Traite un bloc d'octets reçus en binaire ; retourne le nombre de trames capteurs
+static int traiter_octets_binaires(const uint8_t* buf, size_t n) {
+    int nb = 0;
+    TrameSerie trame;
+    for (size_t i = 0; i < n; i++) {
+        if (!decoder_octet(&decodeur, buf[i], &trame)) continue;
+        SensorData local = {0};
+        if (deserialiser_capteurs(&trame, &local)) {
+            set_sensor_data(&local);
+            nb++;
+        }
+    }
+    return nb;
+}
+
+// Envoie la requête de passage en binaire et attend l'acquittement MSG_SERIE_HELLO.
+// Les lignes texte reçues entre-temps sont ignorées par le décodeur (pas de 0x00).
+static ProtocoleSerie negocier_protocole(void) {
+    pthread_mutex_lock(&serial_write_mutex);
+    write_all(fd_serial, PROTO_BINAIRE_REQUETE, strlen(PROTO_BINAIRE_REQUETE));
+    pthread_mutex_unlock(&serial_write_mutex);
+
+    init_decodeur_trames(&decodeur);
+    struct timespec t0, t;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    t = t0;
+    while (timespec_diff_s(t0, t) * 1000.0 < SERIE_NEGOCIATION_MS) {
+        int restant = SERIE_NEGOCIATION_MS - (int)(timespec_diff_s(t0, t) * 1000.0);
+        if (lecteur_remplir(&lecteur, restant > 0 ? restant : 0) < 0) break;
+
+        const char* data;
+        size_t n = lecteur_prendre_tout(&lecteur, &data);
+        TrameSerie trame;
+        for (size_t i = 0; i < n; i++) {
+            if (decoder_octet(&decodeur, (uint8_t)data[i], &trame) &&
+                trame.id == MSG_SERIE_HELLO && trame.len >= 1 &&
+                trame.payload[0] == PROTO_BINAIRE_VERSION) {
+                // Les octets suivant l'acquittement sont déjà des trames binaires
+                init_decodeur_trames(&decodeur);
+                traiter_octets_binaires((const uint8_t*)data + i + 1, n - i - 1);
+                return PROTOCOLE_BINAIRE;
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t);
+    }
+    return PROTOCOLE_TEXTE;
+}
+
+// Traite tout ce qui est déjà dans le tampon du lecteur
+static int traiter_tampon(void) {
+    int nb = 0;
+    if (protocole == PROTOCOLE_BINAIRE) {
+        const char* data;
+        size_t n = lecteur_prendre_tout(&lecteur, &data);
+        nb = traiter_octets_binaires((const uint8_t*)data, n);
+    } else {
+        VueLigne ligne;
+        while (lecteur_ligne_suivante(&lecteur, &ligne)) {
+            SensorData local = {0};
+            if (parse_sensor_line(ligne.data, ligne.len, &local)) {
+                set_sensor_data(&local);
+                nb++;
+            }
+        }
+    }
+    return nb;
 }
 
 
 // --- thread lecture ---
+// Bloque dans poll() : chaque ligne/trame est traitée dès son arrivée
 static void* thread_read(void* arg) {
     (void)arg;
-    char line[256];
 
     while (1) {
-        int n = read_line(fd_serial, line, sizeof(line));
-        if (n > 0) {
-            SensorData local;
-            parse_sensor_line(line, &local);
-            set_sensor_data(&local);
-            /* SensorData global_data;
-            get_sensor_data(&global_data, true);
-            DBG(TAG, "Données recu : overrun:%d, ref1:%.2f, ref2:%.2f, speed1:%.2f, speed2:%.2f, angle:%.2f, vfiltre1:%.2f, vfiltre2:%.2f\n",
-                   global_data.overrun, global_data.ref1, global_data.ref2,
-                   global_data.speed1, global_data.speed2, global_data.angle,
-                   global_data.vfiltre1, global_data.vfiltre2); 
-            fflush(stdout); */
-        } else {
-            struct timespec ts;
-            ts.tv_sec = 0;
-            ts.tv_nsec = (long)(1.0 / READ_SENSOR_FREQ * 1e9);
-            nanosleep(&ts, NULL);
+        if (lecteur_remplir(&lecteur, -1) < 0) {
+            WARN(TAG, "Lecture série interrompue (fin de flux ou erreur)");
+            break;
+        }
+        traiter_tampon();
+    }
+    return NULL;
+}
+
+// Variante réacteur : fd_serial vient d'être signalé lisible
+static void gestionnaire_serie(int fd, uint32_t evenements, void* ctx) {
+    (void)ctx;
+    ssize_t n = (evenements & REACTEUR_LECTURE) ? lecteur_lire(&lecteur) : -1;
+    if (n <= 0) {
+        WARN(TAG, "Lecture série interrompue (fin de flux ou erreur)");
+        reacteur_retirer_fd(fd);
+        return;
+    }
+    traiter_tampon();
+}
+
+static int encoder_consigne(int consigneG, int consigneD, uint8_t* buffer, size_t taille) {
+    if (protocole == PROTOCOLE_BINAIRE) {
+        uint8_t payload[PAYLOAD_CONSIGNE];
+        serialiser_consigne(consigneD, consigneG, payload);
+        return (int)encoder_trame(MSG_SERIE_CONSIGNE, seq_emission++, horodatage_us(),
+                                  payload, sizeof(payload), buffer);
+    }
+    return snprintf((char*)buffer, taille,
+                    "{\"consigneD\":%d,\"consigneG\":%d}\n",
+                    consigneD, consigneG);
+}
+
+// --- thread écriture ---
+// Seul à écrire les consignes : s'il reste bloqué sur l'UART, la loi de commande
+// continue de déposer et seule la dernière consigne partira.
+static void* thread_write(void* arg) {
+    (void)arg;
+    uint8_t buffer[TRAME_ENCODEE_MAX > 64 ? TRAME_ENCODEE_MAX : 64];
+    int derniereG = 0, derniereD = 0;   // dernière consigne émise
+    int courantG = 0, courantD = 0;     // dernière consigne déposée
+    bool deja_emise = false;
+    struct timespec t_emission = {0}, t;
+
+    pthread_mutex_lock(&boite.mutex);
+    while (!boite.arret) {
+        if (!boite.nouvelle) {
+            struct timespec echeance;
+            clock_gettime(CLOCK_REALTIME, &echeance);
+            echeance.tv_nsec += (long)SERIE_KEEPALIVE_MS * 1000000L;
+            echeance.tv_sec += echeance.tv_nsec / 1000000000L;
+            echeance.tv_nsec %= 1000000000L;
+            pthread_cond_timedwait(&boite.cond, &boite.mutex, &echeance);
+            if (boite.arret) break;
+        }
+        bool nouvelle = boite.nouvelle;
+        int g = boite.consigneG, d = boite.consigneD;
+        boite.nouvelle = false;
+        pthread_mutex_unlock(&boite.mutex);
+        if (nouvelle) { courantG = g; courantD = d; }
+
+        clock_gettime(CLOCK_MONOTONIC, &t);
+        bool keepalive_du = deja_emise && timespec_diff_s(t_emission, t) * 1000.0 >= SERIE_KEEPALIVE_MS;
+        bool changement = nouvelle &&
+                          (!deja_emise ||
+                           abs(g - derniereG) > SERIE_CONSIGNE_ZONE_MORTE ||
+                           abs(d - derniereD) > SERIE_CONSIGNE_ZONE_MORTE ||
+                           (g == 0 && d == 0 && (derniereG != 0 || derniereD != 0))); // l'arrêt passe toujours
+
+        unsigned long* compteur = NULL;
+        if (changement) {
+            compteur = &boite.emises;
+        } else if (keepalive_du) {
+            g = courantG;    // même dans la zone morte, la MegaPi reçoit la plus récente
+            d = courantD;
+            compteur = &boite.keepalive;
+        }
+
+        int ret = 0;
+        if (compteur) {
+            int len = encoder_consigne(g, d, buffer, sizeof(buffer));
+            pthread_mutex_lock(&serial_write_mutex);
+            ret = write_all(fd_serial, (const char*)buffer, len);
+            pthread_mutex_unlock(&serial_write_mutex);
+            derniereG = g;
+            derniereD = d;
+            deja_emise = true;
+            t_emission = t;
+        }
+
+        pthread_mutex_lock(&boite.mutex);
+        if (nouvelle && !changement) boite.ignorees++;
+        if (compteur) {
+            if (ret < 0) boite.perdues++;
+            else (*compteur)++;
         }
     }
+    pthread_mutex_unlock(&boite.mutex);
     return NULL;
 }
 
+static void lancer_ecriture_consignes(void) {
+    pthread_mutex_lock(&boite.mutex);
+    boite.arret = false;
+    boite.nouvelle = false;
+    pthread_mutex_unlock(&boite.mutex);
+    if (pthread_create(&write_thread, NULL, thread_write, NULL) != 0) {
+        perror("pthread_create write_thread");
+        return;
+    }
+    boite.actif = true;
+}
+
+static void arreter_ecriture_consignes(void) {
+    if (!boite.actif) return;
+    pthread_mutex_lock(&boite.mutex);
+    boite.arret = true;
+    pthread_cond_signal(&boite.cond);
+    pthread_mutex_unlock(&boite.mutex);
+    pthread_join(write_thread, NULL);
+    boite.actif = false;
+    INFO(TAG, "Consignes déposées : %lu, émises : %lu, écrasées : %lu, zone morte : %lu, "
+              "keep-alive : %lu, perdues : %lu",
+         boite.deposees, boite.emises, boite.ecrasees, boite.ignorees, boite.keepalive, boite.perdues);
+}
+
+// Dépose la consigne dans la boîte et rend la main immédiatement
+void send_motor_speed(float v_left, float v_right) {
+    if (!boite.actif) return;
+    pthread_mutex_lock(&boite.mutex);
+    if (boite.nouvelle) boite.ecrasees++;
+    boite.consigneG = (int) v_left;
+    boite.consigneD = (int) v_right;
+    boite.nouvelle = true;
+    boite.deposees++;
+    pthread_cond_signal(&boite.cond);
+    pthread_mutex_unlock(&boite.mutex);
+}
+
 void* lancer_communication_serie() {
     INFO(TAG, "Thread communication série démarré");
-    
+
     if (strcmp(megapi_port, "stdin") == 0) {
         fd_serial = 0;
     } else {
         fd_serial = open_serial_port(megapi_port, MEGAPI_BAUDRATE);
-        ERR(TAG, "Erreur lors de l'ouverture du port %s à %d bauds", megapi_port, MEGAPI_BAUDRATE);
-        if (fd_serial < 0) return NULL;
+        if (fd_serial < 0) {
+            ERR(TAG, "Erreur lors de l'ouverture du port %s à %d bauds", megapi_port, MEGAPI_BAUDRATE);
+            return NULL;
+        }
+    }
+    init_lecteur_lignes(&lecteur, fd_serial);
+    if (fd_serial != 0) {
+        if (SERIE_PROTOCOLE_BINAIRE)
+            protocole = negocier_protocole();
     }
+    INFO(TAG, "Protocole série : %s", protocole == PROTOCOLE_BINAIRE ? "binaire (COBS)" : "texte");
+    lancer_ecriture_consignes();
+
+    if (USE_REACTEUR && reacteur_actif() &&
+        reacteur_ajouter_fd(fd_serial, gestionnaire_serie, NULL) == 0)
+        return NULL;
 
     if (pthread_create(&read_thread, NULL, thread_read, NULL) != 0) {
         perror("pthread_create read_thread");
@@ -77,21 +316,298 @@ void* lancer_communication_serie() {
 }
 
 void stop_communication_serie() {
+    arreter_ecriture_consignes();
+    if (lignes_invalides > 0)
+        INFO(TAG, "Lignes capteurs rejetées : %lu", lignes_invalides);
+    if (protocole == PROTOCOLE_BINAIRE)
+        INFO(TAG, "Trames reçues : %lu, perdues : %lu, CRC invalides : %lu, mal formées : %lu",
+             decodeur.trames_ok, decodeur.trames_perdues, decodeur.erreurs_crc, decodeur.erreurs_format);
     if (fd_serial > 0) close(fd_serial);
     // Ajouter un arret propre de tout
 }
 
-void send_motor_speed(float v_left, float v_right) {
-    if (fd_serial < 0) return;
-    int consigneG = (int) v_left;
-    int consigneD = (int) v_right;
+ProtocoleSerie get_protocole_serie(void) {
+    return protocole;
+}
 
-    char buffer[64];
-    int len = snprintf(buffer, sizeof(buffer),
-                       "{\"consigneD\":%d,\"consigneG\":%d}\n",
-                       consigneD, consigneG);
+#ifdef BENCH
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <stdatomic.h>
 
-    pthread_mutex_lock(&serial_write_mutex);
-    write_all(fd_serial, buffer, len);
-    pthread_mutex_unlock(&serial_write_mutex);
-}
\ No newline at end of file
+#define BENCH_SERIE_MESSAGES 5000
+#define FUZZ_TRAMES 20000
+#define BENCH_SERIE_PERIODE_US 2000    // cadence de l'essai de latence
+
+typedef enum {
+    LECTURE_ANCIENNE = 0,   // read_line() octet par octet + sommeil de 50 ms
+    LECTURE_TAMPON,         // lecteur tamponné + poll()
+    LECTURE_BINAIRE         // lecteur tamponné + trames COBS
+} ModeLectureBench;
+
+typedef struct {
+    int fd;
+    ModeLectureBench mode;
+    long periode_us;
+    int nb;
+} ArgsEmetteurBench;
+
+static struct timespec t_emission[BENCH_SERIE_MESSAGES];
+static atomic_bool emission_terminee;
+
+// Joue le rôle de la MegaPi : le champ overrun porte le numéro du message
+static void* emetteur_bench(void* arg) {
+    ArgsEmetteurBench* a = (ArgsEmetteurBench*)arg;
+    SensorData d = { 0, 100.0f, 80.0f, 59.2637f, 51.1728f, 92.12f, 59.0f, 51.0f, 0 };
+    for (int i = 0; i < a->nb; i++) {
+        uint8_t buf[TRAME_ENCODEE_MAX > 160 ? TRAME_ENCODEE_MAX : 160];
+        int n;
+        d.overrun = i;
+        d.angle = 90.0f + (i % 360) * 0.25f;
+        if (a->mode == LECTURE_BINAIRE) {
+            uint8_t payload[PAYLOAD_CAPTEURS];
+            serialiser_capteurs(&d, payload);
+            n = (int)encoder_trame(MSG_SERIE_CAPTEURS, (uint8_t)i, (uint32_t)i * 50000u,
+                                   payload, sizeof(payload), buf);
+        } else {
+            n = snprintf((char*)buf, sizeof(buf),
+                         "overrun:%d, ref1:%g, ref2:%g, speed1:%g, speed2:%g, angle:%g, vfiltre1:%g, vfiltre2:%g\n",
+                         d.overrun, d.ref1, d.ref2, d.speed1, d.speed2, d.angle, d.vfiltre1, d.vfiltre2);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t_emission[i]);
+        write_all(a->fd, (const char*)buf, n);
+        if (a->periode_us > 0) my_sleep(a->periode_us * 1e-6);
+    }
+    atomic_store(&emission_terminee, true);
+    return NULL;
+}
+
+typedef struct {
+    int recus;
+    double somme_latence, max_latence;
+} StatsBench;
+
+static void noter_reception(StatsBench* st, int numero) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    if (numero < 0 || numero >= BENCH_SERIE_MESSAGES) return;
+    double lat = timespec_diff_s(t_emission[numero], t);
+    st->somme_latence += lat;
+    if (lat > st->max_latence) st->max_latence = lat;
+    st->recus++;
+}
+
+static void bench_lecture(ModeLectureBench mode, long periode_us, int nb) {
+    static const char* noms[] = { "ancien", "tampon", "binaire" };
+    int maitre = posix_openpt(O_RDWR | O_NOCTTY);
+    if (maitre < 0 || grantpt(maitre) != 0 || unlockpt(maitre) != 0) {
+        ERR(TAG, "Benchmark : impossible de créer le pty");
+        if (maitre >= 0) close(maitre);
+        return;
+    }
+    // Côté Pi : le pty est configuré exactement comme le vrai port série
+    int esclave = open_serial_port(ptsname(maitre), MEGAPI_BAUDRATE);
+    if (esclave < 0) {
+        close(maitre);
+        return;
+    }
+
+    ArgsEmetteurBench args = { maitre, mode, periode_us, nb };
+    StatsBench st = {0};
+    pthread_t emetteur;
+    atomic_store(&emission_terminee, false);
+    protocole = (mode == LECTURE_BINAIRE) ? PROTOCOLE_BINAIRE : PROTOCOLE_TEXTE;
+    init_lecteur_lignes(&lecteur, esclave);
+    init_decodeur_trames(&decodeur);
+    unsigned long read_avant = nb_appels_read();
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    pthread_create(&emetteur, NULL, emetteur_bench, &args);
+
+    while (st.recus < nb) {
+        if (mode == LECTURE_ANCIENNE) {
+            // Boucle de thread_read avant le lecteur tamponné
+            char line[256];
+            int n = read_line(esclave, line, sizeof(line));
+            if (n > 0) {
+                SensorData local = {0};
+                if (parse_sensor_line(line, n, &local)) {
+                    set_sensor_data(&local);
+                    noter_reception(&st, local.overrun);
+                }
+            } else {
+                if (atomic_load(&emission_terminee)) break;
+                my_sleep(0.05);
+            }
+            continue;
+        }
+
+        ssize_t n = lecteur_remplir(&lecteur, 500);
+        if (n < 0 || (n == 0 && atomic_load(&emission_terminee))) break;
+        if (mode == LECTURE_BINAIRE) {
+            const char* data;
+            size_t taille = lecteur_prendre_tout(&lecteur, &data);
+            TrameSerie trame;
+            for (size_t i = 0; i < taille; i++) {
+                SensorData local = {0};
+                if (decoder_octet(&decodeur, (uint8_t)data[i], &trame) &&
+                    deserialiser_capteurs(&trame, &local)) {
+                    set_sensor_data(&local);
+                    noter_reception(&st, local.overrun);
+                }
+            }
+        } else {
+            VueLigne ligne;
+            while (lecteur_ligne_suivante(&lecteur, &ligne)) {
+                SensorData local = {0};
+                if (parse_sensor_line(ligne.data, ligne.len, &local)) {
+                    set_sensor_data(&local);
+                    noter_reception(&st, local.overrun);
+                }
+            }
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    pthread_join(emetteur, NULL);
+    close(esclave);
+    close(maitre);
+
+    double dt = timespec_diff_s(t0, t1);
+    unsigned long nb_read = nb_appels_read() - read_avant;
+    int r = st.recus > 0 ? st.recus : 1;
+    if (periode_us == 0)
+        INFO(TAG, "%-7s débit   : %d/%d messages, %.0f msg/s, %.2f read()/message",
+             noms[mode], st.recus, nb, st.recus / dt, (double)nb_read / r);
+    else
+        INFO(TAG, "%-7s latence : %d/%d messages à %ld µs, %.2f read()/message, moyenne %.0f µs, max %.0f µs",
+             noms[mode], st.recus, nb, periode_us, (double)nb_read / r,
+             1e6 * st.somme_latence / r, 1e6 * st.max_latence);
+}
+
+static void* vidange_bench(void* arg) {
+    int fd = *(int*)arg;
+    char buf[4096];
+    struct pollfd pfd = { .fd = fd, .events = POLLIN };
+    while (1) {
+        int r = poll(&pfd, 1, 100);
+        if (r > 0) {
+            if (read(fd, buf, sizeof(buf)) <= 0) break;
+        } else if (atomic_load(&emission_terminee)) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+// La loi de commande dépose 1 consigne/ms pendant que l'UART ne se vide pas
+// pendant la première moitié : le temps de dépôt doit rester indépendant du port.
+static void bench_boite_consigne(void) {
+    int maitre = posix_openpt(O_RDWR | O_NOCTTY);
+    if (maitre < 0 || grantpt(maitre) != 0 || unlockpt(maitre) != 0) {
+        ERR(TAG, "Benchmark : impossible de créer le pty");
+        if (maitre >= 0) close(maitre);
+        return;
+    }
+    fd_serial = open_serial_port(ptsname(maitre), MEGAPI_BAUDRATE);
+    if (fd_serial < 0) {
+        close(maitre);
+        return;
+    }
+    protocole = PROTOCOLE_TEXTE;
+    boite.deposees = boite.ecrasees = boite.ignorees = boite.emises = boite.keepalive = boite.perdues = 0;
+    lancer_ecriture_consignes();
+
+    pthread_t vidange;
+    bool vidange_lancee = false;
+    atomic_store(&emission_terminee, false);
+    double depot_max = 0, depot_total = 0;
+    const int nb = 6000;
+    for (int i = 0; i < nb; i++) {
+        if (i == nb / 2) vidange_lancee = pthread_create(&vidange, NULL, vidange_bench, &maitre) == 0;
+        struct timespec t0, t1;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        send_motor_speed(50 + 3 * (i % 20), 50 - 3 * (i % 20));
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        double dt = timespec_diff_s(t0, t1);
+        depot_total += dt;
+        if (dt > depot_max) depot_max = dt;
+        usleep(1000);
+    }
+    atomic_store(&emission_terminee, true);
+    if (!vidange_lancee) vidange_lancee = pthread_create(&vidange, NULL, vidange_bench, &maitre) == 0;
+    INFO(TAG, "[bench boîte] dépôt moyen %.2f us, max %.2f us (UART bloqué la moitié du temps)",
+         depot_total / nb * 1e6, depot_max * 1e6);
+    arreter_ecriture_consignes();
+    if (vidange_lancee) pthread_join(vidange, NULL);
+    close(fd_serial);
+    close(maitre);
+    fd_serial = -1;
+}
+
+static uint32_t graine_fuzz = 0x5EED1234u;
+static uint32_t alea(void) {
+    graine_fuzz ^= graine_fuzz << 13;
+    graine_fuzz ^= graine_fuzz >> 17;
+    graine_fuzz ^= graine_fuzz << 5;
+    return graine_fuzz;
+}
+
+// Fuzz du décodeur : trames capteurs altérées, octets quelconques et trames trop
+// longues au CRC valide (payload de TRAME_PAYLOAD_MAX + 1 octets, qui tient
+// encore dans le tampon codé). Aucune ne doit être acceptée avec len > TRAME_PAYLOAD_MAX.
+static void bench_trames_malformees(void) {
+    DecodeurTrames d;
+    init_decodeur_trames(&d);
+    TrameSerie trame;
+    uint8_t buf[2 * TRAME_ENCODEE_MAX], payload[TRAME_PAYLOAD_MAX];
+    int acceptees_hors_borne = 0, trop_longues = 0;
+    for (int i = 0; i < FUZZ_TRAMES; i++) {
+        size_t n;
+        int cas = (int)(alea() % 3);
+        if (cas == 0) {
+            SensorData s = { .overrun = i, .angle = 1.5f };
+            size_t len = serialiser_capteurs(&s, payload);
+            n = encoder_trame(MSG_SERIE_CAPTEURS, (uint8_t)i, (uint32_t)i, payload, len, buf);
+            for (int k = 1 + (int)(alea() % 3); k > 0; k--) {
+                size_t pos = alea() % n;
+                if (alea() % 2) buf[pos] ^= (uint8_t)(1u << (alea() % 8));
+                else n = pos + 1;
+            }
+        } else if (cas == 1) {
+            n = 1 + alea() % sizeof(buf);
+            for (size_t k = 0; k < n; k++) buf[k] = (uint8_t)alea();
+        } else {
+            uint8_t brute[TRAME_BRUTE_MAX + 1];
+            brute[0] = MSG_SERIE_CAPTEURS;
+            brute[1] = (uint8_t)i;
+            for (size_t k = 2; k < TRAME_BRUTE_MAX - 1; k++) brute[k] = (uint8_t)(1 + alea() % 255);
+            uint16_t crc = crc16_ccitt(brute, TRAME_BRUTE_MAX - 1);
+            brute[TRAME_BRUTE_MAX - 1] = (uint8_t)(crc & 0xFF);
+            brute[TRAME_BRUTE_MAX] = (uint8_t)(crc >> 8);
+            n = cobs_encoder(brute, sizeof(brute), buf);
+            buf[n++] = 0x00;
+            trop_longues++;
+        }
+        for (size_t k = 0; k < n; k++)
+            if (decoder_octet(&d, buf[k], &trame) && trame.len > TRAME_PAYLOAD_MAX)
+                acceptees_hors_borne++;
+        decoder_octet(&d, 0x00, &trame);   // resynchronisation
+    }
+    if (acceptees_hors_borne)
+        ERR(TAG, "Fuzz trames : %d trames acceptées au-delà de TRAME_PAYLOAD_MAX", acceptees_hors_borne);
+    INFO(TAG, "Fuzz trames (%d, dont %d trop longues) : %lu acceptées, %lu erreurs CRC, %lu erreurs de format",
+         FUZZ_TRAMES, trop_longues, d.trames_ok, d.erreurs_crc, d.erreurs_format);
+}
+
+void benchmark_communication_serie(void) {
+    for (ModeLectureBench m = LECTURE_ANCIENNE; m <= LECTURE_BINAIRE; m++)
+        bench_lecture(m, 0, BENCH_SERIE_MESSAGES);
+    for (ModeLectureBench m = LECTURE_ANCIENNE; m <= LECTURE_BINAIRE; m++)
+        bench_lecture(m, BENCH_SERIE_PERIODE_US, BENCH_SERIE_MESSAGES / 5);
+    bench_boite_consigne();
+    bench_trames_malformees();
+    protocole = PROTOCOLE_TEXTE;
+}
+#endif
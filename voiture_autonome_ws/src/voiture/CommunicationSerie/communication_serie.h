@@ -1,9 +1,24 @@
 #ifndef COMMUNICATION_SERIE_H
 #define COMMUNICATION_SERIE_H
 
+typedef enum {
+    PROTOCOLE_TEXTE = 0,    // lignes texte (capteurs) et JSON (consignes)
+    PROTOCOLE_BINAIRE = 1   // trames COBS, voir protocole_binaire.h
+} ProtocoleSerie;
+
 void* lancer_communication_serie();
 void stop_communication_serie();
 
+// Protocole retenu après négociation avec la MegaPi
+ProtocoleSerie get_protocole_serie(void);
+
+// Non bloquant : dépose la consigne, le thread d'écriture n'émet que la plus
+// récente (zone morte SERIE_CONSIGNE_ZONE_MORTE, renvoi toutes les SERIE_KEEPALIVE_MS)
 void send_motor_speed(float v_left, float v_right);
 
+#ifdef BENCH
+// Débit texte vs binaire sur un pty en boucle locale
+void benchmark_communication_serie(void);
+#endif
+
 #endif // COMMUNICATION_SERIE_H
\ No newline at end of file
@@ -0,0 +1,266 @@
+// parseur_capteurs.c
+#include "parseur_capteurs.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <float.h>
+#include <limits.h>
+
+#define NB_CHAMPS 8
+#define CHIFFRES_SIGNIFICATIFS 19   // tiennent dans un uint64_t
+#define EXPOSANT_MAX 38
+
+static const char* const cles[NB_CHAMPS] = {
+    "overrun", "ref1", "ref2", "speed1", "speed2", "angle", "vfiltre1", "vfiltre2"
+};
+static const size_t longueurs_cles[NB_CHAMPS] = { 7, 4, 4, 6, 6, 5, 8, 8 };
+
+static const double puissances10[EXPOSANT_MAX + 1] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13,
+    1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22, 1e23, 1e24, 1e25, 1e26,
+    1e27, 1e28, 1e29, 1e30, 1e31, 1e32, 1e33, 1e34, 1e35, 1e36, 1e37, 1e38
+};
+
+static inline bool est_chiffre(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static inline const char* sauter_espaces(const char* p, const char* fin) {
+    while (p < fin && (*p == ' ' || *p == '\t')) p++;
+    return p;
+}
+
+// Nombre décimal [+-]ddd[.ddd][e[+-]dd] ; retourne la fin du nombre ou NULL
+static const char* lire_nombre(const char* p, const char* fin, bool entier, double* val) {
+    bool negatif = false;
+    if (p < fin && (*p == '-' || *p == '+')) {
+        negatif = (*p == '-');
+        p++;
+    }
+
+    uint64_t mantisse = 0;
+    int significatifs = 0, exposant = 0, chiffres = 0;
+    while (p < fin && est_chiffre(*p)) {
+        if (significatifs < CHIFFRES_SIGNIFICATIFS) {
+            mantisse = mantisse * 10 + (uint64_t)(*p - '0');
+            if (mantisse) significatifs++;
+        } else {
+            exposant++;
+        }
+        chiffres++;
+        p++;
+    }
+    if (!entier && p < fin && *p == '.') {
+        p++;
+        while (p < fin && est_chiffre(*p)) {
+            if (significatifs < CHIFFRES_SIGNIFICATIFS) {
+                mantisse = mantisse * 10 + (uint64_t)(*p - '0');
+                if (mantisse) significatifs++;
+                exposant--;
+            }
+            chiffres++;
+            p++;
+        }
+    }
+    if (chiffres == 0) return NULL;
+
+    if (!entier && p < fin && (*p == 'e' || *p == 'E')) {
+        p++;
+        bool exp_negatif = false;
+        if (p < fin && (*p == '-' || *p == '+')) {
+            exp_negatif = (*p == '-');
+            p++;
+        }
+        if (p >= fin || !est_chiffre(*p)) return NULL;
+        int e = 0;
+        while (p < fin && est_chiffre(*p)) {
+            if (e < 1000) e = e * 10 + (*p - '0');
+            p++;
+        }
+        exposant += exp_negatif ? -e : e;
+    }
+
+    double v = (double)mantisse;
+    if (mantisse != 0) {
+        if (exposant > EXPOSANT_MAX) return NULL;
+        if (exposant < -EXPOSANT_MAX - CHIFFRES_SIGNIFICATIFS) v = 0.0;
+        else if (exposant >= 0) v *= puissances10[exposant];
+        else if (exposant >= -EXPOSANT_MAX) v /= puissances10[-exposant];
+        else v = v / puissances10[EXPOSANT_MAX] / puissances10[-exposant - EXPOSANT_MAX];
+    }
+    *val = negatif ? -v : v;
+    return p;
+}
+
+ResultatParse parser_ligne_capteurs(const char* ligne, size_t len, SensorData* data) {
+    const char* p = ligne;
+    const char* fin = ligne + len;
+    double valeurs[NB_CHAMPS];
+
+    while (fin > p && (fin[-1] == '\r' || fin[-1] == ' ')) fin--;
+    if (p == fin) return PARSE_LIGNE_VIDE;
+
+    for (int i = 0; i < NB_CHAMPS; i++) {
+        p = sauter_espaces(p, fin);
+        if (p == fin) return PARSE_CHAMP_MANQUANT;
+        if ((size_t)(fin - p) <= longueurs_cles[i] ||
+            memcmp(p, cles[i], longueurs_cles[i]) != 0 || p[longueurs_cles[i]] != ':')
+            return PARSE_CLE_INVALIDE;
+        p = sauter_espaces(p + longueurs_cles[i] + 1, fin);
+        if (p == fin) return PARSE_CHAMP_MANQUANT;
+
+        p = lire_nombre(p, fin, i == 0, &valeurs[i]);
+        if (!p) return PARSE_NOMBRE_INVALIDE;
+        if (i == 0 ? (valeurs[i] > INT_MAX || valeurs[i] < INT_MIN)
+                   : (valeurs[i] > FLT_MAX || valeurs[i] < -FLT_MAX))
+            return PARSE_NOMBRE_INVALIDE;
+
+        p = sauter_espaces(p, fin);
+        if (i < NB_CHAMPS - 1) {
+            if (p == fin) return PARSE_CHAMP_MANQUANT;
+            if (*p != ',') return (*p == '.' || est_chiffre(*p) || *p == 'e') ? PARSE_NOMBRE_INVALIDE : PARSE_SEPARATEUR;
+            p++;
+        }
+    }
+    if (p != fin) return PARSE_EN_TROP;
+
+    data->overrun = (int)valeurs[0];
+    data->ref1 = (float)valeurs[1];
+    data->ref2 = (float)valeurs[2];
+    data->speed1 = (float)valeurs[3];
+    data->speed2 = (float)valeurs[4];
+    data->angle = (float)valeurs[5];
+    data->vfiltre1 = (float)valeurs[6];
+    data->vfiltre2 = (float)valeurs[7];
+    return PARSE_OK;
+}
+
+const char* resultat_parse_str(ResultatParse r) {
+    switch (r) {
+        case PARSE_OK: return "ok";
+        case PARSE_LIGNE_VIDE: return "ligne vide";
+        case PARSE_CLE_INVALIDE: return "clé invalide";
+        case PARSE_NOMBRE_INVALIDE: return "nombre invalide";
+        case PARSE_SEPARATEUR: return "séparateur manquant";
+        case PARSE_CHAMP_MANQUANT: return "champ manquant";
+        case PARSE_EN_TROP: return "caractères en trop";
+        default: return "inconnu";
+    }
+}
+
+#ifdef BENCH
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+#include "logger.h"
+#include "utils.h"
+
+#define TAG "comm_serie"
+#define BENCH_PARSE_LIGNES 200000
+#define FUZZ_MUTATIONS 200000
+
+// Lignes au format du firmware (cf. commentaire de parse_sensor_line)
+static const char* const corpus_base[] = {
+    "overrun:0, ref1:100, ref2:80, speed1:59.2637, speed2:51.1728, angle:92.12, vfiltre1:59, vfiltre2:51",
+    "overrun:0, ref1:0, ref2:0, speed1:0.00, speed2:0.00, angle:0.00, vfiltre1:0, vfiltre2:0",
+    "overrun:3, ref1:-120, ref2:-118, speed1:-117.9021, speed2:-121.0044, angle:-179.98, vfiltre1:-118, vfiltre2:-120",
+    "overrun:12, ref1:150.5, ref2:149.25, speed1:151.337, speed2:147.9, angle:359.99, vfiltre1:150.1, vfiltre2:148.7\r",
+    "overrun:1,ref1:60,ref2:60,speed1:60.01,speed2:59.99,angle:45.5,vfiltre1:60,vfiltre2:60",
+};
+#define NB_CORPUS (int)(sizeof(corpus_base) / sizeof(corpus_base[0]))
+
+static int parse_sscanf(const char* line, SensorData* data) {
+    return sscanf(line,
+                  "overrun:%d, ref1:%f, ref2:%f, speed1:%f, speed2:%f, angle:%f, vfiltre1:%f, vfiltre2:%f",
+                  &data->overrun, &data->ref1, &data->ref2, &data->speed1, &data->speed2,
+                  &data->angle, &data->vfiltre1, &data->vfiltre2);
+}
+
+static bool meme_valeur(float a, float b) {
+    return fabsf(a - b) <= 1e-6f * fmaxf(1.0f, fabsf(a));
+}
+
+static uint32_t graine_fuzz = 0xC0FFEEu;
+static uint32_t alea(void) {
+    graine_fuzz ^= graine_fuzz << 13;
+    graine_fuzz ^= graine_fuzz >> 17;
+    graine_fuzz ^= graine_fuzz << 5;
+    return graine_fuzz;
+}
+
+// Altère une ligne comme le ferait une liaison bruitée ou un firmware en vrac
+static size_t muter(const char* src, char* dst, size_t max) {
+    static const char alphabet[] = "0123456789.,:- e\r\n\tabcnovfNAN\x00\xff";
+    size_t n = strlen(src);
+    memcpy(dst, src, n);
+    int nb = 1 + alea() % 3;
+    for (int k = 0; k < nb && n > 0; k++) {
+        size_t pos = alea() % n;
+        switch (alea() % 5) {
+            case 0: n = pos; break;                                                      // troncature
+            case 1: dst[pos] = alphabet[alea() % (sizeof(alphabet) - 1)]; break;         // substitution
+            case 2: dst[pos] ^= (char)(1u << (alea() % 8)); break;                       // bit inversé
+            case 3: memmove(dst + pos, dst + pos + 1, n - pos - 1); n--; break;          // suppression
+            case 4:                                                                      // insertion
+                if (n + 1 < max) {
+                    memmove(dst + pos + 1, dst + pos, n - pos);
+                    dst[pos] = alphabet[alea() % (sizeof(alphabet) - 1)];
+                    n++;
+                }
+                break;
+        }
+    }
+    dst[n] = '\0';
+    return n;
+}
+
+void benchmark_parseur_capteurs(void) {
+    SensorData a = {0}, b = {0};
+    struct timespec t0, t1;
+    size_t longueurs[NB_CORPUS];
+    for (int i = 0; i < NB_CORPUS; i++) longueurs[i] = strlen(corpus_base[i]);
+
+    // Équivalence avec sscanf sur les lignes valides
+    for (int i = 0; i < NB_CORPUS; i++) {
+        ResultatParse r = parser_ligne_capteurs(corpus_base[i], longueurs[i], &a);
+        parse_sscanf(corpus_base[i], &b);
+        if (r != PARSE_OK || a.overrun != b.overrun || !meme_valeur(a.speed1, b.speed1) ||
+            !meme_valeur(a.angle, b.angle) || !meme_valeur(a.vfiltre2, b.vfiltre2))
+            ERR(TAG, "Parseur : écart avec sscanf sur la ligne %d (%s)", i, resultat_parse_str(r));
+    }
+
+    // Débit
+    volatile int puits = 0;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int i = 0; i < BENCH_PARSE_LIGNES; i++) {
+        parse_sscanf(corpus_base[i % NB_CORPUS], &b);
+        puits += b.overrun;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double dt_sscanf = timespec_diff_s(t0, t1);
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int i = 0; i < BENCH_PARSE_LIGNES; i++) {
+        parser_ligne_capteurs(corpus_base[i % NB_CORPUS], longueurs[i % NB_CORPUS], &a);
+        puits += a.overrun;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double dt_parseur = timespec_diff_s(t0, t1);
+    INFO(TAG, "Parseur capteurs : sscanf %.0f lignes/s, parseur dédié %.0f lignes/s (x%.1f)",
+         BENCH_PARSE_LIGNES / dt_sscanf, BENCH_PARSE_LIGNES / dt_parseur, dt_sscanf / dt_parseur);
+
+    // Fuzz : lignes altérées, le parseur doit les classer sans jamais accepter de valeur aberrante
+    unsigned long resultats[PARSE_NB_RESULTATS] = {0};
+    char ligne[256];
+    for (int i = 0; i < FUZZ_MUTATIONS; i++) {
+        size_t n = muter(corpus_base[alea() % NB_CORPUS], ligne, sizeof(ligne) - 1);
+        SensorData d = {0};
+        ResultatParse r = parser_ligne_capteurs(ligne, n, &d);
+        resultats[r]++;
+        if (r == PARSE_OK && (!isfinite(d.angle) || !isfinite(d.speed1) || !isfinite(d.vfiltre2)))
+            ERR(TAG, "Fuzz : valeur non finie acceptée : %s", ligne);
+    }
+    for (int r = 0; r < PARSE_NB_RESULTATS; r++)
+        INFO(TAG, "Fuzz (%d lignes) : %-20s %lu", FUZZ_MUTATIONS, resultat_parse_str(r), resultats[r]);
+}
+#endif
@@ -0,0 +1,31 @@
+// parseur_capteurs.h
+#ifndef PARSEUR_CAPTEURS_H
+#define PARSEUR_CAPTEURS_H
+
+#include <stddef.h>
+#include "messages.h"
+
+// Ligne capteurs MegaPi (protocole texte), champs dans cet ordre :
+// overrun:0, ref1:100, ref2:80, speed1:59.2637, speed2:51.1728, angle:92.12, vfiltre1:59, vfiltre2:51
+typedef enum {
+    PARSE_OK = 0,
+    PARSE_LIGNE_VIDE,
+    PARSE_CLE_INVALIDE,      // clé absente, inattendue ou dans le désordre
+    PARSE_NOMBRE_INVALIDE,   // valeur vide, non numérique ou hors bornes (nan, ovf...)
+    PARSE_SEPARATEUR,        // ',' manquant entre deux champs
+    PARSE_CHAMP_MANQUANT,    // ligne tronquée
+    PARSE_EN_TROP,           // caractères après le dernier champ
+    PARSE_NB_RESULTATS
+} ResultatParse;
+
+// Analyse les len premiers caractères de ligne (pas besoin de '\0').
+// *data n'est modifié que si le résultat vaut PARSE_OK. Aucune allocation.
+ResultatParse parser_ligne_capteurs(const char* ligne, size_t len, SensorData* data);
+const char* resultat_parse_str(ResultatParse r);
+
+#ifdef BENCH
+// Débit (lignes/s) face à sscanf et passage sur un corpus de lignes altérées
+void benchmark_parseur_capteurs(void);
+#endif
+
+#endif
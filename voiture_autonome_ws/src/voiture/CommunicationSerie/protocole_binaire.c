@@ -0,0 +1,185 @@
+// protocole_binaire.c
+#include "protocole_binaire.h"
+#include <string.h>
+
+// --- CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF), identique côté MegaPi ---
+uint16_t crc16_ccitt(const uint8_t* data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int b = 0; b < 8; b++)
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+    return crc;
+}
+
+// --- COBS ---
+size_t cobs_encoder(const uint8_t* src, size_t len, uint8_t* dst) {
+    size_t ecrit = 1, pos_code = 0;
+    uint8_t code = 1;
+    for (size_t i = 0; i < len; i++) {
+        if (src[i] == 0) {
+            dst[pos_code] = code;
+            pos_code = ecrit++;
+            code = 1;
+        } else {
+            dst[ecrit++] = src[i];
+            if (++code == 0xFF) {
+                dst[pos_code] = code;
+                pos_code = ecrit++;
+                code = 1;
+            }
+        }
+    }
+    dst[pos_code] = code;
+    return ecrit;
+}
+
+size_t cobs_decoder(const uint8_t* src, size_t len, uint8_t* dst) {
+    size_t lu = 0, ecrit = 0;
+    while (lu < len) {
+        uint8_t code = src[lu++];
+        if (code == 0 || lu + code - 1 > len) return 0;
+        for (uint8_t k = 1; k < code; k++) {
+            if (src[lu] == 0) return 0;
+            dst[ecrit++] = src[lu++];
+        }
+        if (code != 0xFF && lu < len) dst[ecrit++] = 0;
+    }
+    return ecrit;
+}
+
+// --- Accès little-endian ---
+static void ecrire_u16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void ecrire_u32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static uint16_t lire_u16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t lire_u32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void ecrire_f32(uint8_t* p, float f) {
+    uint32_t v;
+    memcpy(&v, &f, sizeof(v));
+    ecrire_u32(p, v);
+}
+
+static float lire_f32(const uint8_t* p) {
+    uint32_t v = lire_u32(p);
+    float f;
+    memcpy(&f, &v, sizeof(f));
+    return f;
+}
+
+// --- Trames ---
+size_t encoder_trame(uint8_t id, uint8_t seq, uint32_t t_us,
+                     const uint8_t* payload, size_t len, uint8_t* out) {
+    uint8_t brute[TRAME_BRUTE_MAX];
+    if (len > TRAME_PAYLOAD_MAX) return 0;
+    brute[0] = id;
+    brute[1] = seq;
+    ecrire_u32(&brute[2], t_us);
+    if (len) memcpy(&brute[TRAME_ENTETE], payload, len);
+    ecrire_u16(&brute[TRAME_ENTETE + len], crc16_ccitt(brute, TRAME_ENTETE + len));
+
+    size_t n = cobs_encoder(brute, TRAME_ENTETE + len + TRAME_CRC, out);
+    out[n++] = 0x00;
+    return n;
+}
+
+void init_decodeur_trames(DecodeurTrames* d) {
+    memset(d, 0, sizeof(*d));
+}
+
+static bool valider_trame(DecodeurTrames* d, TrameSerie* trame) {
+    uint8_t brute[TRAME_ENCODEE_MAX];
+    size_t n = cobs_decoder(d->tampon, d->n, brute);
+    // Le tampon accepte TRAME_ENCODEE_MAX octets codés, qui peuvent se décoder en
+    // une trame d'un octet de plus que TRAME_BRUTE_MAX : rejetée avant la copie
+    if (n < TRAME_ENTETE + TRAME_CRC || n > TRAME_BRUTE_MAX) {
+        d->erreurs_format++;
+        return false;
+    }
+    if (crc16_ccitt(brute, n - TRAME_CRC) != lire_u16(&brute[n - TRAME_CRC])) {
+        d->erreurs_crc++;
+        return false;
+    }
+
+    trame->id = brute[0];
+    trame->seq = brute[1];
+    trame->t_us = lire_u32(&brute[2]);
+    trame->len = n - TRAME_ENTETE - TRAME_CRC;   // <= TRAME_PAYLOAD_MAX (borne ci-dessus)
+    memcpy(trame->payload, &brute[TRAME_ENTETE], trame->len);
+
+    if (d->seq_init)
+        d->trames_perdues += (uint8_t)(trame->seq - d->seq_attendue);
+    d->seq_attendue = (uint8_t)(trame->seq + 1);
+    d->seq_init = true;
+    d->trames_ok++;
+    return true;
+}
+
+bool decoder_octet(DecodeurTrames* d, uint8_t octet, TrameSerie* trame) {
+    if (octet != 0x00) {
+        if (d->n < sizeof(d->tampon)) d->tampon[d->n++] = octet;
+        else d->debordement = true;
+        return false;
+    }
+    // Fin de trame
+    bool ok = false;
+    if (d->debordement) d->erreurs_format++;
+    else if (d->n > 0) ok = valider_trame(d, trame);
+    d->n = 0;
+    d->debordement = false;
+    return ok;
+}
+
+// --- Messages ---
+size_t serialiser_capteurs(const SensorData* data, uint8_t* payload) {
+    ecrire_u16(&payload[0], (uint16_t)(int16_t)data->overrun);
+    ecrire_f32(&payload[2], data->ref1);
+    ecrire_f32(&payload[6], data->ref2);
+    ecrire_f32(&payload[10], data->speed1);
+    ecrire_f32(&payload[14], data->speed2);
+    ecrire_f32(&payload[18], data->angle);
+    ecrire_f32(&payload[22], data->vfiltre1);
+    ecrire_f32(&payload[26], data->vfiltre2);
+    return PAYLOAD_CAPTEURS;
+}
+
+bool deserialiser_capteurs(const TrameSerie* trame, SensorData* data) {
+    if (trame->id != MSG_SERIE_CAPTEURS || trame->len != PAYLOAD_CAPTEURS) return false;
+    const uint8_t* p = trame->payload;
+    data->overrun = (int16_t)lire_u16(&p[0]);
+    data->ref1 = lire_f32(&p[2]);
+    data->ref2 = lire_f32(&p[6]);
+    data->speed1 = lire_f32(&p[10]);
+    data->speed2 = lire_f32(&p[14]);
+    data->angle = lire_f32(&p[18]);
+    data->vfiltre1 = lire_f32(&p[22]);
+    data->vfiltre2 = lire_f32(&p[26]);
+    data->t_megapi_us = trame->t_us;
+    return true;
+}
+
+size_t serialiser_consigne(int consigneD, int consigneG, uint8_t* payload) {
+    ecrire_u16(&payload[0], (uint16_t)(int16_t)consigneD);
+    ecrire_u16(&payload[2], (uint16_t)(int16_t)consigneG);
+    return PAYLOAD_CONSIGNE;
+}
+
+bool deserialiser_consigne(const TrameSerie* trame, int* consigneD, int* consigneG) {
+    if (trame->id != MSG_SERIE_CONSIGNE || trame->len != PAYLOAD_CONSIGNE) return false;
+    *consigneD = (int16_t)lire_u16(&trame->payload[0]);
+    *consigneG = (int16_t)lire_u16(&trame->payload[2]);
+    return true;
+}
@@ -0,0 +1,88 @@
+// protocole_binaire.h
+#ifndef PROTOCOLE_BINAIRE_H
+#define PROTOCOLE_BINAIRE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "messages.h"
+
+/*  Protocole binaire Pi <-> MegaPi
+
+    Trame (avant encodage COBS), entiers et flottants en little-endian :
+        [id:1][seq:1][t_us:4][payload:n][crc16:2]
+    - id    : type de message (MsgSerieId)
+    - seq   : compteur modulo 256 propre à chaque émetteur (détection des pertes)
+    - t_us  : horodatage de l'émetteur en µs (micros() côté MegaPi)
+    - crc16 : CRC-16/CCITT-FALSE sur id..payload
+    La trame est encodée en COBS puis terminée par un octet 0x00, qui ne peut donc
+    apparaître qu'en fin de trame : une resynchronisation coûte au plus une trame.
+
+    Négociation : la MegaPi démarre en texte. La Pi envoie la ligne
+    PROTO_BINAIRE_REQUETE ; si la MegaPi la comprend, elle répond par un octet
+    0x00 (clôt le texte déjà émis) puis une trame MSG_SERIE_HELLO (payload =
+    version) et passe en binaire. Sans réponse, la Pi reste en texte.
+*/
+
+#define PROTO_BINAIRE_VERSION 1
+#define PROTO_BINAIRE_REQUETE "{\"protocole\":\"bin\",\"version\":1}\n"
+
+#define TRAME_ENTETE 6
+#define TRAME_CRC 2
+#define TRAME_PAYLOAD_MAX 48
+#define TRAME_BRUTE_MAX (TRAME_ENTETE + TRAME_PAYLOAD_MAX + TRAME_CRC)
+// COBS ajoute au plus 1 octet tous les 254, plus le délimiteur
+#define TRAME_ENCODEE_MAX (TRAME_BRUTE_MAX + TRAME_BRUTE_MAX / 254 + 2)
+
+typedef enum {
+    MSG_SERIE_CAPTEURS = 0x01,  // MegaPi -> Pi : SensorData
+    MSG_SERIE_CONSIGNE = 0x02,  // Pi -> MegaPi : consignes moteurs
+    MSG_SERIE_HELLO    = 0x10   // MegaPi -> Pi : acquittement de la négociation
+} MsgSerieId;
+
+#define PAYLOAD_CAPTEURS 30     // overrun:2 + 7 flottants
+#define PAYLOAD_CONSIGNE 4      // consigneD:2 + consigneG:2
+
+typedef struct {
+    uint8_t id;
+    uint8_t seq;
+    uint32_t t_us;
+    uint8_t payload[TRAME_PAYLOAD_MAX];
+    size_t len;
+} TrameSerie;
+
+// Décodeur incrémental : on lui donne les octets au fil de l'eau
+typedef struct {
+    uint8_t tampon[TRAME_ENCODEE_MAX];
+    size_t n;
+    bool debordement;
+    bool seq_init;
+    uint8_t seq_attendue;
+    // Compteurs
+    unsigned long trames_ok;
+    unsigned long erreurs_crc;
+    unsigned long erreurs_format;
+    unsigned long trames_perdues;
+} DecodeurTrames;
+
+uint16_t crc16_ccitt(const uint8_t* data, size_t len);
+
+// COBS : retourne la taille écrite (sans délimiteur), ou 0 en cas d'erreur au décodage
+size_t cobs_encoder(const uint8_t* src, size_t len, uint8_t* dst);
+size_t cobs_decoder(const uint8_t* src, size_t len, uint8_t* dst);
+
+// Construit la trame complète (COBS + 0x00) dans out, retourne sa taille
+size_t encoder_trame(uint8_t id, uint8_t seq, uint32_t t_us,
+                     const uint8_t* payload, size_t len, uint8_t* out);
+
+void init_decodeur_trames(DecodeurTrames* d);
+// Consomme un octet ; retourne true quand une trame valide est disponible dans *trame
+bool decoder_octet(DecodeurTrames* d, uint8_t octet, TrameSerie* trame);
+
+// (Dé)sérialisation des messages
+size_t serialiser_capteurs(const SensorData* data, uint8_t* payload);
+bool deserialiser_capteurs(const TrameSerie* trame, SensorData* data);
+size_t serialiser_consigne(int consigneD, int consigneG, uint8_t* payload);
+bool deserialiser_consigne(const TrameSerie* trame, int* consigneD, int* consigneG);
+
+#endif
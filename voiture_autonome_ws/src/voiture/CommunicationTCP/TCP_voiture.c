@@ -16,6 +16,10 @@
 #include "TCP_voiture.h"
 #include "logger.h"
 #include "voiture_globals.h"
+#include "reacteur.h"
+#include "annotation_itineraire.h"
+#include <errno.h>
+#include <sys/socket.h>
 
 #define TAG "communication_tcp_voiture"
 
@@ -37,6 +41,7 @@ void deconnecter_controleur() {
     connexion_tcp.voiture_connectee = false;
 
     if (connexion_tcp.sockfd >= 0) {
+        reacteur_retirer_fd(connexion_tcp.sockfd);
         close(connexion_tcp.sockfd);
         connexion_tcp.sockfd = -1;
     }
@@ -52,6 +57,42 @@ void deconnecter_controleur() {
     INFO(TAG, "Voiture déconnecté proprement du contrôleur");
 }
 
+// Traite un message complet du contrôleur ; retourne false sur MESSAGE_FIN
+static bool traiter_message_controleur(MessageType type, char* buffer) {
+    switch (type) {
+        case MESSAGE_CONSIGNE: {
+            Consigne* c = (Consigne*) buffer;
+            set_consigne(c);
+            get_consigne(c);
+            printf("autorisation = %d, structure id = %d \n", c->autorisation, c->structure_id);
+            break;
+        }
+
+        case MESSAGE_ITINERAIRE: {
+            Itineraire* iti = (Itineraire*) buffer;
+            publier_itineraire(iti);   // annotation (structures, dépassement) calculée ici
+            Itineraire* iti2 = (Itineraire*) buffer;
+            get_itineraire(iti2);
+            printf("[IHM] Itinéraire reçu \n");
+            for (int i = 0; i < iti2->nb_points; i++) {
+                Point* p = &iti2->points[i];
+                printf("  P%d: x=%.2f y=%.2f z=%.2f theta=%.2f pont=%d dep=%d\n",
+                        i, p->x, p->y, p->z, p->theta, p->pont, p->depacement);
+            }
+            break;
+        }
+
+        case MESSAGE_FIN:
+            printf("[Client] Reçu MESSAGE_FIN, fermeture.\n");
+            return false;
+
+        default:
+            printf("[Client] Message type %d ignoré.\n", type);
+            break;
+    }
+    return true;
+}
+
 void* receive_thread() {
     MessageType type;
     char buffer[sizeof(Itineraire) + 2048];
@@ -75,45 +116,89 @@ void* receive_thread() {
             break;
         }
 
-        switch (type) {
-            case MESSAGE_CONSIGNE: {
-                Consigne* c = (Consigne*) buffer;
-                set_consigne(c);
-                get_consigne(c);
-                printf("autorisation = %d, structure id = %d \n", c->autorisation, c->structure_id);
-                break;
-            }
+        if (!traiter_message_controleur(type, buffer)) {
+            deconnecter_controleur();
+            pthread_mutex_lock(&connexion_tcp.mutex);
+            connexion_tcp.voiture_connectee = false;
+            pthread_mutex_unlock(&connexion_tcp.mutex);
+            return NULL;
+        }
+    }
 
-            case MESSAGE_ITINERAIRE: {
-                Itineraire* iti = (Itineraire*) buffer;
-                set_itineraire(iti);
-                Itineraire* iti2 = (Itineraire*) buffer;
-                get_itineraire(iti2);
-                printf("[IHM] Itinéraire reçu \n");
-                for (int i = 0; i < iti2->nb_points; i++) {
-                    Point* p = &iti2->points[i];
-                    printf("  P%d: x=%.2f y=%.2f z=%.2f theta=%.2f pont=%d dep=%d\n",
-                            i, p->x, p->y, p->z, p->theta, p->pont, p->depacement);
-                }
-                break;
-            }
+    return NULL;
+}
 
-            case MESSAGE_FIN: {
-                printf("[Client] Reçu MESSAGE_FIN, fermeture.\n");
-                deconnecter_controleur();
-                pthread_mutex_lock(&connexion_tcp.mutex);
-                connexion_tcp.voiture_connectee = false;
-                pthread_mutex_unlock(&connexion_tcp.mutex);
-                return NULL;
-            }
+// --- Réception non bloquante (réacteur) ---
+// Les messages sont reconstitués au fil des octets reçus : [MessageType][corps]
+static struct {
+    bool type_recu;
+    MessageType type;
+    size_t attendu;
+    size_t recu;
+    char buffer[sizeof(Itineraire) + 2048];
+} assembleur;
+
+static long taille_corps(MessageType type) {
+    switch (type) {
+        case MESSAGE_CONSIGNE:   return sizeof(Consigne);
+        case MESSAGE_ITINERAIRE: return sizeof(Itineraire);
+        case MESSAGE_FIN:        return 0;  // le texte qui suit est ignoré, on ferme
+        default:                 return -1;
+    }
+}
 
-            default:
-                printf("[Client] Message type %d ignoré.\n", type);
-                break;
+static void connexion_perdue(int fd) {
+    reacteur_retirer_fd(fd);
+    pthread_mutex_lock(&connexion_tcp.mutex);
+    connexion_tcp.voiture_connectee = false;
+    if (connexion_tcp.sockfd == fd) connexion_tcp.sockfd = -1;
+    pthread_mutex_unlock(&connexion_tcp.mutex);
+    close(fd);
+    memset(&assembleur, 0, sizeof(assembleur));
+}
+
+void gestionnaire_reception_tcp(int fd, uint32_t evenements, void* ctx) {
+    (void)evenements;
+    (void)ctx;
+    while (1) {
+        char* dst = assembleur.type_recu ? assembleur.buffer + assembleur.recu
+                                         : (char*)&assembleur.type + assembleur.recu;
+        size_t reste = (assembleur.type_recu ? assembleur.attendu : sizeof(MessageType)) - assembleur.recu;
+
+        ssize_t n = reste ? recv(fd, dst, reste, MSG_DONTWAIT) : 0;
+        if (reste && n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+        if (reste && n <= 0) {
+            printf("[Client] Connexion fermée ou erreur.\n");
+            connexion_perdue(fd);
+            return;
+        }
+        assembleur.recu += n;
+
+        if (!assembleur.type_recu) {
+            if (assembleur.recu < sizeof(MessageType)) continue;
+            long taille = taille_corps(assembleur.type);
+            if (taille < 0) {
+                // Flux désynchronisé : impossible de retrouver le début du message suivant
+                WARN(TAG, "Type de message %d inconnu, connexion réinitialisée", assembleur.type);
+                connexion_perdue(fd);
+                return;
+            }
+            assembleur.type_recu = true;
+            assembleur.attendu = (size_t)taille;
+            assembleur.recu = 0;
+        }
+        if (assembleur.recu < assembleur.attendu) continue;
+
+        // Message complet
+        MessageType type = assembleur.type;
+        assembleur.type_recu = false;
+        assembleur.recu = 0;
+        if (!traiter_message_controleur(type, assembleur.buffer)) {
+            memset(&assembleur, 0, sizeof(assembleur));
+            deconnecter_controleur();
+            return;
         }
     }
-
-    return NULL;
 }
 
 
@@ -3,6 +3,7 @@
 
 #include <pthread.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <netinet/in.h>
 #include "messages.h"
 
@@ -12,6 +13,8 @@ extern pthread_t tid_rcv;      // thread qui gère cette connexion
 
 // Thread de réception des messages du contrôleur   
 void* receive_thread();
+// Variante réacteur : la socket est lisible, on reconstitue les messages sans bloquer
+void gestionnaire_reception_tcp(int fd, uint32_t evenements, void* ctx);
 
 // Structure interne pour gérer la connexion
 typedef struct {
@@ -3,12 +3,15 @@
 #include <stdbool.h>
 #include <string.h>
 #include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <stdatomic.h>
 #include <arpa/inet.h>
 #include <pthread.h>
 #include "TCP_voiture.h"
 #include "communication_tcp_voiture.h"
 #include "logger.h"
+#include "reacteur.h"
 
 #define TAG "communication_tcp_voiture"
 
@@ -45,6 +48,26 @@ int sendMessage(MessageType type, void* message) {
     }
 }
 
+static void adresse_controleur(void) {
+    connexion_tcp.serv_addr.sin_family = AF_INET;
+    connexion_tcp.serv_addr.sin_port = htons(TCP_PORT);
+    connexion_tcp.serv_addr.sin_addr.s_addr = inet_addr(CONTROLEUR_IP);
+}
+
+// Ouvre une connexion vers le contrôleur (retourne la socket ou -1) ; bloquant
+static int connecter_controleur(void) {
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock < 0) { perror("Erreur création socket"); return -1; }
+
+    adresse_controleur();
+    if (connect(sock, (struct sockaddr*)&connexion_tcp.serv_addr, sizeof(connexion_tcp.serv_addr)) < 0) {
+        perror("Erreur connexion");
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
 void* initialisation_communication_voiture(void* arg) {
     INFO(TAG, "Thread communication tcp démarré");
 
@@ -56,20 +79,8 @@ void* initialisation_communication_voiture(void* arg) {
 
         if (stop) break;
         if (!connected) {
-            // Création socket
-            int sock = socket(AF_INET, SOCK_STREAM, 0);
-            if (sock < 0) { perror("Erreur création socket"); sleep(5); continue; }
-
-            connexion_tcp.serv_addr.sin_family = AF_INET;
-            connexion_tcp.serv_addr.sin_port = htons(TCP_PORT);
-            connexion_tcp.serv_addr.sin_addr.s_addr = inet_addr(CONTROLEUR_IP);
-
-            if (connect(sock, (struct sockaddr*)&connexion_tcp.serv_addr, sizeof(connexion_tcp.serv_addr)) < 0) {
-                perror("Erreur connexion");
-                close(sock);
-                sleep(5);
-                continue;
-            }
+            int sock = connecter_controleur();
+            if (sock < 0) { sleep(5); continue; }
 
             pthread_mutex_lock(&connexion_tcp.mutex);
             connexion_tcp.sockfd = sock;
@@ -103,6 +114,100 @@ void* initialisation_communication_voiture(void* arg) {
     return NULL;
 }
 
+// --- Variante réacteur : (re)connexion sur timer, réception par gestionnaire_reception_tcp ---
+// Le connect() est non bloquant : la socket est surveillée en écriture et le
+// résultat lu par SO_ERROR quand elle le devient. Une tentative encore en cours
+// au tick suivant du timer est abandonnée.
+static int timer_connexion = -1;
+static int sock_en_cours = -1;
+
+static void abandonner_connexion_en_cours(void) {
+    if (sock_en_cours < 0) return;
+    reacteur_retirer_fd(sock_en_cours);
+    close(sock_en_cours);
+    sock_en_cours = -1;
+}
+
+static void connexion_etablie(int sock) {
+    // Les send() restent bloquants comme dans la variante à threads ; la
+    // réception passe par recv(MSG_DONTWAIT)
+    fcntl(sock, F_SETFL, fcntl(sock, F_GETFL) & ~O_NONBLOCK);
+
+    pthread_mutex_lock(&connexion_tcp.mutex);
+    connexion_tcp.sockfd = sock;
+    connexion_tcp.voiture_connectee = true;
+    pthread_mutex_unlock(&connexion_tcp.mutex);
+
+    if (reacteur_ajouter_fd(sock, gestionnaire_reception_tcp, NULL) != 0) {
+        pthread_mutex_lock(&connexion_tcp.mutex);
+        connexion_tcp.sockfd = -1;
+        connexion_tcp.voiture_connectee = false;
+        pthread_mutex_unlock(&connexion_tcp.mutex);
+        close(sock);
+        return;
+    }
+    INFO(TAG, "Voiture Connectée au controleur");
+}
+
+static void gestionnaire_connexion(int fd, uint32_t evenements, void* ctx) {
+    (void)evenements;
+    (void)ctx;
+    reacteur_retirer_fd(fd);
+    sock_en_cours = -1;
+
+    int erreur = 0;
+    socklen_t taille = sizeof(erreur);
+    if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &erreur, &taille) < 0) erreur = errno;
+    if (erreur != 0) {
+        DBG(TAG, "Connexion au contrôleur impossible : %s", strerror(erreur));
+        close(fd);
+        return;
+    }
+    connexion_etablie(fd);
+}
+
+static void tentative_connexion(void* ctx) {
+    (void)ctx;
+    pthread_mutex_lock(&connexion_tcp.mutex);
+    bool stop = connexion_tcp.stop_client;
+    bool connected = connexion_tcp.voiture_connectee;
+    pthread_mutex_unlock(&connexion_tcp.mutex);
+
+    abandonner_connexion_en_cours();
+    if (stop) {
+        reacteur_retirer_timer(timer_connexion);
+        timer_connexion = -1;
+        return;
+    }
+    if (connected) return;
+
+    int sock = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (sock < 0) { perror("Erreur création socket"); return; }
+    adresse_controleur();
+    if (connect(sock, (struct sockaddr*)&connexion_tcp.serv_addr, sizeof(connexion_tcp.serv_addr)) == 0) {
+        connexion_etablie(sock);
+        return;
+    }
+    if (errno != EINPROGRESS) {
+        DBG(TAG, "Connexion au contrôleur impossible : %s", strerror(errno));
+        close(sock);
+        return;
+    }
+    if (reacteur_ajouter_fd_ecriture(sock, gestionnaire_connexion, NULL) != 0) {
+        close(sock);
+        return;
+    }
+    sock_en_cours = sock;
+}
+
+int enregistrer_communication_voiture(void) {
+    INFO(TAG, "Communication tcp confiée au réacteur");
+    timer_connexion = reacteur_ajouter_timer(TCP_RECONNEXION_S, tentative_connexion, NULL);
+    if (timer_connexion < 0) return -1;
+    tentative_connexion(NULL);
+    return 0;
+}
+
 bool est_connectee() {
     bool connected;
 
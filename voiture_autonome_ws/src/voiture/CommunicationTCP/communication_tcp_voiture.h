@@ -11,4 +11,6 @@ int sendDemande(const Demande* dem);
 int sendFin();
 
 void* initialisation_communication_voiture(void* arg);
+// Variante réacteur : connexion périodique sur timerfd, sans thread dédié (0 si OK)
+int enregistrer_communication_voiture(void);
 bool est_connectee();
\ No newline at end of file
@@ -1,137 +1,250 @@
+#define _GNU_SOURCE  // recvmmsg(), MSG_WAITFORONE
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
+#include <time.h>
 #include <arpa/inet.h>
-#include "cJSON.h"
+#include <sys/socket.h>
 #include <unistd.h>
 #include "messages.h"
+#include "config.h"
+#include "logger.h"
+#include "utils.h"
 #include "voiture_globals.h"
 #include "UDP_voiture.h"
-#include "cJSON.h"
+#include "parseur_detection.h"
+#include "datagramme_detection.h"
+#include "reacteur.h"
+#include "suivi_obstacles.h"
 
+#define TAG "udp"
 #define PORT 5005
-#define BUFFER_SIZE 65535
 
-void* initialisation_communication_camera(void* arg) {
+static StatsCamera stats;
+static pthread_mutex_t stats_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static int rejeter_datagramme(ResultatDetection r) {
+    pthread_mutex_lock(&stats_mutex);
+    unsigned long erreurs = ++stats.erreurs;
+    pthread_mutex_unlock(&stats_mutex);
+    // Journal limité : un datagramme rejeté tous les 100 au plus
+    if (erreurs % 100 == 1)
+        WARN(TAG, "Datagramme de détection rejeté (%s), %lu au total",
+             resultat_detection_str(r), erreurs);
+    return -1;
+}
+
+static int ouvrir_socket_camera(void) {
     int sockfd;
-    struct sockaddr_in server_addr, sender_addr;
-    socklen_t addr_len = sizeof(sender_addr);
-    char buffer[BUFFER_SIZE];
+    struct sockaddr_in server_addr;
 
     if ((sockfd = socket(AF_INET, SOCK_DGRAM, 0)) < 0) {
-        perror("Erreur création socket");
-        pthread_exit(NULL);
+        ERR(TAG, "Erreur création socket : %s", strerror(errno));
+        return -1;
     }
 
+    // Horodatage noyau de l'arrivée de chaque datagramme (facultatif)
+    int un = 1;
+    if (setsockopt(sockfd, SOL_SOCKET, SO_TIMESTAMPNS, &un, sizeof(un)) < 0)
+        WARN(TAG, "SO_TIMESTAMPNS indisponible, arrivée horodatée à la lecture");
+
     memset(&server_addr, 0, sizeof(server_addr));
     server_addr.sin_family = AF_INET;
     server_addr.sin_addr.s_addr = inet_addr("127.0.0.1");
     server_addr.sin_port = htons(PORT);
 
     if (bind(sockfd, (struct sockaddr *)&server_addr, sizeof(server_addr)) < 0) {
-        perror("Erreur bind");
+        ERR(TAG, "Erreur bind : %s", strerror(errno));
         close(sockfd);
-        pthread_exit(NULL);
+        return -1;
     }
 
-    printf("Récepteur UDP prêt sur 127.0.0.1:%d\n", PORT);
-
-    while (1) {
-        int n = recvfrom(sockfd, buffer, BUFFER_SIZE - 1, 0,
-                         (struct sockaddr *)&sender_addr, &addr_len);
-        if (n < 0) {
-            perror("Erreur recvfrom");
-            break;
-        }
+    INFO(TAG, "Récepteur UDP prêt sur 127.0.0.1:%d", PORT);
+    return sockfd;
+}
 
-        buffer[n] = '\0';
+// Instant d'arrivée en CLOCK_MONOTONIC : le noyau horodate en CLOCK_REALTIME,
+// on reporte l'âge du datagramme sur l'horloge monotone
+static struct timespec instant_arrivee(struct msghdr* msg) {
+    struct timespec mono, reel;
+    clock_gettime(CLOCK_MONOTONIC, &mono);
+    for (struct cmsghdr* c = CMSG_FIRSTHDR(msg); c; c = CMSG_NXTHDR(msg, c)) {
+        if (c->cmsg_level != SOL_SOCKET || c->cmsg_type != SCM_TIMESTAMPNS) continue;
+        struct timespec noyau;
+        memcpy(&noyau, CMSG_DATA(c), sizeof(noyau));
+        clock_gettime(CLOCK_REALTIME, &reel);
+        long long age_ns = (long long)(reel.tv_sec - noyau.tv_sec) * 1000000000LL + (reel.tv_nsec - noyau.tv_nsec);
+        if (age_ns < 0) age_ns = 0;
+        long long t_ns = (long long)mono.tv_sec * 1000000000LL + mono.tv_nsec - age_ns;
+        mono.tv_sec = (time_t)(t_ns / 1000000000LL);
+        mono.tv_nsec = (long)(t_ns % 1000000000LL);
+        break;
+    }
+    return mono;
+}
 
-        DonneesDetection *detection = parse_json_to_donnees(buffer);
-        set_donnees_detection(detection);
-        DonneesDetection detection2;
-        get_donnees_detection(&detection2);
+static void bilan_camera(void) {
+    static struct timespec dernier_bilan;
+    static unsigned long perimees_bilan, erreurs_bilan;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (timespec_diff_s(dernier_bilan, now) < UDP_CAMERA_BILAN_S) return;
+    dernier_bilan = now;
+
+    StatsCamera s;
+    get_stats_camera(&s);
+    // Rien à signaler tant qu'aucun datagramme n'est écarté
+    if (s.perimees == perimees_bilan && s.erreurs == erreurs_bilan) return;
+    perimees_bilan = s.perimees;
+    erreurs_bilan = s.erreurs;
+    INFO(TAG, "Caméra : %lu reçus, %lu périmés, %lu rejetés, %lu images perdues, latence max %.1f ms",
+         s.recues, s.perimees, s.erreurs, s.images_perdues, s.latence_max_s * 1e3);
+}
 
-        printf("Nombre d’obstacles détectés : %d\n", detection2.count);
-        for (int i = 0; i < detection2.count; i++) {
-            printf("→ Obstacle %d : type=%d, pointG=(%f,%f,%f), pointD=(%f,%f,%f)\n",
-                i,
-                detection2.obstacle[i].type,
-                detection2.obstacle[i].pointg.x, detection2.obstacle[i].pointg.y, detection2.obstacle[i].pointg.z,
-                detection2.obstacle[i].pointd.x, detection2.obstacle[i].pointd.y, detection2.obstacle[i].pointd.z);
+/*  Vide la socket par lots de UDP_CAMERA_LOT avec recvmmsg et ne décode que le
+    datagramme le plus récent : si la voiture prend du retard, les images
+    intermédiaires sont comptées périmées au lieu d'être traitées dans l'ordre.
+    Retourne -1 si la socket est en erreur. */
+static int traiter_datagramme_camera(int sockfd) {
+    static char buffers[UDP_CAMERA_LOT][UDP_CAMERA_TAILLE_MAX];
+    static char controles[UDP_CAMERA_LOT][CMSG_SPACE(sizeof(struct timespec))];
+    static struct iovec iov[UDP_CAMERA_LOT];
+    static struct mmsghdr msgs[UDP_CAMERA_LOT];
+    static struct sockaddr_in sources[UDP_CAMERA_LOT];
+
+    // Le lot suivant réinitialise les en-têtes : ce qui décrit le dernier
+    // datagramme (taille, troncature, horodatage) est relevé à chaque lot
+    int dernier = -1;
+    size_t n = 0;
+    bool tronque = false;
+    struct timespec arrivee;
+    unsigned long lus = 0;
+    int flags = MSG_WAITFORONE;   // bloque pour le premier datagramme seulement
+    for (;;) {
+        for (int i = 0; i < UDP_CAMERA_LOT; i++) {
+            iov[i].iov_base = buffers[i];
+            iov[i].iov_len = UDP_CAMERA_TAILLE_MAX;
+            memset(&msgs[i].msg_hdr, 0, sizeof(msgs[i].msg_hdr));
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            msgs[i].msg_hdr.msg_name = &sources[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(sources[i]);
+            msgs[i].msg_hdr.msg_control = controles[i];
+            msgs[i].msg_hdr.msg_controllen = sizeof(controles[i]);
         }
+        int recus = recvmmsg(sockfd, msgs, UDP_CAMERA_LOT, flags, NULL);
+        if (recus < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            ERR(TAG, "Erreur recvmmsg : %s", strerror(errno));
+            return -1;
+        }
+        lus += recus;
+        dernier = recus - 1;
+        n = msgs[dernier].msg_len;
+        tronque = (msgs[dernier].msg_hdr.msg_flags & MSG_TRUNC) != 0;
+        arrivee = instant_arrivee(&msgs[dernier].msg_hdr);
+        if (recus < UDP_CAMERA_LOT) break;
+        flags = MSG_DONTWAIT;     // lot plein : il en reste peut-être d'autres
+    }
+    if (dernier < 0) return 0;
+    const char* buffer = buffers[dernier];
+
+    pthread_mutex_lock(&stats_mutex);
+    stats.recues += lus;
+    stats.perimees += lus - 1;
+    stats.derniere_arrivee = arrivee;
+    pthread_mutex_unlock(&stats_mutex);
+
+    // Décodé sur place dans une structure statique : aucune allocation par datagramme.
+    // Binaire si le datagramme commence par le magic, JSON sinon.
+    static DonneesDetection detection;
+    int ok;
+    if (tronque)
+        ok = rejeter_datagramme(DETECTION_TAILLE);
+    else
+        ok = est_datagramme_binaire((const uint8_t*)buffer, n)
+                 ? decoder_datagramme_binaire((const uint8_t*)buffer, n, &detection)
+                 : parse_json_to_donnees(buffer, n, &detection);
+    if (ok == 0) {
+        publier_detection(&detection, arrivee);
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        double latence = timespec_diff_s(arrivee, now);
+        pthread_mutex_lock(&stats_mutex);
+        if (latence > stats.latence_max_s) stats.latence_max_s = latence;
+        pthread_mutex_unlock(&stats_mutex);
+    }
+    bilan_camera();
+
+#ifdef DEBUG
+    char sender_ip[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &sources[dernier].sin_addr, sender_ip, INET_ADDRSTRLEN);
+    DBG(TAG, "%lu datagramme(s) lu(s), traité : %zu octets de %s:%d, %d obstacle(s)",
+        lus, n, sender_ip, ntohs(sources[dernier].sin_port), ok == 0 ? detection.count : -1);
+#endif
+    return 0;
+}
+
+void* initialisation_communication_camera(void* arg) {
+    int sockfd = ouvrir_socket_camera();
+    if (sockfd < 0) pthread_exit(NULL);
 
-        char sender_ip[INET_ADDRSTRLEN];
-        inet_ntop(AF_INET, &(sender_addr.sin_addr), sender_ip, INET_ADDRSTRLEN);
-        printf("Message reçu de %s:%d\n", sender_ip, ntohs(sender_addr.sin_port));
-        printf("Contenu JSON (%d octets) :\n%s\n\n", n, buffer);
-        fflush(stdout);
-        
+    while (traiter_datagramme_camera(sockfd) == 0) {
     }
 
     close(sockfd);
     pthread_exit(NULL);
 }
 
-DonneesDetection* parse_json_to_donnees(const char *json_str) {
-    DonneesDetection *data = malloc(sizeof(DonneesDetection));
-    if (!data) {
-        fprintf(stderr, "Erreur malloc DonneesDetection\n");
-        return NULL;
+static void gestionnaire_camera(int fd, uint32_t evenements, void* ctx) {
+    (void)evenements;
+    (void)ctx;
+    if (traiter_datagramme_camera(fd) < 0) {
+        reacteur_retirer_fd(fd);
+        close(fd);
     }
-    memset(data, 0, sizeof(DonneesDetection));
+}
 
-    cJSON *root = cJSON_Parse(json_str);
-    if (!root) {
-        fprintf(stderr, "Erreur JSON invalide\n");
-        free(data);
-        return NULL;
+int enregistrer_communication_camera(void) {
+    int sockfd = ouvrir_socket_camera();
+    if (sockfd < 0) return -1;
+    if (reacteur_ajouter_fd(sockfd, gestionnaire_camera, NULL) != 0) {
+        close(sockfd);
+        return -1;
     }
+    return 0;
+}
 
-    cJSON *count = cJSON_GetObjectItem(root, "count");
-    if (cJSON_IsNumber(count)) {
-        data->count = count->valueint;
-    }
 
-    cJSON *obstacles = cJSON_GetObjectItem(root, "obstacles");
-    if (cJSON_IsArray(obstacles)) {
-        int nb = cJSON_GetArraySize(obstacles);
-        if (nb > MAX_OBSTACLES_SIMULTANES)
-            nb = MAX_OBSTACLES_SIMULTANES;
-
-        for (int i = 0; i < nb; i++) {
-            cJSON *obstacle_obj = cJSON_GetArrayItem(obstacles, i);
-            cJSON *label = cJSON_GetObjectItem(obstacle_obj, "label");
-            cJSON *class_id = cJSON_GetObjectItem(obstacle_obj, "class_id");
-
-            if (cJSON_IsNumber(class_id))
-                data->obstacle[i].type = (ObstacleType)class_id->valueint;
-            else if (cJSON_IsString(label)) {
-                if (strcmp(label->valuestring, "PONT") == 0)
-                    data->obstacle[i].type = PONT;
-                else
-                    data->obstacle[i].type = OBSTACLE_VOITURE;
-            }
-
-            cJSON *pl = cJSON_GetObjectItem(obstacle_obj, "point_left");
-            cJSON *pr = cJSON_GetObjectItem(obstacle_obj, "point_right");
-
-            if (pl && cJSON_IsObject(pl)) {
-                data->obstacle[i].pointg.x = (int)(cJSON_GetObjectItem(pl, "x")->valuedouble * 1000);
-                data->obstacle[i].pointg.y = (int)(cJSON_GetObjectItem(pl, "y")->valuedouble * 1000);
-                data->obstacle[i].pointg.z = (int)(cJSON_GetObjectItem(pl, "z")->valuedouble * 1000);
-                data->obstacle[i].pointg.theta = (float)(cJSON_GetObjectItem(pl, "theta")->valuedouble * 180.0 / 3.14159);
-            }
-
-            if (pr && cJSON_IsObject(pr)) {
-                data->obstacle[i].pointd.x = (int)(cJSON_GetObjectItem(pr, "x")->valuedouble * 1000);
-                data->obstacle[i].pointd.y = (int)(cJSON_GetObjectItem(pr, "y")->valuedouble * 1000);
-                data->obstacle[i].pointd.z = (int)(cJSON_GetObjectItem(pr, "z")->valuedouble * 1000);
-                data->obstacle[i].pointd.theta = (float)(cJSON_GetObjectItem(pr, "theta")->valuedouble * 180.0 / 3.14159);
-            }
-        }
-    }
+void get_stats_camera(StatsCamera* s) {
+    pthread_mutex_lock(&stats_mutex);
+    *s = stats;
+    pthread_mutex_unlock(&stats_mutex);
+}
 
-    cJSON_Delete(root);
-    return data;
+int parse_json_to_donnees(const char *json_str, size_t len, DonneesDetection* data) {
+    ResultatDetection r = parser_json_detection(json_str, len, data);
+    return r == DETECTION_OK ? 0 : rejeter_datagramme(r);
 }
 
+int decoder_datagramme_binaire(const uint8_t* buf, size_t len, DonneesDetection* data) {
+    static bool premiere_image = true;
+    static uint32_t id_precedent = 0;
+    EnteteDetection entete;
+    ResultatDetection r = decoder_datagramme_detection(buf, len, data, &entete);
+    if (r != DETECTION_OK) return rejeter_datagramme(r);
+
+    // id_image est consécutif côté caméra : un saut signale des datagrammes perdus
+    uint32_t ecart = entete.id_image - id_precedent;
+    // (les images périmées, écartées sans décodage, apparaissent aussi ici)
+    if (!premiere_image && ecart > 1 && ecart < 1000) {
+        pthread_mutex_lock(&stats_mutex);
+        stats.images_perdues += ecart - 1;
+        pthread_mutex_unlock(&stats_mutex);
+    }
+    premiere_image = false;
+    id_precedent = entete.id_image;
+    return 0;
+}
@@ -1,9 +1,28 @@
 #ifndef UDP_VOITURE_H
 #define UDP_VOITURE_H
 
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
 #include "messages.h"
 
+typedef struct {
+    unsigned long recues;          // datagrammes lus sur la socket
+    unsigned long perimees;        // écartés sans décodage : un plus récent était arrivé
+    unsigned long erreurs;         // rejetés par le décodeur (ou tronqués)
+    unsigned long images_perdues;  // sauts d'id_image du datagramme binaire
+    struct timespec derniere_arrivee;  // horodatage noyau (CLOCK_MONOTONIC)
+    double latence_max_s;          // arrivée -> publication dans voiture_globals
+} StatsCamera;
+
 void* initialisation_communication_camera(void* arg);
-DonneesDetection* parse_json_to_donnees(const char *json_str);
+// Variante réacteur : ouvre la socket et la confie au réacteur (0 si OK)
+int enregistrer_communication_camera(void);
+// Compteurs de réception (lecture possible depuis n'importe quel thread)
+void get_stats_camera(StatsCamera* s);
+// Remplit *data (fourni par l'appelant) ; 0 si le datagramme est valide
+int parse_json_to_donnees(const char *json_str, size_t len, DonneesDetection* data);
+// Idem pour le datagramme binaire (datagramme_detection.h), compte les images perdues
+int decoder_datagramme_binaire(const uint8_t* buf, size_t len, DonneesDetection* data);
 
 #endif
@@ -0,0 +1,310 @@
+// anneau_detection.c
+#define _GNU_SOURCE  // syscall()
+#include "anneau_detection.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include "logger.h"
+#include "voiture_globals.h"
+#include "suivi_obstacles.h"
+
+#define TAG "anneau"
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t nb_cases;
+    uint32_t taille_case;
+    uint32_t publications;
+    uint32_t reserve;
+    uint64_t tete;
+    uint8_t reserve2[32];
+} EnteteAnneau;
+
+typedef struct {
+    uint32_t seq;
+    uint32_t taille;
+    uint8_t datagramme[];
+} CaseAnneau;
+
+_Static_assert(sizeof(EnteteAnneau) == ANNEAU_ENTETE, "en-tête de l'anneau : 64 octets");
+_Static_assert(ANNEAU_CASE >= sizeof(CaseAnneau) + DATAGRAMME_DETECTION_MAX, "case trop petite");
+
+static volatile bool actif = false;
+static StatsAnneau stats;
+static pthread_mutex_t stats_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static inline CaseAnneau* case_anneau(uint8_t* base, uint64_t n) {
+    return (CaseAnneau*)(base + ANNEAU_ENTETE + (n % ANNEAU_DETECTION_CASES) * ANNEAU_CASE);
+}
+
+static bool entete_valide(const EnteteAnneau* e) {
+    return memcmp(e->magic, ANNEAU_DETECTION_MAGIC, 4) == 0 && e->version == ANNEAU_DETECTION_VERSION &&
+           e->nb_cases == ANNEAU_DETECTION_CASES && e->taille_case == ANNEAU_CASE;
+}
+
+// Crée le segment si besoin ; l'en-tête n'est réinitialisé que s'il ne correspond pas
+static uint8_t* ouvrir_segment(const char* nom) {
+    int fd = shm_open(nom, O_RDWR | O_CREAT, 0666);
+    if (fd < 0) {
+        ERR(TAG, "shm_open(%s) : %s", nom, strerror(errno));
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (st.st_size < ANNEAU_TAILLE && ftruncate(fd, ANNEAU_TAILLE) < 0)) {
+        ERR(TAG, "Dimensionnement de %s : %s", nom, strerror(errno));
+        close(fd);
+        return NULL;
+    }
+    uint8_t* base = mmap(NULL, ANNEAU_TAILLE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        ERR(TAG, "mmap(%s) : %s", nom, strerror(errno));
+        return NULL;
+    }
+    EnteteAnneau* e = (EnteteAnneau*)base;
+    if (!entete_valide(e)) {
+        memset(base, 0, ANNEAU_TAILLE);
+        e->version = ANNEAU_DETECTION_VERSION;
+        e->nb_cases = ANNEAU_DETECTION_CASES;
+        e->taille_case = ANNEAU_CASE;
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        memcpy(e->magic, ANNEAU_DETECTION_MAGIC, 4);
+    }
+    return base;
+}
+
+/*  Décode la dernière image si elle est plus récente que *derniere.
+    Le décodeur lit directement la case partagée : c'est l'instantané du seqlock,
+    jeté si seq a bougé pendant la lecture.
+    Retourne 1 si *data contient une nouvelle image, 0 sinon. */
+static int lire_derniere(uint8_t* base, uint64_t* derniere, DonneesDetection* data) {
+    EnteteAnneau* e = (EnteteAnneau*)base;
+    for (int essai = 0; essai < 4; essai++) {
+        uint64_t tete = __atomic_load_n(&e->tete, __ATOMIC_ACQUIRE);
+        if (tete == *derniere) return 0;
+        CaseAnneau* c = case_anneau(base, tete - 1);
+        uint32_t s1 = __atomic_load_n(&c->seq, __ATOMIC_ACQUIRE);
+        ResultatDetection r = DETECTION_TAILLE;
+        if (!(s1 & 1)) {
+            uint32_t taille = c->taille;
+            EnteteDetection entete;
+            if (taille <= DATAGRAMME_DETECTION_MAX)
+                r = decoder_datagramme_detection(c->datagramme, taille, data, &entete);
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&c->seq, __ATOMIC_RELAXED) == s1) {
+                pthread_mutex_lock(&stats_mutex);
+                stats.perimees += tete - *derniere - 1;
+                if (r == DETECTION_OK) stats.lues++;
+                else stats.erreurs++;
+                pthread_mutex_unlock(&stats_mutex);
+                *derniere = tete;
+                return r == DETECTION_OK;
+            }
+        }
+        // Case en cours d'écriture ou réécrite pendant la lecture
+        pthread_mutex_lock(&stats_mutex);
+        stats.relectures++;
+        pthread_mutex_unlock(&stats_mutex);
+    }
+    return 0;
+}
+
+static void attendre_publication(uint8_t* base, uint32_t vu) {
+    EnteteAnneau* e = (EnteteAnneau*)base;
+    struct timespec attente = { 0, ANNEAU_ATTENTE_MS * 1000000L };
+    // Segment partagé entre processus : pas de FUTEX_PRIVATE_FLAG
+    syscall(SYS_futex, &e->publications, FUTEX_WAIT, vu, &attente, NULL, 0);
+}
+
+void* lancer_anneau_detection(void* arg) {
+    (void)arg;
+    uint8_t* base = ouvrir_segment(ANNEAU_DETECTION_NOM);
+    if (!base) return NULL;
+    EnteteAnneau* e = (EnteteAnneau*)base;
+    INFO(TAG, "Anneau de détections prêt : %s (%d cases de %d octets)",
+         ANNEAU_DETECTION_NOM, ANNEAU_DETECTION_CASES, ANNEAU_CASE);
+
+    // Les images publiées avant le démarrage sont ignorées
+    uint64_t derniere = __atomic_load_n(&e->tete, __ATOMIC_ACQUIRE);
+    static DonneesDetection detection;
+    actif = true;
+    while (actif) {
+        // publications est lu avant tete : une image publiée entre les deux réveille aussitôt
+        uint32_t vu = __atomic_load_n(&e->publications, __ATOMIC_ACQUIRE);
+        if (lire_derniere(base, &derniere, &detection)) {
+            struct timespec arrivee;
+            clock_gettime(CLOCK_MONOTONIC, &arrivee);
+            publier_detection(&detection, arrivee);
+        } else if (__atomic_load_n(&e->tete, __ATOMIC_ACQUIRE) == derniere)
+            attendre_publication(base, vu);
+    }
+    munmap(base, ANNEAU_TAILLE);
+    return NULL;
+}
+
+void arreter_anneau_detection(void) {
+    actif = false;
+}
+
+void get_stats_anneau(StatsAnneau* s) {
+    pthread_mutex_lock(&stats_mutex);
+    *s = stats;
+    pthread_mutex_unlock(&stats_mutex);
+}
+
+#ifdef BENCH
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include "utils.h"
+
+#define BENCH_ANNEAU_NOM "/voiture_detections_bench"
+#define BENCH_ANNEAU_ITER 100000
+
+// Producteur de référence (le vrai producteur est IA/anneau_detection.py)
+static void publier(uint8_t* base, const uint8_t* datagramme, size_t n) {
+    EnteteAnneau* e = (EnteteAnneau*)base;
+    uint64_t tete = __atomic_load_n(&e->tete, __ATOMIC_RELAXED);
+    CaseAnneau* c = case_anneau(base, tete);
+    uint32_t seq = __atomic_load_n(&c->seq, __ATOMIC_RELAXED);
+    __atomic_store_n(&c->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    c->taille = (uint32_t)n;
+    memcpy(c->datagramme, datagramme, n);
+    __atomic_store_n(&c->seq, seq + 2, __ATOMIC_RELEASE);
+    __atomic_store_n(&e->tete, tete + 1, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&e->publications, 1, __ATOMIC_RELEASE);
+    syscall(SYS_futex, &e->publications, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+typedef struct {
+    uint8_t* base;
+    volatile bool fin;
+} ProducteurBench;
+
+// Chaque image porte son numéro dans tous ses points : une lecture déchirée se voit
+static void image_numerotee(DonneesDetection* d, int numero) {
+    for (int i = 0; i < d->count; i++)
+        d->obstacle[i].pointg.x = d->obstacle[i].pointd.x = (float)(numero % 30000);
+    for (int k = 0; k < d->marquage_sol.nb_points_gauche; k++)
+        d->marquage_sol.ligne_gauche[k].x = (float)(numero % 30000);
+    for (int k = 0; k < d->marquage_sol.nb_points_droite; k++)
+        d->marquage_sol.ligne_droite[k].x = (float)(numero % 30000);
+}
+
+static bool image_coherente(const DonneesDetection* d) {
+    float x = d->marquage_sol.nb_points_gauche ? d->marquage_sol.ligne_gauche[0].x : d->obstacle[0].pointg.x;
+    for (int i = 0; i < d->count; i++)
+        if (d->obstacle[i].pointg.x != x || d->obstacle[i].pointd.x != x) return false;
+    for (int k = 0; k < d->marquage_sol.nb_points_gauche; k++)
+        if (d->marquage_sol.ligne_gauche[k].x != x) return false;
+    for (int k = 0; k < d->marquage_sol.nb_points_droite; k++)
+        if (d->marquage_sol.ligne_droite[k].x != x) return false;
+    return true;
+}
+
+static DonneesDetection modele;
+
+static void* producteur_bench(void* arg) {
+    ProducteurBench* p = arg;
+    static DonneesDetection d;
+    static uint8_t datagramme[DATAGRAMME_DETECTION_MAX];
+    EnteteDetection entete = { DATAGRAMME_DETECTION_VERSION, 0, 0 };
+    d = modele;
+    for (int numero = 1; !p->fin; numero++) {
+        image_numerotee(&d, numero);
+        entete.id_image = numero;
+        size_t n = encoder_datagramme_detection(&d, &entete, datagramme, sizeof(datagramme));
+        publier(p->base, datagramme, n);
+    }
+    return NULL;
+}
+
+void benchmark_anneau_detection(void) {
+    static char json[16384];
+    static uint8_t datagramme[DATAGRAMME_DETECTION_MAX];
+    static uint8_t reception[DATAGRAMME_DETECTION_MAX];
+    static DonneesDetection d;
+    EnteteDetection entete = { DATAGRAMME_DETECTION_VERSION, 1, 0 }, lu;
+    struct timespec t0, t1;
+
+    size_t n_json = generer_datagramme_json(json, sizeof(json), MAX_OBSTACLES_SIMULTANES);
+    parser_json_detection(json, n_json, &modele);
+    size_t n = encoder_datagramme_detection(&modele, &entete, datagramme, sizeof(datagramme));
+
+    shm_unlink(BENCH_ANNEAU_NOM);
+    uint8_t* base = ouvrir_segment(BENCH_ANNEAU_NOM);
+    if (!base) return;
+    memset(&stats, 0, sizeof(stats));
+
+    // 1. Coût d'une image dans un seul thread : anneau vs boucle locale UDP
+    uint64_t derniere = 0;
+    unsigned long lues = 0;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int i = 0; i < BENCH_ANNEAU_ITER; i++) {
+        publier(base, datagramme, n);
+        lues += lire_derniere(base, &derniere, &d);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double dt_anneau = timespec_diff_s(t0, t1);
+
+    int rx = socket(AF_INET, SOCK_DGRAM, 0), tx = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in adresse = { .sin_family = AF_INET, .sin_port = 0 };
+    adresse.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t lg = sizeof(adresse);
+    bind(rx, (struct sockaddr*)&adresse, sizeof(adresse));
+    getsockname(rx, (struct sockaddr*)&adresse, &lg);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int i = 0; i < BENCH_ANNEAU_ITER; i++) {
+        sendto(tx, datagramme, n, 0, (struct sockaddr*)&adresse, sizeof(adresse));
+        ssize_t r = recv(rx, reception, sizeof(reception), 0);
+        if (r > 0) lues += decoder_datagramme_detection(reception, r, &d, &lu) == DETECTION_OK;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double dt_udp = timespec_diff_s(t0, t1);
+    close(rx);
+    close(tx);
+    INFO(TAG, "Image de %zu octets : anneau %.2f us, UDP local %.2f us (%lu lues)",
+         n, dt_anneau / BENCH_ANNEAU_ITER * 1e6, dt_udp / BENCH_ANNEAU_ITER * 1e6, lues);
+
+    // 2. Producteur en continu dans un autre thread : aucune image déchirée ne doit passer
+    memset(&stats, 0, sizeof(stats));
+    ProducteurBench p = { base, false };
+    pthread_t producteur;
+    pthread_create(&producteur, NULL, producteur_bench, &p);
+    unsigned long incoherentes = 0;
+    derniere = __atomic_load_n(&((EnteteAnneau*)base)->tete, __ATOMIC_ACQUIRE);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    do {
+        EnteteAnneau* e = (EnteteAnneau*)base;
+        uint32_t vu = __atomic_load_n(&e->publications, __ATOMIC_ACQUIRE);
+        if (lire_derniere(base, &derniere, &d)) {
+            if (!image_coherente(&d)) incoherentes++;
+        } else if (__atomic_load_n(&e->tete, __ATOMIC_ACQUIRE) == derniere) {
+            attendre_publication(base, vu);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+    } while (timespec_diff_s(t0, t1) < 1.0);
+    p.fin = true;
+    pthread_join(producteur, NULL);
+
+    StatsAnneau s;
+    get_stats_anneau(&s);
+    if (incoherentes > 0)
+        ERR(TAG, "Anneau : %lu images déchirées acceptées", incoherentes);
+    INFO(TAG, "Anneau sous charge (1 s) : %lu lues, %lu périmées, %lu relectures, %lu erreurs, %lu déchirées",
+         s.lues, s.perimees, s.relectures, s.erreurs, incoherentes);
+
+    munmap(base, ANNEAU_TAILLE);
+    shm_unlink(BENCH_ANNEAU_NOM);
+    memset(&stats, 0, sizeof(stats));
+}
+#endif
@@ -0,0 +1,67 @@
+// anneau_detection.h
+#ifndef ANNEAU_DETECTION_H
+#define ANNEAU_DETECTION_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "messages.h"
+#include "config.h"
+#include "datagramme_detection.h"
+
+/*  Transport optionnel des détections par mémoire partagée (shm_open), en
+    plus de l'UDP : la vision (producteur unique) écrit, la voiture (consommateur
+    unique) lit la case la plus récente sans appel système ni copie hors de
+    l'instantané protégé par seqlock. Pendant Python : IA/anneau_detection.py.
+
+    Segment ANNEAU_DETECTION_NOM, little-endian, champs alignés :
+    En-tête (64 octets)
+        0  magic[4]       "SDRG"
+        4  version u32    ANNEAU_DETECTION_VERSION
+        8  nb_cases u32   ANNEAU_DETECTION_CASES
+        12 taille_case u32    ANNEAU_CASE (écart entre deux cases)
+        16 publications u32   incrémenté après chaque image, mot futex du réveil
+        20 réservé u32
+        24 tete u64       nombre d'images publiées ; la dernière est dans la case (tete-1) % nb_cases
+        32 réservé jusqu'à 64
+    Puis nb_cases cases de taille_case octets
+        0  seq u32        seqlock : impair pendant l'écriture
+        4  taille u32     octets utiles du datagramme
+        8  datagramme     format binaire de datagramme_detection.h
+
+    Producteur, pour l'image n (tete vaut n) :
+        case = n % nb_cases ; seq += 1 ; écrire taille et datagramme ; seq += 1
+        tete = n + 1 ; publications += 1 ; FUTEX_WAKE sur publications (facultatif)
+    Ces écritures doivent être des stores release (tete atomique sur 8 octets) :
+    le producteur Python passe par IA/anneau_publication.c hors x86.
+    Sans réveil, la voiture relit le segment toutes les ANNEAU_ATTENTE_MS.
+
+    La voiture crée et initialise le segment ; le producteur doit vérifier
+    magic, version, nb_cases et taille_case avant d'écrire.
+*/
+
+#define ANNEAU_DETECTION_MAGIC "SDRG"
+#define ANNEAU_DETECTION_VERSION 1
+#define ANNEAU_ENTETE 64
+#define ANNEAU_CASE (((8 + DATAGRAMME_DETECTION_MAX) + 63) / 64 * 64)
+#define ANNEAU_TAILLE (ANNEAU_ENTETE + ANNEAU_DETECTION_CASES * ANNEAU_CASE)
+
+// Thread consommateur : publie chaque nouvelle image dans voiture_globals
+void* lancer_anneau_detection(void* arg);
+void arreter_anneau_detection(void);
+
+typedef struct {
+    unsigned long lues;       // images décodées et publiées
+    unsigned long perimees;   // images écrasées avant d'être lues
+    unsigned long relectures; // instantanés invalidés par le producteur (seqlock)
+    unsigned long erreurs;    // datagrammes rejetés par le décodeur
+} StatsAnneau;
+
+void get_stats_anneau(StatsAnneau* s);
+
+#ifdef BENCH
+// Coût par image : publication + lecture dans l'anneau face à sendto + recv UDP
+void benchmark_anneau_detection(void);
+#endif
+
+#endif
@@ -0,0 +1,200 @@
+// datagramme_detection.c
+#include "datagramme_detection.h"
+#include "config.h"
+#include <string.h>
+#include <math.h>
+
+#define RAD_VERS_DEG (180.0 / 3.14159)   // même conversion que la voie JSON
+#define THETA_ECHELLE 1e-4               // unité de theta dans le datagramme [rad]
+
+static inline uint16_t lire_u16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t lire_u32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline void ecrire_u16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void ecrire_u32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static int16_t saturer_i16(double v) {
+    if (v > INT16_MAX) return INT16_MAX;
+    if (v < INT16_MIN) return INT16_MIN;
+    return (int16_t)v;
+}
+
+static void lire_point(const uint8_t* p, Point* pt) {
+    pt->x = (int16_t)lire_u16(p);
+    pt->y = (int16_t)lire_u16(p + 2);
+    pt->z = (int16_t)lire_u16(p + 4);
+    pt->theta = (float)((int16_t)lire_u16(p + 6) * THETA_ECHELLE * RAD_VERS_DEG);
+}
+
+static void ecrire_point(uint8_t* p, const Point* pt) {
+    ecrire_u16(p, (uint16_t)saturer_i16(pt->x));
+    ecrire_u16(p + 2, (uint16_t)saturer_i16(pt->y));
+    ecrire_u16(p + 4, (uint16_t)saturer_i16(pt->z));
+    ecrire_u16(p + 6, (uint16_t)saturer_i16(lround(pt->theta / RAD_VERS_DEG / THETA_ECHELLE)));
+}
+
+bool est_datagramme_binaire(const uint8_t* buf, size_t len) {
+    return len >= 4 && memcmp(buf, DATAGRAMME_DETECTION_MAGIC, 4) == 0;
+}
+
+ResultatDetection decoder_datagramme_detection(const uint8_t* buf, size_t len,
+                                               DonneesDetection* data, EnteteDetection* entete) {
+    if (len < DATAGRAMME_ENTETE) return len == 0 ? DETECTION_VIDE : DETECTION_TAILLE;
+    if (!est_datagramme_binaire(buf, len)) return DETECTION_SYNTAXE;
+    if (buf[4] != DATAGRAMME_DETECTION_VERSION) return DETECTION_VERSION;
+    size_t taille_entete = lire_u16(buf + 6);
+    if (taille_entete < DATAGRAMME_ENTETE) return DETECTION_SYNTAXE;
+
+    int nb_obstacles = buf[20];
+    int nb_gauche = buf[21];
+    int nb_droite = buf[22];
+    size_t attendu = taille_entete + (size_t)nb_obstacles * DATAGRAMME_OBSTACLE +
+                     (size_t)(nb_gauche + nb_droite) * DATAGRAMME_POINT;
+    if (len < attendu) return DETECTION_TAILLE;
+    if (len > attendu) return DETECTION_EN_TROP;
+
+    entete->version = buf[4];
+    entete->id_image = lire_u32(buf + 8);
+    entete->t_capture_us = (uint64_t)lire_u32(buf + 12) | ((uint64_t)lire_u32(buf + 16) << 32);
+
+    // Comme pour le JSON : au-delà des tailles de DonneesDetection, on ignore
+    memset(data, 0, sizeof(*data));
+    const uint8_t* p = buf + taille_entete;
+    for (int i = 0; i < nb_obstacles; i++, p += DATAGRAMME_OBSTACLE) {
+        if (i >= MAX_OBSTACLES_SIMULTANES) continue;
+        data->obstacle[i].type = (ObstacleType)p[0];
+        lire_point(p + 4, &data->obstacle[i].pointg);
+        lire_point(p + 4 + DATAGRAMME_POINT, &data->obstacle[i].pointd);
+    }
+    data->count = nb_obstacles < MAX_OBSTACLES_SIMULTANES ? nb_obstacles : MAX_OBSTACLES_SIMULTANES;
+
+    MarquageSol* ms = &data->marquage_sol;
+    for (int k = 0; k < nb_gauche; k++, p += DATAGRAMME_POINT)
+        if (k < MAX_POINTS_MARQUAGE) lire_point(p, &ms->ligne_gauche[ms->nb_points_gauche++]);
+    for (int k = 0; k < nb_droite; k++, p += DATAGRAMME_POINT)
+        if (k < MAX_POINTS_MARQUAGE) lire_point(p, &ms->ligne_droite[ms->nb_points_droite++]);
+    return DETECTION_OK;
+}
+
+size_t encoder_datagramme_detection(const DonneesDetection* data, const EnteteDetection* entete,
+                                    uint8_t* out, size_t max) {
+    int nb_obstacles = data->count < MAX_OBSTACLES_SIMULTANES ? data->count : MAX_OBSTACLES_SIMULTANES;
+    int nb_gauche = data->marquage_sol.nb_points_gauche;
+    int nb_droite = data->marquage_sol.nb_points_droite;
+    if (nb_obstacles < 0 || nb_gauche < 0 || nb_droite < 0 ||
+        nb_gauche > MAX_POINTS_MARQUAGE || nb_droite > MAX_POINTS_MARQUAGE)
+        return 0;
+    size_t taille = DATAGRAMME_ENTETE + (size_t)nb_obstacles * DATAGRAMME_OBSTACLE +
+                    (size_t)(nb_gauche + nb_droite) * DATAGRAMME_POINT;
+    if (taille > max) return 0;
+
+    memset(out, 0, DATAGRAMME_ENTETE);
+    memcpy(out, DATAGRAMME_DETECTION_MAGIC, 4);
+    out[4] = DATAGRAMME_DETECTION_VERSION;
+    ecrire_u16(out + 6, DATAGRAMME_ENTETE);
+    ecrire_u32(out + 8, entete->id_image);
+    ecrire_u32(out + 12, (uint32_t)entete->t_capture_us);
+    ecrire_u32(out + 16, (uint32_t)(entete->t_capture_us >> 32));
+    out[20] = (uint8_t)nb_obstacles;
+    out[21] = (uint8_t)nb_gauche;
+    out[22] = (uint8_t)nb_droite;
+
+    uint8_t* p = out + DATAGRAMME_ENTETE;
+    for (int i = 0; i < nb_obstacles; i++, p += DATAGRAMME_OBSTACLE) {
+        memset(p, 0, 4);
+        p[0] = (uint8_t)data->obstacle[i].type;
+        ecrire_point(p + 4, &data->obstacle[i].pointg);
+        ecrire_point(p + 4 + DATAGRAMME_POINT, &data->obstacle[i].pointd);
+    }
+    for (int k = 0; k < nb_gauche; k++, p += DATAGRAMME_POINT)
+        ecrire_point(p, &data->marquage_sol.ligne_gauche[k]);
+    for (int k = 0; k < nb_droite; k++, p += DATAGRAMME_POINT)
+        ecrire_point(p, &data->marquage_sol.ligne_droite[k]);
+    return taille;
+}
+
+#ifdef BENCH
+#include <time.h>
+#include "logger.h"
+#include "utils.h"
+
+#define TAG "udp"
+#define BENCH_DATAGRAMME_ITER 100000
+
+// Le binaire quantifie theta à 1e-4 rad (~0.006°) ; les mm sont identiques
+static bool memes_points(const Point* a, const Point* b) {
+    return a->x == b->x && a->y == b->y && a->z == b->z && fabsf(a->theta - b->theta) <= 0.01f;
+}
+
+static bool memes_donnees(const DonneesDetection* a, const DonneesDetection* b) {
+    if (a->count != b->count ||
+        a->marquage_sol.nb_points_gauche != b->marquage_sol.nb_points_gauche ||
+        a->marquage_sol.nb_points_droite != b->marquage_sol.nb_points_droite)
+        return false;
+    for (int i = 0; i < a->count; i++)
+        if (a->obstacle[i].type != b->obstacle[i].type ||
+            !memes_points(&a->obstacle[i].pointg, &b->obstacle[i].pointg) ||
+            !memes_points(&a->obstacle[i].pointd, &b->obstacle[i].pointd))
+            return false;
+    for (int k = 0; k < a->marquage_sol.nb_points_gauche; k++)
+        if (!memes_points(&a->marquage_sol.ligne_gauche[k], &b->marquage_sol.ligne_gauche[k])) return false;
+    for (int k = 0; k < a->marquage_sol.nb_points_droite; k++)
+        if (!memes_points(&a->marquage_sol.ligne_droite[k], &b->marquage_sol.ligne_droite[k])) return false;
+    return true;
+}
+
+void benchmark_datagramme_detection(void) {
+    static char json[16384];
+    static uint8_t binaire[DATAGRAMME_DETECTION_MAX];
+    static DonneesDetection a, b;
+    EnteteDetection entete = { DATAGRAMME_DETECTION_VERSION, 42, 1761127519027070ull }, lu;
+    struct timespec t0, t1;
+
+    for (int nb = 0; nb <= MAX_OBSTACLES_SIMULTANES; nb++) {
+        size_t n_json = generer_datagramme_json(json, sizeof(json), nb);
+        parser_json_detection(json, n_json, &a);
+        size_t n_bin = encoder_datagramme_detection(&a, &entete, binaire, sizeof(binaire));
+        ResultatDetection r = decoder_datagramme_detection(binaire, n_bin, &b, &lu);
+        if (r != DETECTION_OK || !memes_donnees(&a, &b) || lu.id_image != entete.id_image ||
+            lu.t_capture_us != entete.t_capture_us)
+            ERR(TAG, "Datagramme binaire : aller-retour incorrect pour %d obstacles (%s)",
+                nb, resultat_detection_str(r));
+        // Toute troncature doit être refusée
+        for (size_t k = 0; k < n_bin; k++)
+            if (decoder_datagramme_detection(binaire, k, &b, &lu) == DETECTION_OK)
+                ERR(TAG, "Datagramme binaire tronqué à %zu octets accepté", k);
+
+        volatile int puits = 0;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        for (int i = 0; i < BENCH_DATAGRAMME_ITER; i++) {
+            parser_json_detection(json, n_json, &a);
+            puits += a.count;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        double dt_json = timespec_diff_s(t0, t1);
+
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        for (int i = 0; i < BENCH_DATAGRAMME_ITER; i++) {
+            decoder_datagramme_detection(binaire, n_bin, &b, &lu);
+            puits += b.count;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        double dt_bin = timespec_diff_s(t0, t1);
+
+        INFO(TAG, "Détection %d obstacles : JSON %zu o / %.2f us, binaire %zu o / %.2f us (taille /%.1f, temps /%.1f)",
+             nb, n_json, dt_json / BENCH_DATAGRAMME_ITER * 1e6, n_bin, dt_bin / BENCH_DATAGRAMME_ITER * 1e6,
+             (double)n_json / n_bin, dt_json / dt_bin);
+    }
+}
+#endif
@@ -0,0 +1,60 @@
+// datagramme_detection.h
+#ifndef DATAGRAMME_DETECTION_H
+#define DATAGRAMME_DETECTION_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "messages.h"
+#include "parseur_detection.h"
+
+/*  Datagramme binaire de détection (caméra -> voiture), little-endian,
+    pendant de IA/datagramme_detection.py :
+
+    En-tête (24 octets)
+        0  magic[4]        "SDET"
+        4  version  u8     DATAGRAMME_DETECTION_VERSION
+        5  drapeaux u8     réservé (0)
+        6  taille_entete u16   24 ; un décodeur saute les octets d'en-tête qu'il ne connaît pas
+        8  id_image u32    compteur d'images côté caméra (détection des pertes)
+        12 t_capture_us u64    instant de capture, µs depuis l'epoch (horloge caméra)
+        20 nb_obstacles u8, nb_points_gauche u8, nb_points_droite u8, réservé u8
+    Puis nb_obstacles x 20 octets
+        class_id u8, confiance u8 (x/255), réservé u16, point_gauche, point_droit
+    Puis nb_points_gauche x 8 octets, puis nb_points_droite x 8 octets (points)
+    Point (8 octets) : x, y, z en mm (int16), theta en 1e-4 rad (int16)
+
+    Les coordonnées sont déjà en mm : mêmes valeurs que la voie JSON, qui reste
+    acceptée (un datagramme qui ne commence pas par le magic est lu comme du JSON).
+*/
+
+#define DATAGRAMME_DETECTION_MAGIC "SDET"
+#define DATAGRAMME_DETECTION_VERSION 1
+#define DATAGRAMME_ENTETE 24
+#define DATAGRAMME_OBSTACLE 20
+#define DATAGRAMME_POINT 8
+#define DATAGRAMME_DETECTION_MAX (DATAGRAMME_ENTETE + MAX_OBSTACLES_SIMULTANES * DATAGRAMME_OBSTACLE + \
+                                  2 * MAX_POINTS_MARQUAGE * DATAGRAMME_POINT)
+
+typedef struct {
+    uint8_t version;
+    uint32_t id_image;
+    uint64_t t_capture_us;
+} EnteteDetection;
+
+bool est_datagramme_binaire(const uint8_t* buf, size_t len);
+
+// Remplit *data et *entete ; DETECTION_OK si le datagramme est complet et cohérent
+ResultatDetection decoder_datagramme_detection(const uint8_t* buf, size_t len,
+                                               DonneesDetection* data, EnteteDetection* entete);
+
+// Encodage (tests, outils) ; retourne la taille écrite, 0 si out est trop petit
+size_t encoder_datagramme_detection(const DonneesDetection* data, const EnteteDetection* entete,
+                                    uint8_t* out, size_t max);
+
+#ifdef BENCH
+// Taille et temps de décodage face au JSON, pour 0 à 5 obstacles et 64 points
+void benchmark_datagramme_detection(void);
+#endif
+
+#endif
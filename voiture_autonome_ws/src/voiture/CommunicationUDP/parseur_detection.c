@@ -0,0 +1,559 @@
+// parseur_detection.c
+#include "parseur_detection.h"
+#include "config.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include <float.h>
+
+/*  Parseur descendant propre au schéma : pas d'arbre intermédiaire, chaque
+    valeur est écrite à sa place dans DonneesDetection au moment où elle est lue.
+    Les objets et tableaux sont parcourus par parcourir_objet/parcourir_tableau
+    qui appellent un traitant par membre ; un traitant NULL saute la valeur.
+*/
+
+#define PROFONDEUR_MAX 8            // racine > obstacles > obstacle > point = 4
+#define CHIFFRES_SIGNIFICATIFS 19   // tiennent dans un uint64_t
+#define PUISSANCE_EXACTE_MAX 22     // 10^22 est le dernier exact en double
+#define EXPOSANT_MAX 308
+
+#define CLE(cle, len, lit) ((len) == sizeof(lit) - 1 && memcmp((cle), (lit), sizeof(lit) - 1) == 0)
+
+typedef struct {
+    const char* p;
+    const char* fin;
+    int profondeur;
+} Curseur;
+
+typedef ResultatDetection (*TraitantMembre)(Curseur* c, const char* cle, size_t len, void* ctx);
+typedef ResultatDetection (*TraitantElement)(Curseur* c, int indice, void* ctx);
+
+static const double puissances10[PUISSANCE_EXACTE_MAX + 1] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static inline bool est_chiffre(char ch) {
+    return ch >= '0' && ch <= '9';
+}
+
+static inline void sauter_blancs(Curseur* c) {
+    while (c->p < c->fin && (*c->p == ' ' || *c->p == '\n' || *c->p == '\r' || *c->p == '\t'))
+        c->p++;
+}
+
+static inline bool consommer(Curseur* c, char ch) {
+    sauter_blancs(c);
+    if (c->p < c->fin && *c->p == ch) {
+        c->p++;
+        return true;
+    }
+    return false;
+}
+
+static inline char prochain(Curseur* c) {
+    sauter_blancs(c);
+    return c->p < c->fin ? *c->p : '\0';
+}
+
+// Chaîne JSON : rend la portion brute entre guillemets (échappements validés, non décodés)
+static ResultatDetection lire_chaine(Curseur* c, const char** debut, size_t* len) {
+    if (!consommer(c, '"')) return DETECTION_SYNTAXE;
+    const char* d = c->p;
+    while (c->p < c->fin) {
+        unsigned char ch = (unsigned char)*c->p;
+        if (ch == '"') {
+            *debut = d;
+            *len = (size_t)(c->p - d);
+            c->p++;
+            return DETECTION_OK;
+        }
+        if (ch < 0x20) return DETECTION_SYNTAXE;
+        if (ch == '\\') {
+            if (++c->p >= c->fin) return DETECTION_SYNTAXE;
+            if (*c->p == 'u') {
+                if (c->fin - c->p < 5) return DETECTION_SYNTAXE;
+                for (int k = 1; k <= 4; k++) {
+                    char h = c->p[k];
+                    if (!est_chiffre(h) && !((h | 0x20) >= 'a' && (h | 0x20) <= 'f'))
+                        return DETECTION_SYNTAXE;
+                }
+                c->p += 4;
+            } else if (*c->p == '\0' || !strchr("\"\\/bfnrt", *c->p)) {
+                return DETECTION_SYNTAXE;
+            }
+        }
+        c->p++;
+    }
+    return DETECTION_SYNTAXE;
+}
+
+// Nombre selon la grammaire JSON : -?(0|[1-9]d*)(.d+)?([eE][+-]?d+)?
+static ResultatDetection lire_nombre(Curseur* c, double* val) {
+    sauter_blancs(c);
+    const char* p = c->p;
+    const char* fin = c->fin;
+    bool negatif = false;
+    if (p < fin && *p == '-') {
+        negatif = true;
+        p++;
+    }
+    if (p >= fin || !est_chiffre(*p)) return DETECTION_NOMBRE_INVALIDE;
+
+    uint64_t mantisse = 0;
+    int significatifs = 0, exposant = 0;
+    if (*p == '0') {
+        p++;
+        if (p < fin && est_chiffre(*p)) return DETECTION_NOMBRE_INVALIDE;  // zéro de tête
+    } else {
+        while (p < fin && est_chiffre(*p)) {
+            if (significatifs < CHIFFRES_SIGNIFICATIFS) {
+                mantisse = mantisse * 10 + (uint64_t)(*p - '0');
+                significatifs++;
+            } else {
+                exposant++;
+            }
+            p++;
+        }
+    }
+    if (p < fin && *p == '.') {
+        p++;
+        if (p >= fin || !est_chiffre(*p)) return DETECTION_NOMBRE_INVALIDE;
+        while (p < fin && est_chiffre(*p)) {
+            if (significatifs < CHIFFRES_SIGNIFICATIFS) {
+                mantisse = mantisse * 10 + (uint64_t)(*p - '0');
+                if (mantisse) significatifs++;
+                exposant--;
+            }
+            p++;
+        }
+    }
+    if (p < fin && (*p == 'e' || *p == 'E')) {
+        p++;
+        bool exp_negatif = false;
+        if (p < fin && (*p == '-' || *p == '+')) {
+            exp_negatif = (*p == '-');
+            p++;
+        }
+        if (p >= fin || !est_chiffre(*p)) return DETECTION_NOMBRE_INVALIDE;
+        int e = 0;
+        while (p < fin && est_chiffre(*p)) {
+            if (e < 10000) e = e * 10 + (*p - '0');
+            p++;
+        }
+        exposant += exp_negatif ? -e : e;
+    }
+
+    double v = (double)mantisse;
+    if (mantisse != 0) {
+        if (exposant > EXPOSANT_MAX) return DETECTION_NOMBRE_INVALIDE;
+        while (exposant > PUISSANCE_EXACTE_MAX) { v *= puissances10[PUISSANCE_EXACTE_MAX]; exposant -= PUISSANCE_EXACTE_MAX; }
+        while (exposant < -PUISSANCE_EXACTE_MAX && v != 0.0) { v /= puissances10[PUISSANCE_EXACTE_MAX]; exposant += PUISSANCE_EXACTE_MAX; }
+        if (exposant >= 0) v *= puissances10[exposant];
+        else if (v != 0.0) v /= puissances10[-exposant];
+        if (v > DBL_MAX) return DETECTION_NOMBRE_INVALIDE;
+    }
+    *val = negatif ? -v : v;
+    c->p = p;
+    return DETECTION_OK;
+}
+
+static ResultatDetection lire_litteral(Curseur* c, const char* lit, size_t len) {
+    if ((size_t)(c->fin - c->p) < len || memcmp(c->p, lit, len) != 0) return DETECTION_SYNTAXE;
+    c->p += len;
+    return DETECTION_OK;
+}
+
+static ResultatDetection sauter_valeur(Curseur* c);
+
+static ResultatDetection parcourir_objet(Curseur* c, TraitantMembre traitant, void* ctx) {
+    if (!consommer(c, '{')) return DETECTION_SYNTAXE;
+    if (++c->profondeur > PROFONDEUR_MAX) return DETECTION_TROP_PROFOND;
+    if (!consommer(c, '}')) {
+        do {
+            const char* cle;
+            size_t len;
+            ResultatDetection r = lire_chaine(c, &cle, &len);
+            if (r != DETECTION_OK) return r;
+            if (!consommer(c, ':')) return DETECTION_SYNTAXE;
+            r = traitant ? traitant(c, cle, len, ctx) : sauter_valeur(c);
+            if (r != DETECTION_OK) return r;
+        } while (consommer(c, ','));
+        if (!consommer(c, '}')) return DETECTION_SYNTAXE;
+    }
+    c->profondeur--;
+    return DETECTION_OK;
+}
+
+static ResultatDetection parcourir_tableau(Curseur* c, TraitantElement traitant, void* ctx) {
+    if (!consommer(c, '[')) return DETECTION_SYNTAXE;
+    if (++c->profondeur > PROFONDEUR_MAX) return DETECTION_TROP_PROFOND;
+    if (!consommer(c, ']')) {
+        int i = 0;
+        do {
+            ResultatDetection r = traitant ? traitant(c, i, ctx) : sauter_valeur(c);
+            if (r != DETECTION_OK) return r;
+            i++;
+        } while (consommer(c, ','));
+        if (!consommer(c, ']')) return DETECTION_SYNTAXE;
+    }
+    c->profondeur--;
+    return DETECTION_OK;
+}
+
+static ResultatDetection sauter_valeur(Curseur* c) {
+    const char* debut;
+    size_t len;
+    double v;
+    switch (prochain(c)) {
+        case '"': return lire_chaine(c, &debut, &len);
+        case '{': return parcourir_objet(c, NULL, NULL);
+        case '[': return parcourir_tableau(c, NULL, NULL);
+        case 't': return lire_litteral(c, "true", 4);
+        case 'f': return lire_litteral(c, "false", 5);
+        case 'n': return lire_litteral(c, "null", 4);
+        case '\0': return DETECTION_SYNTAXE;
+        default: return lire_nombre(c, &v);
+    }
+}
+
+// Un champ numérique d'un autre type est ignoré, comme avec l'ancien parseur cJSON
+static ResultatDetection lire_nombre_facultatif(Curseur* c, double* val, bool* present) {
+    char ch = prochain(c);
+    *present = (ch == '-' || est_chiffre(ch));
+    return *present ? lire_nombre(c, val) : sauter_valeur(c);
+}
+
+// --- Schéma ---
+
+static ResultatDetection membre_point(Curseur* c, const char* cle, size_t len, void* ctx) {
+    Point* pt = ctx;
+    float* champ;
+    if (CLE(cle, len, "x")) champ = &pt->x;
+    else if (CLE(cle, len, "y")) champ = &pt->y;
+    else if (CLE(cle, len, "z")) champ = &pt->z;
+    else if (CLE(cle, len, "theta")) champ = &pt->theta;
+    else return sauter_valeur(c);
+
+    double v;
+    bool present;
+    ResultatDetection r = lire_nombre_facultatif(c, &v, &present);
+    if (r != DETECTION_OK || !present) return r;
+    if (champ == &pt->theta) {
+        double deg = v * 180.0 / 3.14159;
+        if (deg > FLT_MAX || deg < -FLT_MAX) return DETECTION_NOMBRE_INVALIDE;
+        *champ = (float)deg;
+    } else {
+        double mm = v * 1000;
+        if (mm >= INT_MAX || mm <= INT_MIN) return DETECTION_NOMBRE_INVALIDE;
+        *champ = (int)mm;
+    }
+    return DETECTION_OK;
+}
+
+static ResultatDetection lire_point(Curseur* c, Point* pt) {
+    return prochain(c) == '{' ? parcourir_objet(c, membre_point, pt) : sauter_valeur(c);
+}
+
+typedef struct {
+    Obstacle* obstacle;
+    bool class_id_vu;
+    bool label_vu;
+    bool label_pont;
+} ObstacleEnCours;
+
+static ResultatDetection membre_obstacle(Curseur* c, const char* cle, size_t len, void* ctx) {
+    ObstacleEnCours* o = ctx;
+    if (CLE(cle, len, "point_left")) return lire_point(c, &o->obstacle->pointg);
+    if (CLE(cle, len, "point_right")) return lire_point(c, &o->obstacle->pointd);
+    if (CLE(cle, len, "class_id")) {
+        double v;
+        bool present;
+        ResultatDetection r = lire_nombre_facultatif(c, &v, &present);
+        if (r != DETECTION_OK || !present) return r;
+        if (v > INT_MAX || v < INT_MIN) return DETECTION_NOMBRE_INVALIDE;
+        o->obstacle->type = (ObstacleType)(int)v;
+        o->class_id_vu = true;
+        return DETECTION_OK;
+    }
+    if (CLE(cle, len, "label") && prochain(c) == '"') {
+        const char* label;
+        size_t n;
+        ResultatDetection r = lire_chaine(c, &label, &n);
+        if (r != DETECTION_OK) return r;
+        o->label_vu = true;
+        o->label_pont = CLE(label, n, "PONT");
+        return DETECTION_OK;
+    }
+    return sauter_valeur(c);
+}
+
+static ResultatDetection element_obstacle(Curseur* c, int indice, void* ctx) {
+    DonneesDetection* data = ctx;
+    if (indice >= MAX_OBSTACLES_SIMULTANES || prochain(c) != '{') return sauter_valeur(c);
+
+    ObstacleEnCours o = { &data->obstacle[indice], false, false, false };
+    ResultatDetection r = parcourir_objet(c, membre_obstacle, &o);
+    // class_id prime sur le label, quel que soit l'ordre des clés
+    if (r == DETECTION_OK && !o.class_id_vu && o.label_vu)
+        o.obstacle->type = o.label_pont ? PONT : OBSTACLE_VOITURE;
+    return r;
+}
+
+typedef struct {
+    Point* points;
+    int* nb_points;
+} LigneEnCours;
+
+static ResultatDetection element_ligne(Curseur* c, int indice, void* ctx) {
+    LigneEnCours* l = ctx;
+    if (indice >= MAX_POINTS_MARQUAGE) return sauter_valeur(c);
+    *l->nb_points = indice + 1;
+    return lire_point(c, &l->points[indice]);
+}
+
+static ResultatDetection lire_ligne(Curseur* c, Point* points, int* nb_points) {
+    LigneEnCours l = { points, nb_points };
+    return prochain(c) == '[' ? parcourir_tableau(c, element_ligne, &l) : sauter_valeur(c);
+}
+
+static ResultatDetection membre_marquage(Curseur* c, const char* cle, size_t len, void* ctx) {
+    MarquageSol* ms = ctx;
+    if (CLE(cle, len, "ligne_gauche")) return lire_ligne(c, ms->ligne_gauche, &ms->nb_points_gauche);
+    if (CLE(cle, len, "ligne_droite")) return lire_ligne(c, ms->ligne_droite, &ms->nb_points_droite);
+    return sauter_valeur(c);
+}
+
+static ResultatDetection membre_racine(Curseur* c, const char* cle, size_t len, void* ctx) {
+    DonneesDetection* data = ctx;
+    if (CLE(cle, len, "count")) {
+        double v;
+        bool present;
+        ResultatDetection r = lire_nombre_facultatif(c, &v, &present);
+        if (r != DETECTION_OK || !present) return r;
+        // count sert d'indice dans obstacle[] côté comportement
+        data->count = v < 0 ? 0 : (v > MAX_OBSTACLES_SIMULTANES ? MAX_OBSTACLES_SIMULTANES : (int)v);
+        return DETECTION_OK;
+    }
+    if (CLE(cle, len, "obstacles"))
+        return prochain(c) == '[' ? parcourir_tableau(c, element_obstacle, data) : sauter_valeur(c);
+    if (CLE(cle, len, "marquage_sol"))
+        return prochain(c) == '{' ? parcourir_objet(c, membre_marquage, &data->marquage_sol) : sauter_valeur(c);
+    return sauter_valeur(c);
+}
+
+ResultatDetection parser_json_detection(const char* json, size_t len, DonneesDetection* data) {
+    Curseur c = { json, json + len, 0 };
+    // Tampon de réception terminé par '\0' : on ne compte pas ce dernier
+    while (c.fin > c.p && c.fin[-1] == '\0') c.fin--;
+    memset(data, 0, sizeof(*data));
+
+    char ch = prochain(&c);
+    if (ch == '\0') return DETECTION_VIDE;
+    if (ch != '{') return DETECTION_SYNTAXE;
+    ResultatDetection r = parcourir_objet(&c, membre_racine, data);
+    if (r != DETECTION_OK) return r;
+    sauter_blancs(&c);
+    return c.p == c.fin ? DETECTION_OK : DETECTION_EN_TROP;
+}
+
+const char* resultat_detection_str(ResultatDetection r) {
+    switch (r) {
+        case DETECTION_OK: return "ok";
+        case DETECTION_VIDE: return "datagramme vide";
+        case DETECTION_SYNTAXE: return "syntaxe";
+        case DETECTION_NOMBRE_INVALIDE: return "nombre invalide";
+        case DETECTION_TROP_PROFOND: return "trop profond";
+        case DETECTION_EN_TROP: return "caractères en trop";
+        case DETECTION_TAILLE: return "taille incohérente";
+        case DETECTION_VERSION: return "version inconnue";
+        default: return "inconnu";
+    }
+}
+
+#ifdef BENCH
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include "cJSON.h"
+#include "logger.h"
+#include "utils.h"
+
+#define TAG "udp"
+#define BENCH_DETECTION_ITER 20000
+#define BENCH_POINTS_LIGNE 32       // 2 x 32 = 64 points de marquage
+#define FUZZ_DETECTION 100000
+#define TAILLE_DATAGRAMME 16384
+
+static unsigned long nb_malloc_cjson = 0;
+static void* malloc_compte(size_t n) {
+    nb_malloc_cjson++;
+    return malloc(n);
+}
+
+// Référence : l'ancien parse_json_to_donnees (arbre cJSON), étendu au marquage au sol
+static int lire_point_cjson(const cJSON* o, Point* pt) {
+    if (!cJSON_IsObject(o)) return 0;
+    const cJSON* x = cJSON_GetObjectItem(o, "x");
+    const cJSON* y = cJSON_GetObjectItem(o, "y");
+    const cJSON* z = cJSON_GetObjectItem(o, "z");
+    const cJSON* t = cJSON_GetObjectItem(o, "theta");
+    if (cJSON_IsNumber(x)) pt->x = (int)(x->valuedouble * 1000);
+    if (cJSON_IsNumber(y)) pt->y = (int)(y->valuedouble * 1000);
+    if (cJSON_IsNumber(z)) pt->z = (int)(z->valuedouble * 1000);
+    if (cJSON_IsNumber(t)) pt->theta = (float)(t->valuedouble * 180.0 / 3.14159);
+    return 1;
+}
+
+static int parser_cjson(const char* json, DonneesDetection* data) {
+    memset(data, 0, sizeof(*data));
+    cJSON* root = cJSON_Parse(json);
+    if (!root) return -1;
+
+    cJSON* count = cJSON_GetObjectItem(root, "count");
+    if (cJSON_IsNumber(count)) data->count = count->valueint;
+
+    cJSON* obstacles = cJSON_GetObjectItem(root, "obstacles");
+    int nb = cJSON_IsArray(obstacles) ? cJSON_GetArraySize(obstacles) : 0;
+    if (nb > MAX_OBSTACLES_SIMULTANES) nb = MAX_OBSTACLES_SIMULTANES;
+    for (int i = 0; i < nb; i++) {
+        cJSON* o = cJSON_GetArrayItem(obstacles, i);
+        cJSON* label = cJSON_GetObjectItem(o, "label");
+        cJSON* class_id = cJSON_GetObjectItem(o, "class_id");
+        if (cJSON_IsNumber(class_id))
+            data->obstacle[i].type = (ObstacleType)class_id->valueint;
+        else if (cJSON_IsString(label))
+            data->obstacle[i].type = strcmp(label->valuestring, "PONT") == 0 ? PONT : OBSTACLE_VOITURE;
+        lire_point_cjson(cJSON_GetObjectItem(o, "point_left"), &data->obstacle[i].pointg);
+        lire_point_cjson(cJSON_GetObjectItem(o, "point_right"), &data->obstacle[i].pointd);
+    }
+
+    cJSON* ms = cJSON_GetObjectItem(root, "marquage_sol");
+    const cJSON* p;
+    cJSON_ArrayForEach(p, cJSON_GetObjectItem(ms, "ligne_gauche")) {
+        if (data->marquage_sol.nb_points_gauche < MAX_POINTS_MARQUAGE)
+            lire_point_cjson(p, &data->marquage_sol.ligne_gauche[data->marquage_sol.nb_points_gauche++]);
+    }
+    cJSON_ArrayForEach(p, cJSON_GetObjectItem(ms, "ligne_droite")) {
+        if (data->marquage_sol.nb_points_droite < MAX_POINTS_MARQUAGE)
+            lire_point_cjson(p, &data->marquage_sol.ligne_droite[data->marquage_sol.nb_points_droite++]);
+    }
+    cJSON_Delete(root);
+    return 0;
+}
+
+// Format de json.dumps(separators=(",", ":")) : flottants au format repr()
+static int ecrire_point(char* dst, size_t max, double x, double y, double z, double theta) {
+    return snprintf(dst, max, "{\"x\":%.17g,\"y\":%.17g,\"z\":%.17g,\"theta\":%.17g}", x, y, z, theta);
+}
+
+size_t generer_datagramme_json(char* dst, size_t max, int nb_obstacles) {
+    size_t n = (size_t)snprintf(dst, max, "{\"timestamp\":1761127519.0270708,\"count\":%d,\"obstacles\":[", nb_obstacles);
+    for (int i = 0; i < nb_obstacles; i++) {
+        n += snprintf(dst + n, max - n, "%s{\"label\":\"%s\",\"point_left\":", i ? "," : "", i % 2 ? "voiture" : "PONT");
+        n += ecrire_point(dst + n, max - n, -0.6713615023474178 + 0.1 * i, 1.0, -1.0, -0.03250300171945621);
+        n += snprintf(dst + n, max - n, ",\"point_right\":");
+        n += ecrire_point(dst + n, max - n, 0.5649452269170578 + 0.1 * i, 1.0, -1.0, -0.03250300171945621);
+        n += snprintf(dst + n, max - n, ",\"confidence\":0.3622858226299286,\"class_id\":%d}", i % 2 ? 0 : 8);
+    }
+    n += snprintf(dst + n, max - n, "],\"marquage_sol\":{\"ligne_gauche\":[");
+    for (int cote = 0; cote < 2; cote++) {
+        for (int k = 0; k < BENCH_POINTS_LIGNE; k++) {
+            if (k) n += snprintf(dst + n, max - n, ",");
+            n += ecrire_point(dst + n, max - n, 0.05 * k, cote ? -0.2134567 : 0.2187654, 0.0, 0.0123456789 * k);
+        }
+        n += snprintf(dst + n, max - n, cote ? "]}}" : "],\"ligne_droite\":[");
+    }
+    return n;
+}
+
+static bool memes_points(const Point* a, const Point* b) {
+    return fabsf(a->x - b->x) <= 1.0f && fabsf(a->y - b->y) <= 1.0f &&
+           fabsf(a->z - b->z) <= 1.0f && fabsf(a->theta - b->theta) <= 1e-4f;
+}
+
+static bool memes_donnees(const DonneesDetection* a, const DonneesDetection* b) {
+    if (a->count != b->count ||
+        a->marquage_sol.nb_points_gauche != b->marquage_sol.nb_points_gauche ||
+        a->marquage_sol.nb_points_droite != b->marquage_sol.nb_points_droite)
+        return false;
+    for (int i = 0; i < a->count; i++) {
+        if (a->obstacle[i].type != b->obstacle[i].type ||
+            !memes_points(&a->obstacle[i].pointg, &b->obstacle[i].pointg) ||
+            !memes_points(&a->obstacle[i].pointd, &b->obstacle[i].pointd))
+            return false;
+    }
+    for (int k = 0; k < a->marquage_sol.nb_points_gauche; k++)
+        if (!memes_points(&a->marquage_sol.ligne_gauche[k], &b->marquage_sol.ligne_gauche[k])) return false;
+    for (int k = 0; k < a->marquage_sol.nb_points_droite; k++)
+        if (!memes_points(&a->marquage_sol.ligne_droite[k], &b->marquage_sol.ligne_droite[k])) return false;
+    return true;
+}
+
+void benchmark_parseur_detection(void) {
+    static char datagramme[TAILLE_DATAGRAMME];
+    static char altere[TAILLE_DATAGRAMME];
+    static DonneesDetection a, b;
+    struct timespec t0, t1;
+    cJSON_Hooks compte = { malloc_compte, free };
+
+    for (int nb = 0; nb <= MAX_OBSTACLES_SIMULTANES; nb++) {
+        size_t n = generer_datagramme_json(datagramme, sizeof(datagramme), nb);
+        ResultatDetection r = parser_json_detection(datagramme, n, &a);
+        parser_cjson(datagramme, &b);
+        if (r != DETECTION_OK || !memes_donnees(&a, &b))
+            ERR(TAG, "Parseur détection : écart avec cJSON pour %d obstacles (%s)", nb, resultat_detection_str(r));
+
+        volatile int puits = 0;
+        cJSON_InitHooks(&compte);
+        nb_malloc_cjson = 0;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        for (int i = 0; i < BENCH_DETECTION_ITER; i++) {
+            parser_cjson(datagramme, &b);
+            puits += b.count;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        cJSON_InitHooks(NULL);
+        double dt_cjson = timespec_diff_s(t0, t1);
+
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        for (int i = 0; i < BENCH_DETECTION_ITER; i++) {
+            parser_json_detection(datagramme, n, &a);
+            puits += a.count;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        double dt_parseur = timespec_diff_s(t0, t1);
+
+        INFO(TAG, "Détection %d obstacles + %d points (%zu o) : cJSON %.1f us (%lu malloc), parseur dédié %.1f us (0 malloc), x%.1f",
+             nb, 2 * BENCH_POINTS_LIGNE, n, dt_cjson / BENCH_DETECTION_ITER * 1e6,
+             nb_malloc_cjson / BENCH_DETECTION_ITER, dt_parseur / BENCH_DETECTION_ITER * 1e6, dt_cjson / dt_parseur);
+    }
+
+    // Fuzz : datagrammes tronqués ou altérés, jamais de lecture hors du tampon ni de compteur hors bornes
+    unsigned long resultats[DETECTION_NB_RESULTATS] = {0};
+    unsigned int graine = 12345;
+    static const char alphabet[] = "{}[]\":,.-+eE0123456789 \\untfals\x00\xff";
+    for (int i = 0; i < FUZZ_DETECTION; i++) {
+        size_t n = generer_datagramme_json(altere, sizeof(altere), rand_r(&graine) % (MAX_OBSTACLES_SIMULTANES + 1));
+        for (int k = 1 + rand_r(&graine) % 4; k > 0 && n > 0; k--) {
+            size_t pos = (size_t)rand_r(&graine) % n;
+            switch (rand_r(&graine) % 3) {
+                case 0: n = pos; break;
+                case 1: altere[pos] = alphabet[rand_r(&graine) % (sizeof(alphabet) - 1)]; break;
+                case 2: altere[pos] ^= (char)(1u << (rand_r(&graine) % 8)); break;
+            }
+        }
+        ResultatDetection r = parser_json_detection(altere, n, &a);
+        resultats[r]++;
+        if (r == DETECTION_OK &&
+            (a.count < 0 || a.count > MAX_OBSTACLES_SIMULTANES ||
+             a.marquage_sol.nb_points_gauche > MAX_POINTS_MARQUAGE ||
+             a.marquage_sol.nb_points_droite > MAX_POINTS_MARQUAGE))
+            ERR(TAG, "Fuzz détection : compteur hors bornes accepté");
+    }
+    for (int r = 0; r < DETECTION_NB_RESULTATS; r++)
+        INFO(TAG, "Fuzz (%d datagrammes) : %-20s %lu", FUZZ_DETECTION, resultat_detection_str(r), resultats[r]);
+}
+#endif
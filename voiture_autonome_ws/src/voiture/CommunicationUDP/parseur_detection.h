@@ -0,0 +1,41 @@
+// parseur_detection.h
+#ifndef PARSEUR_DETECTION_H
+#define PARSEUR_DETECTION_H
+
+#include <stddef.h>
+#include "messages.h"
+
+/*  Datagramme JSON envoyé par la détection (IA/FonctionsDetection.py) :
+    {"timestamp":..., "count":1,
+     "obstacles":[{"label":"PONT", "class_id":8, "confidence":0.36,
+                   "point_left":{"x":..,"y":..,"z":..,"theta":..}, "point_right":{...}}],
+     "marquage_sol":{"ligne_gauche":[{point}, ...], "ligne_droite":[{point}, ...]}}
+    Coordonnées en m et rad côté Python, converties en mm et degrés.
+    Les clés inconnues sont ignorées, "marquage_sol" est facultatif.
+*/
+
+typedef enum {
+    DETECTION_OK = 0,
+    DETECTION_VIDE,
+    DETECTION_SYNTAXE,          // JSON mal formé ou tronqué
+    DETECTION_NOMBRE_INVALIDE,  // nombre hors grammaire JSON ou hors bornes
+    DETECTION_TROP_PROFOND,     // imbrication au-delà de ce que le schéma peut contenir
+    DETECTION_EN_TROP,          // caractères après l'objet racine
+    DETECTION_TAILLE,           // datagramme binaire tronqué
+    DETECTION_VERSION,          // datagramme binaire d'une version inconnue
+    DETECTION_NB_RESULTATS
+} ResultatDetection;
+
+// Analyse len octets de json (pas besoin de '\0') directement dans *data,
+// sans aucune allocation. *data n'est exploitable que si le résultat vaut DETECTION_OK.
+ResultatDetection parser_json_detection(const char* json, size_t len, DonneesDetection* data);
+const char* resultat_detection_str(ResultatDetection r);
+
+#ifdef BENCH
+// Temps par datagramme face à cJSON (0 à 5 obstacles, 64 points de marquage) et fuzz
+void benchmark_parseur_detection(void);
+// Datagramme JSON au format de la caméra (nb_obstacles + 64 points de marquage)
+size_t generer_datagramme_json(char* dst, size_t max, int nb_obstacles);
+#endif
+
+#endif
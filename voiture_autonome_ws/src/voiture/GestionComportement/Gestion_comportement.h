@@ -1,3 +1,10 @@
 
 void* lancer_comportement(void* arg);
-void stop_comportement();
\ No newline at end of file
+void stop_comportement();
+
+#ifdef BENCH
+// Coût d'un cycle de génération incrémentale face à une régénération complète
+void benchmark_generation_trajectoire(void);
+// Points d'arrêt des obstacles : boucle d'origine face à la projection sur l'itinéraire
+void benchmark_projection_obstacles(void);
+#endif
@@ -12,7 +12,12 @@
 #include"config.h"
 #include"logger.h"
 #include"voiture_evitement.h"
+#include"reservation_structure.h"
+#include"annotation_itineraire.h"
+#include"planificateur_treillis.h"
+#include"arbitrage_trajectoire.h"
 #include"voiture_globals.h"
+#include"Gestion_comportement.h"
 
 #define Z_seuil 0.1718
 
@@ -33,96 +38,219 @@ static inline float compute_vitesse_convergence(const PositionVoiture* pos) {
     return v;
 }
 
-Point p_moyen_obj(const DonneesDetection* det, int j){
-    Point p_moyen;
-    p_moyen.x = (det->obstacle[j].pointd.x + det->obstacle[j].pointg.x) / 2.0f;
-    p_moyen.y = (det->obstacle[j].pointd.y + det->obstacle[j].pointg.y) / 2.0f;
-    p_moyen.z = (det->obstacle[j].pointd.z + det->obstacle[j].pointg.z) / 2.0f;
-    return p_moyen;
+/*  Génération incrémentale de la fenêtre de trajectoire.
+    L'état est conservé d'un cycle à l'autre : l'itinéraire (et son annotation)
+    n'est recopié que lorsqu'il change, dans un chemin partagé sur lequel pointent
+    les trajectoires publiées ; le point le plus proche est cherché autour du précédent,
+    chaque obstacle d'une nouvelle image est projeté une fois sur l'itinéraire
+    (abscisse curviligne, écart latéral) et la fenêtre n'est qu'un intervalle
+    d'indices [debut, debut + nb) couvrant l'horizon, sans copie de points.
+*/
+typedef struct {
+    bool valide;
+    struct timespec maj_itineraire;   // last_update de l'itinéraire recopié
+    struct timespec maj_detection;    // last_update de l'image de détection utilisée
+    Itineraire iti;
+    AnnotationItineraire annotation;
+    DetectionMonde det;
+    int idx;                          // point de l'itinéraire le plus proche de la voiture
+    int point_arret[MAX_OBSTACLES_SIMULTANES];  // -1 : obstacle hors de l'itinéraire ou derrière
+    int debut;                        // indice dans l'itinéraire du premier point de la fenêtre
+    int chemin;                       // chemin partagé qui porte la copie de iti.points
+    const Point* points;              // ses points
+    unsigned int sequence;            // séquence des propositions (une par itinéraire)
+    float s_sortie_reservee;          // sortie de l'intervalle de la structure demandée, < 0 à recaler
+} EtatGeneration;
+
+static EtatGeneration etat = { .chemin = -1, .s_sortie_reservee = -1.0f };
+
+static inline bool meme_instant(struct timespec a, struct timespec b) {
+    return a.tv_sec == b.tv_sec && a.tv_nsec == b.tv_nsec;
+}
+
+static int recherche_complete(const Itineraire* iti, const PositionVoiture* pos) {
+    int best = 0;
+    long long best_d2 = dist2_point_pos(&iti->points[0], pos);
+    for (int i = 1; i < iti->nb_points; ++i) {
+        long long d2 = dist2_point_pos(&iti->points[i], pos);
+        if (d2 < best_d2) {
+            best_d2 = d2;
+            best = i;
+        }
+    }
+    return best;
+}
+
+// Recherche du point le plus proche autour du précédent, recherche complète si la
+// voiture s'est trop écartée (recalage de la localisation, demi-tour...)
+static int avancer_indice(const Itineraire* iti, int idx, const PositionVoiture* pos) {
+    const long long recalage2 = (long long)GENERATION_RECALAGE_MM * GENERATION_RECALAGE_MM;
+    int best = idx > 0 ? idx - 1 : 0;
+    int fin = idx + GENERATION_RECHERCHE_POINTS;
+    if (fin > iti->nb_points) fin = iti->nb_points;
+    long long best_d2 = dist2_point_pos(&iti->points[best], pos);
+    for (int i = best + 1; i < fin; ++i) {
+        long long d2 = dist2_point_pos(&iti->points[i], pos);
+        if (d2 < best_d2) {
+            best_d2 = d2;
+            best = i;
+        }
+    }
+    return best_d2 > recalage2 ? recherche_complete(iti, pos) : best;
+}
+
+// Point d'arrêt de chaque obstacle : projection de son centre sur l'itinéraire
+// devant la voiture (jusqu'à PROJECTION_HORIZON_MM), puis dernier point situé
+// DISTANCE_ARRET_MM avant lui. Les obstacles trop loin du chemin ou derrière
+// la voiture sont ignorés ; un obstacle plus proche que la distance d'arrêt
+// arrête au début de la fenêtre.
+static void placer_obstacles(const Itineraire* iti, const AnnotationItineraire* a,
+                             const DetectionMonde* det, int debut, int idx, int* point_arret) {
+    int fin = point_a_abscisse(a, iti->nb_points, a->abscisse[idx] + PROJECTION_HORIZON_MM) + 1;
+    for (int j = 0; j < det->count; j++) {
+        ProjectionItineraire p;
+        point_arret[j] = -1;
+        if (!projeter_sur_itineraire(iti, a, debut, fin, det->centre[j].x, det->centre[j].y, &p)) continue;
+        if (fabsf(p.lateral) > PROJECTION_LATERALE_MAX_MM || p.s < a->abscisse[idx]) continue;
+        int k = point_a_abscisse(a, iti->nb_points, p.s - DISTANCE_ARRET_MM);
+        point_arret[j] = k > debut ? k : debut;
+    }
+}
+
+// Longueur de la fenêtre publiée : TRAJECTOIRE_HORIZON_S de roulage, bornée
+static float horizon_trajectoire(float vitesse) {
+    float h = vitesse * (float)TRAJECTOIRE_HORIZON_S;
+    if (h < TRAJECTOIRE_HORIZON_MIN_MM) h = TRAJECTOIRE_HORIZON_MIN_MM;
+    if (h > TRAJECTOIRE_HORIZON_MAX_MM) h = TRAJECTOIRE_HORIZON_MAX_MM;
+    return h;
+}
+
+// Copie de l'itinéraire dans un chemin partagé, une fois par itinéraire
+static int partager_itineraire(const Itineraire* iti) {
+    Point* points;
+    int id = reserver_chemin(&points);
+    if (id < 0) return -1;
+    memcpy(points, iti->points, (size_t)iti->nb_points * sizeof(Point));
+    rendre_chemin(etat.chemin);
+    etat.chemin = id;
+    etat.points = points;
+    etat.sequence++;
+    return 0;
 }
 
 int generate_trajectoire() {
     PositionVoiture pos;
-    Itineraire iti;
-    DonneesDetection Obj_detecte;
-    Consigne cons;
-    Demande d;
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    reservation_mettre_a_jour(now);
 
     if (get_position(&pos) != 0) {
         DBG(TAG, "Failure dans l'obtention de le position");
         return -1;
     }
 
-    if (get_itineraire(&iti) != 0) {
-        DBG(TAG, "Failure dans l'obtention de l'itineraire");
-        return -1;
+    // Nouvel itinéraire : on repart de zéro
+    struct timespec maj_iti = get_itineraire_last_update();
+    if (!etat.valide || !meme_instant(maj_iti, etat.maj_itineraire)) {
+        if (get_itineraire_annote(&etat.iti, &etat.annotation) != 0) {
+            DBG(TAG, "Failure dans l'obtention de l'itineraire");
+            return -1;
+        }
+        if (etat.iti.nb_points <= 0) {
+            DBG(TAG, "L'itineraire est vide");
+            etat.valide = false;
+            return -1;
+        }
+        // Itinéraire publié sans annotation (set_itineraire) : on l'annote ici
+        if (etat.iti.nb_points > 1 && etat.annotation.abscisse[etat.iti.nb_points - 1] <= 0.0f)
+            annoter_itineraire(&etat.iti, &etat.annotation);
+        if (partager_itineraire(&etat.iti) != 0) {
+            etat.valide = false;
+            return -1;
+        }
+        etat.maj_itineraire = maj_iti;
+        reservation_nouvel_itineraire();
+        etat.s_sortie_reservee = -1.0f;   // abscisses de l'ancien itinéraire
+        etat.idx = recherche_complete(&etat.iti, &pos);
+        etat.maj_detection = TIMESPEC_UNDEFINED;
+        etat.det.count = 0;
+        etat.valide = true;
+    } else {
+        etat.idx = avancer_indice(&etat.iti, etat.idx, &pos);
     }
 
-    if (iti.nb_points <= 0) {
-        DBG(TAG, "L'itineraire est vide");
-        return -1;
+    // Nouvelle image de détection : ses obstacles sont projetés à nouveau
+    struct timespec maj_det = get_donnees_detection_last_update();
+    bool nouvelle_image = !meme_instant(maj_det, etat.maj_detection);
+    if (nouvelle_image) {
+        if (get_detection_monde(&etat.det) != 0) {
+            DBG(TAG, "Failure dans l'obtention des donnes de detection");
+            return -1;
+        }
+        etat.maj_detection = maj_det;
     }
 
-    if(get_donnees_detection(&Obj_detecte) != 0){
-        DBG(TAG, "Failure dans l'obtention des donnes de detection"); 
-        return -1;
-    }
-    
-    int best_idx = 0;
-    long long best_d2 = dist2_point_pos(&iti.points[0], &pos);
-    float v_current = compute_vitesse_convergence(&pos);
-    int point_arret[MAX_OBSTACLES_SIMULTANES];
-    for(int i = 0;i< MAX_OBSTACLES_SIMULTANES; i++){
-        point_arret[i]=iti.nb_points;
-    }
-    int check_obstacle[MAX_OBSTACLES_SIMULTANES] = {0}; 
-    for (int i = 1; i < iti.nb_points; ++i) {
-        long long d2 = dist2_point_pos(&iti.points[i], &pos);
-        if (d2 < best_d2) {
-            best_d2 = d2;
-            best_idx = i;
-        }if(Obj_detecte.count !=0){
-            for(int j = 0; j<Obj_detecte.count; j++){
-                Point p = p_moyen_obj(&Obj_detecte, j);
-                long long dist_obs2 = dist2_point_pos(&p, &pos);
-                if(d2 > dist_obs2 && check_obstacle[j] == 0){
-                    point_arret[j] = i - 1;
-                    check_obstacle[j] = 1;
-                }
-            }  
+    const Itineraire* iti = &etat.iti;
+    int best_idx = etat.idx;
+    etat.debut = best_idx > 0 ? best_idx - 1 : 0;
+    if (nouvelle_image)
+        placer_obstacles(iti, &etat.annotation, &etat.det, etat.debut, best_idx, etat.point_arret);
+
+    // Structures de l'itinéraire : demande à l'approche, arrêt avant l'entrée
+    // tant qu'elle n'est pas accordée, libération une fois sortie
+    const AnnotationItineraire* annot = &etat.annotation;
+    float s_voiture = annot->abscisse[best_idx];
+    const IntervalleItineraire* structure =
+        intervalle_suivant(annot->structure, annot->nb_structures, s_voiture);
+    // La libération suit l'intervalle et non l'identifiant : une structure
+    // traversée deux fois est libérée entre les deux passages. Le pont vu par la
+    // caméra (cas PONT ci-dessous) fixe lui aussi s_sortie_reservee ; un nouvel
+    // itinéraire libère tout ce qui n'est pas la prochaine structure annotée
+    int reservee = reservation_structure_id();
+    if (reservee >= 0 && etat.s_sortie_reservee < 0.0f && structure && structure->id == reservee)
+        etat.s_sortie_reservee = structure->s_sortie;   // nouvel itinéraire : même structure devant
+    if (reservee >= 0 && s_voiture > etat.s_sortie_reservee)
+        reservation_liberer();
+    int arret_structure = -1;
+    if (structure) {
+        // Demander une autre structure libère la précédente : pas tant que la
+        // voiture n'est pas sortie de celle qu'elle tient (structures rapprochées)
+        int tenue = reservation_structure_id();
+        bool autre_tenue = tenue >= 0 && tenue != structure->id && s_voiture <= etat.s_sortie_reservee;
+        if (!autre_tenue && structure->s_entree - s_voiture <= RESERVATION_ANTICIPATION_MM) {
+            reservation_demander(structure->id);
+            etat.s_sortie_reservee = structure->s_sortie;
         }
+        bool accordee = reservation_etat() == RESA_ACCORDEE && reservation_structure_id() == structure->id;
+        if (!accordee && best_idx < structure->entree)
+            arret_structure = structure->entree;
     }
 
+    // Fenêtre : du point précédant la voiture jusqu'à l'horizon
+    float vitesse = compute_vitesse_convergence(&pos);
+    int fin = point_a_abscisse(annot, iti->nb_points, annot->abscisse[etat.debut] + horizon_trajectoire(vitesse)) + 1;
+    if (fin > iti->nb_points) fin = iti->nb_points;
+
     Trajectoire traj;
     memset(&traj, 0, sizeof(traj));
+    traj.chemin = etat.chemin;
+    traj.points = etat.points + etat.debut;
     traj.nb_points = 0;
-    traj.vitesse = v_current;
+    traj.vitesse = vitesse;
     traj.arreter_fin = 0;
 
-    int DIST_INSERT_POSITION = 50 * 50; 
-    int write_idx = 0;
-
-    if (best_d2 > DIST_INSERT_POSITION) {
-        Point pcur;
-        pcur.x = pos.x;
-        pcur.y = pos.y;
-        pcur.z = pos.z;
-        pcur.theta = pos.theta;
-        traj.points[write_idx++] = pcur;
+    bool fin_fenetre = false;
+    for (int i = etat.debut; i < fin && !fin_fenetre; i++) {
+        if (arret_structure >= 0 && i >= arret_structure) {
+            traj.arreter_fin = 1;
+            break;
+        }
         traj.nb_points++;
-    }
-
-    int start = best_idx - 1;
-    if(best_idx == 0){
-        start = 0;
-    }
-    for (int i = start; i < iti.nb_points && traj.nb_points < MAX_POINTS_TRAJECTOIRE; i++) {
-        traj.points[traj.nb_points++] = iti.points[i];
-        for(int j=0; j<Obj_detecte.count; j++){
-            if(i == point_arret[j]){
-                Point p_obj = p_moyen_obj(&Obj_detecte, j);
-                float z_here = p_obj.z;
-                switch (Obj_detecte.obstacle[j].type){
+        for(int j=0; j<etat.det.count; j++){
+            if(i == etat.point_arret[j]){
+                float z_here = etat.det.centre[j].z;
+                switch (etat.det.obstacle[j].type){
                     case OBSTACLE_VOITURE:
                         voiture_evitement_main();
                         return 0;
@@ -134,20 +262,18 @@ int generate_trajectoire() {
                         break;
                     case PANNEAU_BARRIERE:
                         if(z_here < Z_seuil) break;
-                        i = MAX_POINTS_TRAJECTOIRE;
+                        fin_fenetre = true;
                         traj.arreter_fin = 1;
                         break;
                     case PANNEAU_CEDER_PASSAGE:
                         if(z_here < Z_seuil) break;
-                        DonneesDetection Obj2;
-                        usleep(50000);
-                        if(get_donnees_detection(&Obj2) != 0){
-                            DBG(TAG, "Failure dans l'obtention des donnes de detection"); 
-                            return -1;
-                        }
-                        if(Obj2.obstacle->type == OBSTACLE_VOITURE){
-                            i = MAX_POINTS_TRAJECTOIRE;
-                            traj.arreter_fin = 1;
+                        // Arrêt tant qu'une voiture est dans l'image ; l'image suivante
+                        // sera relue au prochain cycle
+                        for(int v = 0; v < etat.det.count; v++){
+                            if(etat.det.obstacle[v].type == OBSTACLE_VOITURE){
+                                fin_fenetre = true;
+                                traj.arreter_fin = 1;
+                            }
                         }
                         break;
                     case PANNEAU_FIN_30:
@@ -155,20 +281,16 @@ int generate_trajectoire() {
                         traj.vitesse_max = (float)MAX_VITESSE;
                         break;
                     case PONT:
-                        do{
-                            i = MAX_POINTS_TRAJECTOIRE;
+                        // Pont vu par la caméra sur un itinéraire sans structure annotée :
+                        // arrêt tant que le contrôleur ne l'a pas accordé ; sa sortie,
+                        // estimée à PONT_LONGUEUR_MM de l'entrée, est repoussée à chaque image
+                        if(annot->nb_structures > 0) break;
+                        reservation_demander(PONT_STRUCTURE_ID);
+                        etat.s_sortie_reservee = annot->abscisse[i] + DISTANCE_ARRET_MM + PONT_LONGUEUR_MM;
+                        if(reservation_etat() != RESA_ACCORDEE){
+                            fin_fenetre = true;
                             traj.arreter_fin = 1;
-                            d.type = RESERVATION_STRUCTURE;
-                            set_demande(&d);
-                            usleep(100000);
-                            if(get_consigne(&cons) != 0){
-                                DBG(TAG, "Failure dans l'obtention de la consigne"); 
-                                return -1;
-                            }
-                            if(pos.vx != 0 || pos.vy != 0){
-                                break;
-                            }
-                        }while(cons.autorisation == CONSIGNE_ATTENTE);
+                        }
                         break;
                     default:
 
@@ -176,21 +298,17 @@ int generate_trajectoire() {
                 }
             }
         }
-        if(i!=0 && iti.points[i-1].pont == 1 && iti.points[i].pont == 0){
-            d.type = LIBERATION_STRUCTURE;
-        }
     }
     
  
     if (traj.nb_points == 0) {
-        traj.points[0] = iti.points[best_idx];
+        traj.points = etat.points + best_idx;
         traj.nb_points = 1;
     }
+    traj.horizon = annot->abscisse[etat.debut + traj.nb_points - 1] - annot->abscisse[etat.debut];
 
-    if (set_trajectoire(&traj) != 0) {
-        DBG(TAG, "Failure dans definition de la trajectoire");
-        return -1;
-    }
+    soumettre_trajectoire(PRODUCTEUR_COMPORTEMENT, &traj, PRIORITE_NOMINALE,
+                          ARBITRAGE_VALIDITE_COMPORTEMENT_S, etat.sequence);
 
     DBG(TAG, "Trajectoire gerée avec %d points (best_idx=%d)", traj.nb_points, best_idx);
     return 0;
@@ -202,7 +320,8 @@ static volatile bool continuer_execution = true;
 void* lancer_comportement(void* arg) {
 
     printf("[%s] Démarrage du système de génération de trajectoire...\n", TAG);
-    
+    init_planificateur_treillis(TREILLIS_NB_THREADS);
+
     while (continuer_execution) {
         Itineraire iti;
         int ret = get_itineraire(&iti);
@@ -213,20 +332,184 @@ void* lancer_comportement(void* arg) {
             continue;
         }
 
+        struct timespec debut, fin;
+        clock_gettime(CLOCK_MONOTONIC, &debut);
         int gen_ret = generate_trajectoire();
         if (gen_ret != 0) {
             printf("[%s] Erreur lors de la génération de la trajectoire (code=%d)\n", TAG, gen_ret);
         } else {
             //printf("[%s] Trajectoire générée avec succès.\n", TAG);
         }
-        // Attente avant la prochaine mise à jour (ici : 100 ms)
-        usleep(100000);
+        // Une seule trajectoire publiée par cycle, parmi les propositions des producteurs
+        struct timespec maintenant;
+        clock_gettime(CLOCK_MONOTONIC, &maintenant);
+        arbitrer_trajectoires(maintenant);
+        // Attente jusqu'au cycle suivant (la génération ne dort jamais)
+        clock_gettime(CLOCK_MONOTONIC, &fin);
+        double reste = COMPORTEMENT_PERIODE_S - timespec_diff_s(debut, fin);
+        if (reste > 0.0) my_sleep(reste);
     }
 
+    stop_planificateur_treillis();
     printf("[%s] Fin du programme.\n", TAG);
     return 0;
 }
 
 void stop_comportement() {
     continuer_execution = false;
-}
\ No newline at end of file
+}
+
+#ifdef BENCH
+#define BENCH_GEN_POINTS 1000
+#define BENCH_PROJ_REPETITIONS 2000
+
+// Association d'origine, pour comparaison : premier point de l'itinéraire plus
+// loin de la voiture que l'obstacle, O(points x obstacles) à chaque cycle
+static void point_arret_boucle_distances(const Itineraire* iti, const DetectionMonde* det,
+                                         const PositionVoiture* pos, int* point_arret) {
+    int check_obstacle[MAX_OBSTACLES_SIMULTANES] = {0};
+    for (int j = 0; j < MAX_OBSTACLES_SIMULTANES; j++) point_arret[j] = iti->nb_points;
+    for (int i = 1; i < iti->nb_points; ++i) {
+        long long d2 = dist2_point_pos(&iti->points[i], pos);
+        for (int j = 0; j < det->count; j++) {
+            long long dist_obs2 = dist2_point_pos(&det->centre[j], pos);
+            if (d2 > dist_obs2 && check_obstacle[j] == 0) {
+                point_arret[j] = i - 1;
+                check_obstacle[j] = 1;
+            }
+        }
+    }
+}
+
+// Itinéraire de 1000 points en cercle (rayon 1,5 m), 5 obstacles devant la
+// voiture à ±150 mm du chemin : coût et erreur du point d'arrêt le long du
+// chemin pour la boucle d'origine et pour la projection
+void benchmark_projection_obstacles(void) {
+    static Itineraire iti;
+    static AnnotationItineraire a;
+    static DetectionMonde det;
+    const float rayon = 1500.0f, pas = 20.0f;
+    const int idx = 200;
+    const float devant[5] = { 300.0f, 700.0f, 1100.0f, 1600.0f, 2200.0f };
+    float s_obstacle[5];
+
+    iti.nb_points = BENCH_GEN_POINTS;
+    for (int i = 0; i < iti.nb_points; i++) {
+        float th = i * pas / rayon;
+        memset(&iti.points[i], 0, sizeof(Point));
+        iti.points[i].x = rayon * sinf(th);
+        iti.points[i].y = rayon * (1.0f - cosf(th));
+    }
+    annoter_itineraire(&iti, &a);
+    PositionVoiture pos = { iti.points[idx].x, iti.points[idx].y, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+    det.count = 5;
+    for (int j = 0; j < det.count; j++) {
+        float lat = (j % 2) ? 150.0f : -150.0f;
+        s_obstacle[j] = a.abscisse[idx] + devant[j];
+        float th = s_obstacle[j] / rayon;
+        memset(&det.centre[j], 0, sizeof(Point));
+        det.centre[j].x = (rayon - lat) * sinf(th);
+        det.centre[j].y = rayon - (rayon - lat) * cosf(th);
+    }
+
+    int arret_boucle[MAX_OBSTACLES_SIMULTANES], arret_proj[MAX_OBSTACLES_SIMULTANES];
+    struct timespec t0, t1, t2;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int r = 0; r < BENCH_PROJ_REPETITIONS; r++)
+        point_arret_boucle_distances(&iti, &det, &pos, arret_boucle);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    for (int r = 0; r < BENCH_PROJ_REPETITIONS; r++)
+        placer_obstacles(&iti, &a, &det, idx - 1, idx, arret_proj);
+    clock_gettime(CLOCK_MONOTONIC, &t2);
+
+    // Erreur : écart entre le point d'arrêt et sa cible le long du chemin
+    // (juste avant l'obstacle pour la boucle, DISTANCE_ARRET_MM avant pour la projection)
+    float err_boucle = 0.0f, err_proj = 0.0f;
+    for (int j = 0; j < det.count; j++) {
+        float s_b = arret_boucle[j] < iti.nb_points ? a.abscisse[arret_boucle[j]] : a.abscisse[iti.nb_points - 1];
+        float s_p = arret_proj[j] >= 0 ? a.abscisse[arret_proj[j]] : 0.0f;
+        float e_b = fabsf(s_b - s_obstacle[j]), e_p = fabsf(s_p - (s_obstacle[j] - DISTANCE_ARRET_MM));
+        if (e_b > err_boucle) err_boucle = e_b;
+        if (e_p > err_proj) err_proj = e_p;
+    }
+    INFO(TAG, "Points d'arrêt (%d points, %d obstacles, virage R=%.0f mm) : boucle %.2f us, erreur max %.0f mm ; "
+              "projection %.2f us, erreur max %.0f mm",
+         iti.nb_points, det.count, rayon,
+         timespec_diff_s(t0, t1) / BENCH_PROJ_REPETITIONS * 1e6, err_boucle,
+         timespec_diff_s(t1, t2) / BENCH_PROJ_REPETITIONS * 1e6, err_proj);
+}
+
+#define BENCH_GEN_CYCLES 2000
+
+// Voiture qui parcourt un itinéraire de 1000 points (pas de 20 mm) avec trois
+// panneaux sur le bord, à vitesse croissante : coût d'un cycle incrémental face
+// à une régénération complète (ancien comportement), horizon et stabilité de la
+// fenêtre publiée
+void benchmark_generation_trajectoire(void) {
+    static Itineraire iti;
+    static DonneesDetection det;
+    static DetectionMonde monde;
+    iti.nb_points = BENCH_GEN_POINTS;
+    for (int i = 0; i < BENCH_GEN_POINTS; i++) {
+        memset(&iti.points[i], 0, sizeof(Point));
+        iti.points[i].x = 20.0f * i;
+        iti.points[i].y = 5.0f * sinf(i * 0.05f);
+    }
+    memset(&monde, 0, sizeof(monde));
+    monde.count = 3;
+    for (int j = 0; j < monde.count; j++) {
+        monde.obstacle[j].type = PANNEAU_FIN_30;
+        monde.centre[j].x = 4000.0f + 5000.0f * j;
+        monde.centre[j].y = 150.0f;
+        monde.centre[j].z = 1.0f;
+    }
+    set_itineraire(&iti);
+
+    for (int mode = 0; mode < 2; mode++) {
+        struct timespec t0, t1, arrivee;
+        double t_total = 0.0;
+        int instables = 0, panneaux = 0;
+        double horizon = 0.0;
+        Trajectoire prec, traj;
+        memset(&prec, 0, sizeof(prec));
+        prec.chemin = -1;
+        etat.valide = false;
+        for (int k = 0; k < BENCH_GEN_CYCLES; k++) {
+            // Vitesse de 0 à MAX_VITESSE : l'horizon suit
+            float v = (float)MAX_VITESSE * (k % 200) / 200.0f;
+            PositionVoiture pos = { 9.0f * k, 20.0f, 0.0f, 0.0f, v, 0.0f, 0.0f };
+            set_position(&pos);
+            if (k % 3 == 0) {   // une image de détection tous les trois cycles
+                clock_gettime(CLOCK_MONOTONIC, &arrivee);
+                set_donnees_detection_horodatees(&det, &monde, arrivee);
+            }
+            if (mode == 1) etat.valide = false;
+            clock_gettime(CLOCK_MONOTONIC, &t0);
+            generate_trajectoire();
+            clock_gettime(CLOCK_MONOTONIC, &t1);
+            t_total += timespec_diff_s(t0, t1);
+            arbitrer_trajectoires(t1);
+
+            // Un point déjà publié doit garder sa valeur tant qu'il reste dans la fenêtre
+            get_trajectoire(&traj);
+            horizon += traj.horizon;
+            if (traj.vitesse_max > 0.0f) panneaux++;
+            for (int a = 0; a < prec.nb_points; a++)
+                for (int b = 0; b < traj.nb_points; b++)
+                    if (prec.points[a].x == traj.points[b].x && prec.points[a].y != traj.points[b].y)
+                        instables++;
+            rendre_trajectoire(&prec);
+            prec = traj;
+        }
+        rendre_trajectoire(&prec);
+        INFO(TAG, "Génération de trajectoire %s (%d points, %d cycles) : %.2f us par cycle, horizon moyen %.0f mm, "
+                  "%d points modifiés, panneau appliqué sur %d cycles",
+             mode == 0 ? "incrémentale" : "complète  ", BENCH_GEN_POINTS, BENCH_GEN_CYCLES,
+             t_total / BENCH_GEN_CYCLES * 1e6, horizon / BENCH_GEN_CYCLES, instables, panneaux);
+    }
+    etat.valide = false;
+    retirer_trajectoire(PRODUCTEUR_COMPORTEMENT);
+    rendre_chemin(etat.chemin);
+    etat.chemin = -1;
+}
+#endif
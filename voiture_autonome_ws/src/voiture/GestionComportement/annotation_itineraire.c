@@ -0,0 +1,117 @@
+#include <math.h>
+#include "annotation_itineraire.h"
+#include "config.h"
+#include "logger.h"
+#include "voiture_globals.h"
+
+#define TAG "annotation_itineraire"
+
+// Ajoute le point i à l'intervalle ouvert de la liste, ou en ouvre un nouveau.
+// ouvert vaut false après un point hors intervalle ou un changement d'identifiant.
+static void etendre(IntervalleItineraire* tab, int* n, bool* ouvert, int id, int i, float s, int* ignores) {
+    if (*ouvert && tab[*n - 1].id == id) {
+        tab[*n - 1].sortie = i;
+        tab[*n - 1].s_sortie = s;
+        return;
+    }
+    if (*n >= MAX_INTERVALLES_ITI) {
+        (*ignores)++;
+        *ouvert = false;
+        return;
+    }
+    tab[*n] = (IntervalleItineraire){ id, i, i, s, s };
+    (*n)++;
+    *ouvert = true;
+}
+
+void annoter_itineraire(const Itineraire* iti, AnnotationItineraire* a) {
+    bool structure_ouverte = false, depassement_ouvert = false;
+    int ignores = 0;
+    int n = iti->nb_points < MAX_ITI ? iti->nb_points : MAX_ITI;
+    float s = 0.0f;
+
+    a->nb_structures = 0;
+    a->nb_depassements = 0;
+    for (int i = 0; i < n; i++) {
+        const Point* p = &iti->points[i];
+        if (i > 0) s += hypotf(p->x - iti->points[i - 1].x, p->y - iti->points[i - 1].y);
+        a->abscisse[i] = s;
+
+        if (p->pont > 0)
+            etendre(a->structure, &a->nb_structures, &structure_ouverte, p->pont - 1, i, s, &ignores);
+        else
+            structure_ouverte = false;
+
+        if (p->depacement)
+            etendre(a->depassement, &a->nb_depassements, &depassement_ouvert, -1, i, s, &ignores);
+        else
+            depassement_ouvert = false;
+    }
+    if (ignores > 0)
+        WARN(TAG, "Plus de %d intervalles : %d points non annotés", MAX_INTERVALLES_ITI, ignores);
+    DBG(TAG, "Itinéraire de %d points (%.0f mm) : %d structures, %d zones de dépassement",
+        n, s, a->nb_structures, a->nb_depassements);
+}
+
+int publier_itineraire(const Itineraire* iti) {
+    static AnnotationItineraire a;   // thread de réception uniquement
+    annoter_itineraire(iti, &a);
+    return set_itineraire_annote(iti, &a);
+}
+
+bool projeter_sur_itineraire(const Itineraire* iti, const AnnotationItineraire* a, int debut, int fin,
+                             float x, float y, ProjectionItineraire* p) {
+    if (debut < 0) debut = 0;
+    if (fin > iti->nb_points - 1) fin = iti->nb_points - 1;
+    float meilleure_d2 = -1.0f;
+    for (int k = debut; k < fin; k++) {
+        const Point* u = &iti->points[k];
+        const Point* v = &iti->points[k + 1];
+        float sx = v->x - u->x, sy = v->y - u->y;
+        float l2 = sx * sx + sy * sy;
+        if (l2 <= 0.0f) continue;
+        float ex = x - u->x, ey = y - u->y;
+        float t = (ex * sx + ey * sy) / l2;
+        if (t < 0.0f) t = 0.0f;
+        if (t > 1.0f) t = 1.0f;
+        float dx = ex - t * sx, dy = ey - t * sy;
+        float d2 = dx * dx + dy * dy;
+        if (meilleure_d2 >= 0.0f && d2 >= meilleure_d2) continue;
+        meilleure_d2 = d2;
+        p->segment = k;
+        p->s = a->abscisse[k] + t * (a->abscisse[k + 1] - a->abscisse[k]);
+        p->lateral = (sx * ey - sy * ex) >= 0.0f ? sqrtf(d2) : -sqrtf(d2);
+    }
+    return meilleure_d2 >= 0.0f;
+}
+
+int point_a_abscisse(const AnnotationItineraire* a, int nb_points, float s) {
+    int bas = 0, haut = nb_points;   // premier point d'abscisse > s
+    while (bas < haut) {
+        int milieu = (bas + haut) / 2;
+        if (a->abscisse[milieu] <= s) bas = milieu + 1;
+        else haut = milieu;
+    }
+    return bas > 0 ? bas - 1 : 0;
+}
+
+// Indice du premier intervalle dont la sortie est à l'abscisse s ou au-delà
+static int premier_non_depasse(const IntervalleItineraire* tab, int n, float s) {
+    int bas = 0, haut = n;
+    while (bas < haut) {
+        int milieu = (bas + haut) / 2;
+        if (tab[milieu].s_sortie < s) bas = milieu + 1;
+        else haut = milieu;
+    }
+    return bas;
+}
+
+const IntervalleItineraire* intervalle_suivant(const IntervalleItineraire* tab, int n, float s) {
+    int k = premier_non_depasse(tab, n, s);
+    return k < n ? &tab[k] : NULL;
+}
+
+const IntervalleItineraire* intervalle_contenant(const IntervalleItineraire* tab, int n, float s) {
+    const IntervalleItineraire* it = intervalle_suivant(tab, n, s);
+    return it && it->s_entree <= s ? it : NULL;
+}
@@ -0,0 +1,47 @@
+#ifndef ANNOTATION_ITINERAIRE_H
+#define ANNOTATION_ITINERAIRE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "messages.h"
+
+/*  Annotation d'un itinéraire à sa réception : un seul parcours des points pour
+    calculer les abscisses curvilignes et regrouper en intervalles les points
+    consécutifs de même structure (Point.pont) et de dépassement autorisé
+    (Point.depacement). La gestion de comportement n'a plus qu'à chercher
+    l'intervalle voulu par dichotomie sur l'abscisse de la voiture.
+    Au-delà de MAX_INTERVALLES_ITI intervalles d'un genre, les suivants sont
+    ignorés (avertissement).
+*/
+
+void annoter_itineraire(const Itineraire* iti, AnnotationItineraire* a);
+
+// Annotation puis set_itineraire_annote ; appelée par la réception de l'itinéraire
+int publier_itineraire(const Itineraire* iti);
+
+// Intervalle contenant l'abscisse s, NULL sinon
+const IntervalleItineraire* intervalle_contenant(const IntervalleItineraire* tab, int n, float s);
+
+// Premier intervalle qui n'est pas encore entièrement derrière l'abscisse s
+// (celui qui la contient ou le suivant), NULL sinon
+const IntervalleItineraire* intervalle_suivant(const IntervalleItineraire* tab, int n, float s);
+
+// Projection orthogonale d'un point sur le segment le plus proche de
+// l'itinéraire parmi les segments [debut, fin[ (segment k : points k -> k+1)
+typedef struct {
+    int segment;
+    float s;          // abscisse curviligne du projeté
+    float lateral;    // écart signé au chemin, positif à gauche du sens de parcours
+} ProjectionItineraire;
+
+bool projeter_sur_itineraire(const Itineraire* iti, const AnnotationItineraire* a, int debut, int fin,
+                             float x, float y, ProjectionItineraire* p);
+
+// Dernier point d'abscisse inférieure ou égale à s (0 si s précède l'itinéraire)
+int point_a_abscisse(const AnnotationItineraire* a, int nb_points, float s);
+
+static inline bool depassement_autorise(const AnnotationItineraire* a, float s) {
+    return intervalle_contenant(a->depassement, a->nb_depassements, s) != NULL;
+}
+
+#endif
@@ -0,0 +1,90 @@
+#include <stdbool.h>
+#include "arbitrage_trajectoire.h"
+#include "config.h"
+#include "logger.h"
+#include "utils.h"
+#include "voiture_globals.h"
+
+#define TAG "arbitrage"
+
+typedef struct {
+    bool active;
+    Trajectoire traj;
+    PrioriteTrajectoire priorite;
+    unsigned int sequence;             // séquence du producteur
+    struct timespec soumission;
+    struct timespec expiration;
+} Proposition;
+
+// Etat propre au thread de comportement : pas de verrou
+static struct {
+    Proposition prop[NB_PRODUCTEURS];
+    int gagnant;                       // producteur publié au dernier cycle, -1 sinon
+    unsigned int sequence_gagnant;     // sa séquence
+    unsigned int sequence_publiee;     // Trajectoire.sequence
+} arb = { .gagnant = -1 };
+
+static const char* NOMS_PRODUCTEURS[] = { "comportement", "evitement" };
+
+static struct timespec dans(struct timespec t, double s) {
+    long ns = t.tv_nsec + (long)(s * 1e9);
+    t.tv_sec += ns / 1000000000L;
+    t.tv_nsec = ns % 1000000000L;
+    return t;
+}
+
+void soumettre_trajectoire(ProducteurTrajectoire producteur, const Trajectoire* t,
+                           PrioriteTrajectoire priorite, double validite_s, unsigned int sequence) {
+    if (producteur < 0 || producteur >= NB_PRODUCTEURS || !t) return;
+    Proposition* p = &arb.prop[producteur];
+    prendre_chemin(t->chemin);
+    if (p->active) rendre_chemin(p->traj.chemin);
+    p->active = true;
+    p->traj = *t;
+    p->priorite = priorite;
+    p->sequence = sequence;
+    clock_gettime(CLOCK_MONOTONIC, &p->soumission);
+    p->expiration = dans(p->soumission, validite_s);
+}
+
+void retirer_trajectoire(ProducteurTrajectoire producteur) {
+    if (producteur < 0 || producteur >= NB_PRODUCTEURS) return;
+    Proposition* p = &arb.prop[producteur];
+    if (p->active) rendre_chemin(p->traj.chemin);
+    p->active = false;
+}
+
+int arbitrer_trajectoires(struct timespec now) {
+    int gagnant = -1;
+    for (int i = 0; i < NB_PRODUCTEURS; i++) {
+        Proposition* p = &arb.prop[i];
+        if (!p->active) continue;
+        if (timespec_diff_s(now, p->expiration) < 0.0) {
+            DBG(TAG, "Proposition %s expirée", NOMS_PRODUCTEURS[i]);
+            retirer_trajectoire(i);
+            continue;
+        }
+        if (gagnant < 0) { gagnant = i; continue; }
+        const Proposition* g = &arb.prop[gagnant];
+        if (p->priorite > g->priorite ||
+            (p->priorite == g->priorite && timespec_diff_s(g->soumission, p->soumission) > 0.0))
+            gagnant = i;
+    }
+    if (gagnant < 0) {
+        arb.gagnant = -1;
+        return -1;
+    }
+
+    const Proposition* p = &arb.prop[gagnant];
+    if (gagnant != arb.gagnant || p->sequence != arb.sequence_gagnant) {
+        if (gagnant != arb.gagnant)
+            INFO(TAG, "Trajectoire publiée : %s (priorité %d)", NOMS_PRODUCTEURS[gagnant], p->priorite);
+        arb.sequence_publiee++;
+        arb.gagnant = gagnant;
+        arb.sequence_gagnant = p->sequence;
+    }
+    Trajectoire t = p->traj;
+    t.sequence = arb.sequence_publiee;
+    if (set_trajectoire(&t) != 0) return -1;
+    return gagnant;
+}
@@ -0,0 +1,43 @@
+#ifndef ARBITRAGE_TRAJECTOIRE_H
+#define ARBITRAGE_TRAJECTOIRE_H
+
+#include <time.h>
+#include "messages.h"
+
+/*  Arbitrage entre les producteurs de trajectoire (génération nominale,
+    évitement). Chaque producteur soumet une proposition avec une priorité, une
+    durée de validité et son numéro de séquence (incrémenté quand la géométrie
+    proposée change : nouvel itinéraire, nouvelle manœuvre). Une fois par cycle
+    du thread de comportement, arbitrer_trajectoires() publie une seule
+    trajectoire : la proposition encore valide de plus haute priorité, la plus
+    récente à priorité égale.
+    Trajectoire.sequence n'augmente que lorsque le gagnant change de producteur
+    ou de séquence : le suiveur ne réinitialise son état qu'à ce moment.
+    Les propositions gardent une référence sur leur chemin partagé jusqu'à leur
+    remplacement ou leur expiration.
+*/
+
+typedef enum {
+    PRODUCTEUR_COMPORTEMENT = 0,
+    PRODUCTEUR_EVITEMENT,
+    NB_PRODUCTEURS
+} ProducteurTrajectoire;
+
+typedef enum {
+    PRIORITE_NOMINALE = 0,
+    PRIORITE_EVITEMENT,
+    PRIORITE_URGENCE        // arrêt devant un obstacle
+} PrioriteTrajectoire;
+
+// Remplace la proposition du producteur ; prend une référence sur t->chemin
+void soumettre_trajectoire(ProducteurTrajectoire producteur, const Trajectoire* t,
+                           PrioriteTrajectoire priorite, double validite_s, unsigned int sequence);
+
+// Retire la proposition du producteur (plus rien à proposer)
+void retirer_trajectoire(ProducteurTrajectoire producteur);
+
+// Publie le gagnant par set_trajectoire() ; retourne son producteur, -1 sans
+// proposition valide (rien n'est publié)
+int arbitrer_trajectoires(struct timespec now);
+
+#endif
@@ -0,0 +1,266 @@
+#include <math.h>
+#include <string.h>
+#include "collision_boites.h"
+#include "logger.h"
+#include "utils.h"
+
+#define TAG "collision_boites"
+
+typedef float v4f __attribute__((vector_size(16)));
+typedef int v4i __attribute__((vector_size(16)));
+
+static inline v4f charger(const float* p) {
+    v4f v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline v4f vabs(v4f v) {
+    return (v4f)((v4i)v & 0x7fffffff);
+}
+
+int ajouter_echantillon(CheminEchantillonne* ch, float x, float y, float c, float s, float t) {
+    if (ch->n >= COLLISION_MAX_ECHANTILLONS) return -1;
+    ch->x[ch->n] = x;
+    ch->y[ch->n] = y;
+    ch->c[ch->n] = c;
+    ch->s[ch->n] = s;
+    ch->t[ch->n] = t;
+    ch->n++;
+    return 0;
+}
+
+void terminer_chemin(CheminEchantillonne* ch) {
+    if (ch->n <= 0) return;
+    for (int i = ch->n; i % COLLISION_LOT; i++) {
+        ch->x[i] = ch->x[ch->n - 1];
+        ch->y[i] = ch->y[ch->n - 1];
+        ch->c[i] = ch->c[ch->n - 1];
+        ch->s[i] = ch->s[ch->n - 1];
+        ch->t[i] = ch->t[ch->n - 1];
+    }
+}
+
+void echantillonner_polyligne(float x0, float y0, const Point* pts, int nb, float pas,
+                              float vitesse, CheminEchantillonne* ch) {
+    ch->n = 0;
+    if (vitesse < 1.0f) vitesse = 1.0f;
+    float ax = x0, ay = y0;
+    float u = 0.0f;        // abscisse du début du segment courant
+    float prochain = 0.0f; // abscisse du prochain échantillon
+    for (int i = 0; i < nb; i++) {
+        float dx = pts[i].x - ax, dy = pts[i].y - ay;
+        float l = sqrtf(dx * dx + dy * dy);
+        if (l <= 0.0f) continue;
+        while (prochain <= u + l) {
+            float k = (prochain - u) / l;
+            float t = prochain / vitesse;
+            if (t > COLLISION_PREDICTION_MAX_S) t = COLLISION_PREDICTION_MAX_S;
+            if (ajouter_echantillon(ch, ax + k * dx, ay + k * dy, dx / l, dy / l, t) != 0) {
+                terminer_chemin(ch);
+                return;
+            }
+            prochain += pas;
+        }
+        u += l;
+        ax = pts[i].x;
+        ay = pts[i].y;
+    }
+    terminer_chemin(ch);
+}
+
+void obstacle_depuis_piste(const PisteObstacle* p, ObstacleMobile* o) {
+    float gx = p->pointg.x - p->pointd.x, gy = p->pointg.y - p->pointd.y;
+    float largeur = sqrtf(gx * gx + gy * gy);
+    float v = sqrtf(p->vx * p->vx + p->vy * p->vy);
+    BoiteOrientee* b = &o->boite;
+    b->cx = p->x;
+    b->cy = p->y;
+    if (v > 1.0f) {
+        b->ux = p->vx / v;
+        b->uy = p->vy / v;
+    } else if (largeur > 0.0f) {
+        // pointd -> pointg est l'axe latéral (-uy, ux)
+        b->ux = gy / largeur;
+        b->uy = -gx / largeur;
+    } else {
+        b->ux = 1.0f;
+        b->uy = 0.0f;
+    }
+    b->demi_larg = 0.5f * largeur;
+    b->demi_long = p->type == OBSTACLE_VOITURE ? 0.5f * (float)LONGUEUR_VOITURE_MM : b->demi_larg;
+    o->vx = p->vx;
+    o->vy = p->vy;
+}
+
+int ajouter_ligne(const Point* ligne, int nb_points, ObstacleMobile* o, int nb, int max) {
+    for (int i = 0; i + 1 < nb_points && nb < max; i++) {
+        float dx = ligne[i + 1].x - ligne[i].x, dy = ligne[i + 1].y - ligne[i].y;
+        float l = sqrtf(dx * dx + dy * dy);
+        if (l <= 0.0f) continue;
+        BoiteOrientee* b = &o[nb].boite;
+        b->cx = 0.5f * (ligne[i].x + ligne[i + 1].x);
+        b->cy = 0.5f * (ligne[i].y + ligne[i + 1].y);
+        b->ux = dx / l;
+        b->uy = dy / l;
+        b->demi_long = 0.5f * l;
+        b->demi_larg = 0.0f;
+        o[nb].vx = o[nb].vy = 0.0f;
+        nb++;
+    }
+    return nb;
+}
+
+// En 2D, |uA.uB| = |nA.nB| = k1 et |uA.nB| = |nA.uB| = k2 : les rayons projetés
+// sur les quatre axes se déduisent de ces deux produits
+int boites_se_chevauchent(const BoiteOrientee* a, const BoiteOrientee* b) {
+    float tx = b->cx - a->cx, ty = b->cy - a->cy;
+    float k1 = fabsf(a->ux * b->ux + a->uy * b->uy);
+    float k2 = fabsf(-a->ux * b->uy + a->uy * b->ux);
+    if (fabsf(tx * a->ux + ty * a->uy) > a->demi_long + b->demi_long * k1 + b->demi_larg * k2) return 0;
+    if (fabsf(-tx * a->uy + ty * a->ux) > a->demi_larg + b->demi_long * k2 + b->demi_larg * k1) return 0;
+    if (fabsf(tx * b->ux + ty * b->uy) > b->demi_long + a->demi_long * k1 + a->demi_larg * k2) return 0;
+    if (fabsf(-tx * b->uy + ty * b->ux) > b->demi_larg + a->demi_long * k2 + a->demi_larg * k1) return 0;
+    return 1;
+}
+
+int collision_chemin(const CheminEchantillonne* ch, float marge,
+                     const ObstacleMobile* obs, int nb_obs) {
+    const float al = 0.5f * (float)LONGUEUR_VOITURE_MM + marge;
+    const float aw = 0.5f * (float)LARGEUR_VOITURE_MM + marge;
+
+    for (int i = 0; i < ch->n; i += COLLISION_LOT) {
+        const v4f cx = charger(&ch->x[i]), cy = charger(&ch->y[i]);
+        const v4f c = charger(&ch->c[i]), s = charger(&ch->s[i]);
+        const v4f t = charger(&ch->t[i]);
+        v4i touche = { 0, 0, 0, 0 };
+
+        for (int j = 0; j < nb_obs; j++) {
+            const BoiteOrientee* b = &obs[j].boite;
+            const v4f tx = b->cx + obs[j].vx * t - cx;
+            const v4f ty = b->cy + obs[j].vy * t - cy;
+            const v4f k1 = vabs(c * b->ux + s * b->uy);
+            const v4f k2 = vabs(s * b->ux - c * b->uy);
+            v4i separe = vabs(tx * c + ty * s) > al + b->demi_long * k1 + b->demi_larg * k2;
+            separe |= vabs(ty * c - tx * s) > aw + b->demi_long * k2 + b->demi_larg * k1;
+            separe |= vabs(tx * b->ux + ty * b->uy) > b->demi_long + al * k1 + aw * k2;
+            separe |= vabs(ty * b->ux - tx * b->uy) > b->demi_larg + al * k2 + aw * k1;
+            touche |= ~separe;
+        }
+        for (int k = 0; k < COLLISION_LOT && i + k < ch->n; k++)
+            if (touche[k]) return i + k;
+    }
+    return -1;
+}
+
+#ifdef BENCH
+#define BENCH_COLL_CANDIDATS 36
+#define BENCH_COLL_REPETITIONS 2000
+#define BENCH_COLL_MARGE 50.0f
+
+// Critère d'origine de voiture_evitement.c : distance des points au centre de
+// chaque piste, sans orientation, longueur, marquage ni déplacement
+static int collision_cercle(const CheminEchantillonne* ch, const ObstacleMobile* obs, int nb_obs) {
+    const float r = 0.5f * (float)LARGEUR_VOITURE_MM + BENCH_COLL_MARGE;
+    for (int i = 0; i < ch->n; i++)
+        for (int j = 0; j < nb_obs; j++) {
+            if (obs[j].boite.demi_larg == 0.0f) continue;   // marquage ignoré
+            float dx = ch->x[i] - obs[j].boite.cx, dy = ch->y[i] - obs[j].boite.cy;
+            if (dx * dx + dy * dy < r * r) return i;
+        }
+    return -1;
+}
+
+static int collision_scalaire(const CheminEchantillonne* ch, const ObstacleMobile* obs, int nb_obs) {
+    for (int i = 0; i < ch->n; i++) {
+        BoiteOrientee a = { ch->x[i], ch->y[i], ch->c[i], ch->s[i],
+                            0.5f * LONGUEUR_VOITURE_MM + BENCH_COLL_MARGE,
+                            0.5f * LARGEUR_VOITURE_MM + BENCH_COLL_MARGE };
+        for (int j = 0; j < nb_obs; j++) {
+            BoiteOrientee b = obs[j].boite;
+            b.cx += obs[j].vx * ch->t[i];
+            b.cy += obs[j].vy * ch->t[i];
+            if (boites_se_chevauchent(&a, &b)) return i;
+        }
+    }
+    return -1;
+}
+
+void benchmark_collision_boites(void) {
+    // Route droite, voie de 400 mm et voie de gauche de 400 mm ; 5 voitures
+    // (lente devant, garée à droite, croisement, deux dans la voie de gauche)
+    static CheminEchantillonne chemins[BENCH_COLL_CANDIDATS];
+    ObstacleMobile obs[MAX_PISTES_OBSTACLES + 2 * MAX_POINTS_MARQUAGE];
+    const float pistes[5][4] = {
+        {  700.0f,    0.0f,  30.0f, 0.0f },
+        { 1300.0f, -150.0f,   0.0f, 0.0f },
+        { 1800.0f,  400.0f, -80.0f, 0.0f },
+        { 2400.0f,  400.0f, -60.0f, 0.0f },
+        {  900.0f,  430.0f,   0.0f, 0.0f },
+    };
+    int nb_obs = 0;
+    for (int j = 0; j < 5; j++) {
+        PisteObstacle p;
+        memset(&p, 0, sizeof(p));
+        p.type = OBSTACLE_VOITURE;
+        p.x = pistes[j][0];
+        p.y = pistes[j][1];
+        p.vx = pistes[j][2];
+        p.vy = pistes[j][3];
+        p.pointg = (Point){ .x = p.x, .y = p.y + 70.0f };
+        p.pointd = (Point){ .x = p.x, .y = p.y - 70.0f };
+        obstacle_depuis_piste(&p, &obs[nb_obs++]);
+    }
+    Point ligne[20];
+    for (int cote = 0; cote < 2; cote++) {
+        for (int i = 0; i < 20; i++) ligne[i] = (Point){ .x = 150.0f * i, .y = cote ? 600.0f : -200.0f };
+        nb_obs = ajouter_ligne(ligne, 20, obs, nb_obs, MAX_PISTES_OBSTACLES + 2 * MAX_POINTS_MARQUAGE);
+    }
+
+    // Candidats : décalage final de -400 à +400 mm atteint sur 400 à 1300 mm
+    for (int k = 0; k < BENCH_COLL_CANDIDATS; k++) {
+        float d_fin = -400.0f + 100.0f * (k % 9), L = 400.0f + 300.0f * (k / 9);
+        chemins[k].n = 0;
+        for (float u = 0.0f; u < 2000.0f; u += 50.0f) {
+            float r = u < L ? u / L : 1.0f;
+            float d = d_fin * r * r * (3.0f - 2.0f * r);
+            float pente = u < L ? d_fin * 6.0f * r * (1.0f - r) / L : 0.0f;
+            float n = sqrtf(1.0f + pente * pente);
+            ajouter_echantillon(&chemins[k], u, d, 1.0f / n, pente / n, u / 80.0f);
+        }
+        terminer_chemin(&chemins[k]);
+    }
+
+    int ecarts = 0, libres_cercle = 0, libres_boites = 0;
+    for (int k = 0; k < BENCH_COLL_CANDIDATS; k++) {
+        int a = collision_scalaire(&chemins[k], obs, nb_obs);
+        int b = collision_chemin(&chemins[k], BENCH_COLL_MARGE, obs, nb_obs);
+        if (a != b) ecarts++;
+        libres_cercle += collision_cercle(&chemins[k], obs, nb_obs) < 0;
+        libres_boites += b < 0;
+    }
+
+    struct timespec t0, t1, t2, t3;
+    volatile int puits = 0;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int r = 0; r < BENCH_COLL_REPETITIONS; r++)
+        for (int k = 0; k < BENCH_COLL_CANDIDATS; k++) puits += collision_cercle(&chemins[k], obs, nb_obs);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    for (int r = 0; r < BENCH_COLL_REPETITIONS; r++)
+        for (int k = 0; k < BENCH_COLL_CANDIDATS; k++) puits += collision_scalaire(&chemins[k], obs, nb_obs);
+    clock_gettime(CLOCK_MONOTONIC, &t2);
+    for (int r = 0; r < BENCH_COLL_REPETITIONS; r++)
+        for (int k = 0; k < BENCH_COLL_CANDIDATS; k++)
+            puits += collision_chemin(&chemins[k], BENCH_COLL_MARGE, obs, nb_obs);
+    clock_gettime(CLOCK_MONOTONIC, &t3);
+
+    const double n = (double)BENCH_COLL_REPETITIONS;
+    INFO(TAG, "%d candidats de %d échantillons, %d obstacles (%d segments de marquage)",
+         BENCH_COLL_CANDIDATS, chemins[0].n, nb_obs, nb_obs - 5);
+    INFO(TAG, "Cercle (origine) : %.1f us par cycle, %d candidats libres",
+         timespec_diff_s(t0, t1) * 1e6 / n, libres_cercle);
+    INFO(TAG, "Boîtes scalaires : %.1f us par cycle", timespec_diff_s(t1, t2) * 1e6 / n);
+    INFO(TAG, "Boîtes par lots de %d : %.1f us par cycle, %d candidats libres, %d écarts avec le scalaire",
+         COLLISION_LOT, timespec_diff_s(t2, t3) * 1e6 / n, libres_boites, ecarts);
+}
+#endif
@@ -0,0 +1,72 @@
+#ifndef COLLISION_BOITES_H
+#define COLLISION_BOITES_H
+
+#include "messages.h"
+#include "config.h"
+
+/*  Test de collision par boîtes orientées (théorème de l'axe séparateur).
+    L'emprise de la voiture (LONGUEUR_VOITURE_MM x LARGEUR_VOITURE_MM, élargie
+    d'une marge) est balayée le long d'un chemin échantillonné et comparée à des
+    obstacles : boîtes des pistes suivies, déplacées à vitesse constante jusqu'à
+    l'instant de passage de chaque échantillon, et segments de marquage (boîtes
+    de largeur nulle).
+    Le chemin est rangé par composantes (x[], y[], cap, instant) : les
+    échantillons sont testés par lots de COLLISION_LOT avec les extensions
+    vectorielles de GCC (SSE sur PC, NEON sur la cible), sans intrinsèques.
+*/
+
+#define COLLISION_LOT 4
+
+typedef struct {
+    float cx, cy;             // centre (mm)
+    float ux, uy;             // axe longitudinal unitaire (l'axe latéral est (-uy, ux))
+    float demi_long, demi_larg;
+} BoiteOrientee;
+
+typedef struct {
+    BoiteOrientee boite;      // position à t = 0
+    float vx, vy;             // mm/s, nuls pour le marquage
+} ObstacleMobile;
+
+typedef struct {
+    int n;                    // échantillons valides ; les lots sont complétés par le dernier
+    float x[COLLISION_MAX_ECHANTILLONS] __attribute__((aligned(16)));
+    float y[COLLISION_MAX_ECHANTILLONS] __attribute__((aligned(16)));
+    float c[COLLISION_MAX_ECHANTILLONS] __attribute__((aligned(16)));   // cos du cap
+    float s[COLLISION_MAX_ECHANTILLONS] __attribute__((aligned(16)));   // sin du cap
+    float t[COLLISION_MAX_ECHANTILLONS] __attribute__((aligned(16)));   // instant de passage (s)
+} CheminEchantillonne;
+
+// Ajoute un échantillon de cap (c, s) unitaire ; 0 si OK, -1 si le chemin est plein
+int ajouter_echantillon(CheminEchantillonne* ch, float x, float y, float c, float s, float t);
+
+// Complète le dernier lot ; à appeler avant collision_chemin()
+void terminer_chemin(CheminEchantillonne* ch);
+
+// Depuis (x0, y0), échantillons tous les pas mm le long des points, parcourus à
+// vitesse mm/s (instant borné à COLLISION_PREDICTION_MAX_S) ; chemin terminé
+void echantillonner_polyligne(float x0, float y0, const Point* pts, int nb, float pas,
+                              float vitesse, CheminEchantillonne* ch);
+
+// Boîte d'une piste : orientée selon sa vitesse si elle roule, sinon
+// perpendiculaire à pointg -> pointd ; longueur LONGUEUR_VOITURE_MM pour une voiture
+void obstacle_depuis_piste(const PisteObstacle* p, ObstacleMobile* o);
+
+// Segments d'une ligne de marquage, ajoutés à o ; retourne le nouveau nombre
+int ajouter_ligne(const Point* ligne, int nb_points, ObstacleMobile* o, int nb, int max);
+
+// Chevauchement de deux boîtes (référence scalaire)
+int boites_se_chevauchent(const BoiteOrientee* a, const BoiteOrientee* b);
+
+// Premier échantillon où l'emprise de la voiture élargie de marge touche un
+// obstacle, -1 s'il n'y en a pas
+int collision_chemin(const CheminEchantillonne* ch, float marge,
+                     const ObstacleMobile* obs, int nb_obs);
+
+#ifdef BENCH
+// Candidats d'un treillis contre pistes et marquage : cercle d'origine,
+// boîtes scalaires et boîtes par lots
+void benchmark_collision_boites(void);
+#endif
+
+#endif
@@ -0,0 +1,453 @@
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <string.h>
+#include "planificateur_treillis.h"
+#include "annotation_itineraire.h"
+#include "ajustement_voie.h"
+#include "collision_boites.h"
+#include "config.h"
+#include "logger.h"
+#include "utils.h"
+
+#define TAG "planificateur_treillis"
+
+#define NB_CANDIDATS (TREILLIS_NB_LATERAUX * TREILLIS_NB_LONGITUDINAUX)
+#define PAS_MANOEUVRE_MM 300.0f
+#define PENALITE_COLLISION 1e6f
+#define LOTS_TRANCHE 2            // lots de collision_chemin() échantillonnés à la fois
+#define NB_ECHANTILLONS_BORDS 5   // points de chaque bord du modèle de voie projetés
+
+typedef struct {
+    float d_fin, longueur;
+    float c[6];               // d(u) = somme c[i] u^i pour u dans [0, longueur]
+    bool evalue, collision;
+    float distance_libre;     // parcourue avant collision ou sortie de voie
+    float cout;
+} Candidat;
+
+typedef enum {
+    PHASE_CYCLE = 0,
+    PHASE_ARRET = 1
+} PhaseTreillis;
+
+// Données d'une planification, écrites par l'appelant avant de réveiller les travailleurs
+static struct {
+    const Itineraire* iti;
+    const AnnotationItineraire* a;
+    float s0;
+    float vitesse;            // mm/s, pour la prédiction des pistes
+    int nb_obstacles;
+    ObstacleMobile obstacles[MAX_PISTES_OBSTACLES];
+    float borne_g, borne_d;   // limites de la voie en d (borne_d < 0 < borne_g)
+    struct timespec echeance;
+    PhaseTreillis phase;
+} ctx;
+
+static Candidat candidats[NB_CANDIDATS];
+static atomic_int prochain;
+
+static pthread_t threads[TREILLIS_MAX_THREADS];
+static pthread_barrier_t barriere_debut, barriere_fin;
+static int nb_travailleurs = 1;
+static bool treillis_init = false;
+
+// Portillon de départ : les barrières ne sont dimensionnées qu'une fois toutes
+// les créations de threads tentées
+static pthread_mutex_t lancement_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t lancement_cond = PTHREAD_COND_INITIALIZER;
+static bool lancement = false;
+
+// --- Repère de Frenet de l'itinéraire ---
+
+// (tx, ty) : tangente unitaire de l'itinéraire en s
+static void frenet_vers_monde(float s, float d, float* x, float* y, float* tx_out, float* ty_out) {
+    const Itineraire* iti = ctx.iti;
+    const AnnotationItineraire* a = ctx.a;
+    int k = point_a_abscisse(a, iti->nb_points, s);
+    if (k > iti->nb_points - 2) k = iti->nb_points - 2;
+    const Point* u = &iti->points[k];
+    const Point* v = &iti->points[k + 1];
+    float l = a->abscisse[k + 1] - a->abscisse[k];
+    float t = l > 0.0f ? (s - a->abscisse[k]) / l : 0.0f;
+    float tx = v->x - u->x, ty = v->y - u->y;
+    float n = sqrtf(tx * tx + ty * ty);
+    if (n > 0.0f) { tx /= n; ty /= n; }
+    *x = u->x + t * (v->x - u->x) - d * ty;
+    *y = u->y + t * (v->y - u->y) + d * tx;
+    *tx_out = tx;
+    *ty_out = ty;
+}
+
+// Polynôme de degré 5 : (d0, pente0, 0) en u = 0 vers (d_fin, 0, 0) en u = L
+static void construire_candidat(Candidat* c, float d0, float pente0, float d_fin, float L) {
+    const float delta = d_fin - d0;
+    const float L2 = L * L, L3 = L2 * L;
+    c->d_fin = d_fin;
+    c->longueur = L;
+    c->c[0] = d0;
+    c->c[1] = pente0;
+    c->c[2] = 0.0f;
+    c->c[3] = (20.0f * delta - 12.0f * pente0 * L) / (2.0f * L3);
+    c->c[4] = (-30.0f * delta + 16.0f * pente0 * L) / (2.0f * L3 * L);
+    c->c[5] = (12.0f * delta - 6.0f * pente0 * L) / (2.0f * L3 * L2);
+}
+
+static inline float d_candidat(const Candidat* c, float u) {
+    if (u >= c->longueur) return c->d_fin;
+    return c->c[0] + u * (c->c[1] + u * (c->c[2] + u * (c->c[3] + u * (c->c[4] + u * c->c[5]))));
+}
+
+static inline float d1_candidat(const Candidat* c, float u) {
+    if (u >= c->longueur) return 0.0f;
+    return c->c[1] + u * (2.0f * c->c[2] + u * (3.0f * c->c[3] + u * (4.0f * c->c[4] + u * 5.0f * c->c[5])));
+}
+
+static inline float d2_candidat(const Candidat* c, float u) {
+    if (u >= c->longueur) return 0.0f;
+    return 2.0f * c->c[2] + u * (6.0f * c->c[3] + u * (12.0f * c->c[4] + u * 20.0f * c->c[5]));
+}
+
+// Emprise de la voiture (boîte orientée) balayée le long du candidat contre les
+// pistes prédites ; la voie est vérifiée en d, où les zones de dépassement s'expriment
+static void evaluer_candidat(Candidat* c) {
+    const float demi = 0.5f * (float)LARGEUR_VOITURE_MM + (float)TREILLIS_MARGE_MM;
+    const float largeur_voie = ctx.borne_g - ctx.borne_d;
+    const float s_max = ctx.a->abscisse[ctx.iti->nb_points - 1];
+    CheminEchantillonne ch;
+    int fin = -1;             // premier échantillon bloqué
+    int nb = 0;               // échantillons du candidat
+    float u = TREILLIS_PAS_MM;
+
+    // Par tranches de LOTS_TRANCHE lots : on s'arrête à la première tranche bloquée
+    while (fin < 0 && u <= TREILLIS_HORIZON_MM && ctx.s0 + u <= s_max) {
+        int sortie = -1;      // premier échantillon de la tranche hors de la voie
+        ch.n = 0;
+        for (; ch.n < LOTS_TRANCHE * COLLISION_LOT && u <= TREILLIS_HORIZON_MM; u += TREILLIS_PAS_MM) {
+            float s = ctx.s0 + u;
+            if (s > s_max) break;
+            float d = d_candidat(c, u);
+            float borne_g = ctx.borne_g;
+            if (depassement_autorise(ctx.a, s)) borne_g += largeur_voie;
+            if (sortie < 0 && (d + demi > borne_g || d - demi < ctx.borne_d)) sortie = ch.n;
+
+            // Cap de la voiture : tangente + d'(u) x normale
+            float x, y, tx, ty;
+            frenet_vers_monde(s, d, &x, &y, &tx, &ty);
+            float pente = d1_candidat(c, u);
+            float n = sqrtf(1.0f + pente * pente);
+            float t = u / ctx.vitesse;
+            if (t > TREILLIS_PREDICTION_MAX_S) t = TREILLIS_PREDICTION_MAX_S;
+            ajouter_echantillon(&ch, x, y, (tx - pente * ty) / n, (ty + pente * tx) / n, t);
+            if (sortie >= 0) break;
+        }
+        terminer_chemin(&ch);
+        int k = collision_chemin(&ch, TREILLIS_MARGE_MM, ctx.obstacles, ctx.nb_obstacles);
+        if (sortie >= 0 && (k < 0 || sortie < k)) k = sortie;
+        if (k >= 0) fin = nb + k;
+        nb += ch.n;
+    }
+    c->collision = fin >= 0;
+    if (fin < 0) fin = nb;
+    c->distance_libre = fin * (float)TREILLIS_PAS_MM;
+
+    // Confort et proximité sur la partie parcourue (centres seulement)
+    float confort = 0.0f, proximite = 0.0f;
+    for (int i = 0; i < fin; i++) {
+        float ui = (i + 1) * (float)TREILLIS_PAS_MM;
+        float dd = d2_candidat(c, ui);
+        confort += dd * dd * TREILLIS_PAS_MM;
+        float x, y, tx, ty;
+        frenet_vers_monde(ctx.s0 + ui, d_candidat(c, ui), &x, &y, &tx, &ty);
+        float t = ui / ctx.vitesse;
+        if (t > TREILLIS_PREDICTION_MAX_S) t = TREILLIS_PREDICTION_MAX_S;
+        for (int j = 0; j < ctx.nb_obstacles; j++) {
+            const ObstacleMobile* o = &ctx.obstacles[j];
+            float ex = x - (o->boite.cx + o->vx * t);
+            float ey = y - (o->boite.cy + o->vy * t);
+            float marge = sqrtf(ex * ex + ey * ey) - o->boite.demi_larg - 0.5f * (float)LARGEUR_VOITURE_MM;
+            if (marge < TREILLIS_MARGE_CONFORT_MM)
+                proximite += (TREILLIS_MARGE_CONFORT_MM - marge) * (TREILLIS_MARGE_CONFORT_MM - marge);
+        }
+    }
+
+    c->cout = TREILLIS_POIDS_CONFORT * confort
+            + TREILLIS_POIDS_LATERAL * c->d_fin * c->d_fin
+            + TREILLIS_POIDS_PROGRES * (TREILLIS_HORIZON_MM - c->distance_libre)
+            + TREILLIS_POIDS_PROXIMITE * proximite
+            + (c->collision ? PENALITE_COLLISION : 0.0f);
+}
+
+// Candidats pris dans l'ordre (du plus centré au plus décalé) tant que le budget le permet
+static void evaluer_candidats(void) {
+    int k;
+    while ((k = atomic_fetch_add(&prochain, 1)) < NB_CANDIDATS) {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (timespec_diff_s(now, ctx.echeance) < 0.0) continue;
+        evaluer_candidat(&candidats[k]);
+        candidats[k].evalue = true;
+    }
+}
+
+static void* boucle_travailleur(void* arg) {
+    (void)arg;
+    pthread_mutex_lock(&lancement_mutex);
+    while (!lancement) pthread_cond_wait(&lancement_cond, &lancement_mutex);
+    pthread_mutex_unlock(&lancement_mutex);
+    while (1) {
+        pthread_barrier_wait(&barriere_debut);
+        if (ctx.phase == PHASE_ARRET) break;
+        evaluer_candidats();
+        pthread_barrier_wait(&barriere_fin);
+    }
+    return NULL;
+}
+
+int init_planificateur_treillis(int nb_threads) {
+    if (treillis_init) return 0;
+    if (nb_threads < 1) nb_threads = 1;
+    if (nb_threads > TREILLIS_MAX_THREADS) nb_threads = TREILLIS_MAX_THREADS;
+
+    nb_travailleurs = nb_threads;
+    ctx.phase = PHASE_CYCLE;
+    lancement = false;
+    // Le travailleur 0 est le thread appelant
+    for (int k = 1; k < nb_travailleurs; k++) {
+        if (pthread_create(&threads[k], NULL, boucle_travailleur, NULL) != 0) {
+            ERR(TAG, "Impossible de créer le travailleur %d", k);
+            nb_travailleurs = k;
+            break;
+        }
+    }
+    // Les travailleurs créés attendent au portillon : barrières à leur nombre réel
+    pthread_barrier_init(&barriere_debut, NULL, nb_travailleurs);
+    pthread_barrier_init(&barriere_fin, NULL, nb_travailleurs);
+    pthread_mutex_lock(&lancement_mutex);
+    lancement = true;
+    pthread_cond_broadcast(&lancement_cond);
+    pthread_mutex_unlock(&lancement_mutex);
+    treillis_init = true;
+    INFO(TAG, "Planificateur en treillis : %d candidats, %d travailleur(s)", NB_CANDIDATS, nb_travailleurs);
+    return 0;
+}
+
+void stop_planificateur_treillis(void) {
+    if (!treillis_init) return;
+    ctx.phase = PHASE_ARRET;
+    if (nb_travailleurs > 1) pthread_barrier_wait(&barriere_debut);
+    for (int k = 1; k < nb_travailleurs; k++)
+        pthread_join(threads[k], NULL);
+    pthread_barrier_destroy(&barriere_debut);
+    pthread_barrier_destroy(&barriere_fin);
+    nb_travailleurs = 1;
+    treillis_init = false;
+}
+
+static void retenir_borne(float x, float y, bool gauche, int debut, int fin, float* g, float* d) {
+    ProjectionItineraire p;
+    if (!projeter_sur_itineraire(ctx.iti, ctx.a, debut, fin, x, y, &p)) return;
+    if (gauche && p.lateral > 0.0f && p.lateral < *g) *g = p.lateral;
+    if (!gauche && p.lateral < 0.0f && p.lateral > *d) *d = p.lateral;
+}
+
+// Limites de la voie en d, projetées sur l'itinéraire devant la voiture : bords
+// du modèle de voie s'il est confiant (échantillonnés jusqu'à sa portée), sinon
+// points bruts du marquage
+static void bornes_voie(const DetectionMonde* det, int debut, int fin) {
+    float g = 1e9f, d = -1e9f;
+    const ModeleVoie* v = det ? &det->voie : NULL;
+    if (v && det->pose_valide && v->valide && v->confiance >= VOIE_CONFIANCE_MIN) {
+        const float th = det->pose.theta * (float)PI / 180.0f;
+        const float c = cosf(th), s = sinf(th);
+        const float portee = v->portee < TREILLIS_HORIZON_MM ? v->portee : (float)TREILLIS_HORIZON_MM;
+        for (int k = 0; k < NB_ECHANTILLONS_BORDS; k++) {
+            float x = portee * k / (NB_ECHANTILLONS_BORDS - 1);
+            for (int cote = -1; cote <= 1; cote += 2) {
+                float y = ordonnee_voie(v, cote, x);
+                retenir_borne(det->pose.x + x * c - y * s, det->pose.y + x * s + y * c,
+                              cote > 0, debut, fin, &g, &d);
+            }
+        }
+    } else if (det && det->pose_valide) {
+        const MarquageSol* m = &det->marquage_sol;
+        for (int i = 0; i < m->nb_points_gauche; i++)
+            retenir_borne(m->ligne_gauche[i].x, m->ligne_gauche[i].y, true, debut, fin, &g, &d);
+        for (int i = 0; i < m->nb_points_droite; i++)
+            retenir_borne(m->ligne_droite[i].x, m->ligne_droite[i].y, false, debut, fin, &g, &d);
+    }
+    ctx.borne_g = g < 1e9f ? g : (float)TREILLIS_DEMI_VOIE_MM;
+    ctx.borne_d = d > -1e9f ? d : -(float)TREILLIS_DEMI_VOIE_MM;
+}
+
+int planifier_treillis(const Itineraire* iti, const AnnotationItineraire* a,
+                       const PositionVoiture* pos, float vitesse, const ObstaclesSuivis* suivis,
+                       const DetectionMonde* detection, Point* points, int max_points,
+                       Trajectoire* out, StatsTreillis* stats) {
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    if (!iti || iti->nb_points < 2) return -1;
+
+    // --- Etat de la voiture en Frenet ---
+    ctx.iti = iti;
+    ctx.a = a;
+    ProjectionItineraire p;
+    if (!projeter_sur_itineraire(iti, a, 0, iti->nb_points - 1, pos->x, pos->y, &p)) return -1;
+    ctx.s0 = p.s;
+    const Point* u = &iti->points[p.segment];
+    const Point* v = &iti->points[p.segment + 1];
+    float ecart_cap = pos->theta * (float)PI / 180.0f - atan2f(v->y - u->y, v->x - u->x);
+    ecart_cap = atan2f(sinf(ecart_cap), cosf(ecart_cap));
+    float pente0 = tanf(ecart_cap);
+    if (pente0 > 1.0f) pente0 = 1.0f;
+    if (pente0 < -1.0f) pente0 = -1.0f;
+
+    if (vitesse > (float)MAX_VITESSE) vitesse = (float)MAX_VITESSE;
+    ctx.vitesse = vitesse > 1.0f ? vitesse : 1.0f;
+
+    int fin = point_a_abscisse(a, iti->nb_points, ctx.s0 + TREILLIS_HORIZON_MM) + 1;
+    bornes_voie(detection, p.segment, fin);
+
+    ctx.nb_obstacles = 0;
+    for (int i = 0; suivis && i < suivis->count; i++) {
+        if (suivis->piste[i].etat == PISTE_TERMINEE) continue;
+        obstacle_depuis_piste(&suivis->piste[i], &ctx.obstacles[ctx.nb_obstacles++]);
+    }
+
+    // --- Treillis : décalages 0, +1, -1, +2, -2... puis longueurs croissantes ---
+    const float pas_lateral = 2.0f * TREILLIS_LATERAL_MAX_MM / (TREILLIS_NB_LATERAUX - 1);
+    int k = 0;
+    for (int l = 0; l < TREILLIS_NB_LATERAUX; l++) {
+        int rang = (l + 1) / 2;
+        float d_fin = (l % 2 ? 1.0f : -1.0f) * rang * pas_lateral;
+        for (int m = 0; m < TREILLIS_NB_LONGITUDINAUX; m++, k++) {
+            construire_candidat(&candidats[k], p.lateral, pente0, d_fin,
+                                TREILLIS_MANOEUVRE_MIN_MM + m * PAS_MANOEUVRE_MM);
+            candidats[k].evalue = false;
+        }
+    }
+
+    ctx.echeance = t0;
+    ctx.echeance.tv_nsec += TREILLIS_BUDGET_US * 1000L;
+    ctx.echeance.tv_sec += ctx.echeance.tv_nsec / 1000000000L;
+    ctx.echeance.tv_nsec %= 1000000000L;
+    atomic_store(&prochain, 0);
+
+    if (treillis_init && nb_travailleurs > 1) pthread_barrier_wait(&barriere_debut);
+    evaluer_candidats();
+    if (treillis_init && nb_travailleurs > 1) pthread_barrier_wait(&barriere_fin);
+
+    // --- Meilleur candidat ---
+    const Candidat* best = NULL;
+    int evalues = 0, libres = 0;
+    for (int i = 0; i < NB_CANDIDATS; i++) {
+        if (!candidats[i].evalue) continue;
+        evalues++;
+        if (!candidats[i].collision) libres++;
+        if (!best || candidats[i].cout < best->cout) best = &candidats[i];
+    }
+    if (!best) {
+        // Budget épuisé avant le premier candidat : on l'évalue quand même
+        evaluer_candidat(&candidats[0]);
+        best = &candidats[0];
+        evalues = 1;
+        libres = !best->collision;
+    }
+
+    // --- Trajectoire : un point tous les TREILLIS_PAS_MM jusqu'à l'horizon (ou avant la collision) ---
+    int n = (int)(best->distance_libre / TREILLIS_PAS_MM);
+    if (n > max_points) n = max_points;
+    for (int i = 0; i < (n > 0 ? n : 1); i++) {
+        float ui = n > 0 ? (i + 1) * (float)TREILLIS_PAS_MM : 0.0f;
+        float tx, ty, pente = d1_candidat(best, ui);
+        Point* q = &points[i];
+        memset(q, 0, sizeof(*q));
+        frenet_vers_monde(ctx.s0 + ui, d_candidat(best, ui), &q->x, &q->y, &tx, &ty);
+        q->z = pos->z;
+        q->theta = atan2f(ty + pente * tx, tx - pente * ty) * 180.0f / (float)PI;
+    }
+    out->points = points;
+    out->nb_points = n > 0 ? n : 1;
+    out->horizon = n * (float)TREILLIS_PAS_MM;
+    out->vitesse = vitesse > 0.0f ? vitesse : 0.0f;
+    out->vitesse_max = (float)MAX_VITESSE;
+    out->arreter_fin = best->collision;
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    if (stats) {
+        stats->evalues = evalues;
+        stats->libres = libres;
+        stats->d_fin = best->d_fin;
+        stats->longueur = best->longueur;
+        stats->cout = best->cout;
+        stats->duree_us = timespec_diff_s(t0, t1) * 1e6;
+    }
+    return best->collision ? 1 : 0;
+}
+
+#ifdef BENCH
+#define BENCH_TREILLIS_PLANIFICATIONS 500
+
+void benchmark_planificateur_treillis(void) {
+    // Ligne droite de 1000 points, voie de 400 mm, voiture lente 600 mm devant ;
+    // zone de dépassement sur la deuxième moitié
+    static Itineraire iti;
+    static AnnotationItineraire a;
+    static DetectionMonde det;
+    static ObstaclesSuivis suivis;
+    iti.nb_points = 1000;
+    for (int i = 0; i < iti.nb_points; i++) {
+        memset(&iti.points[i], 0, sizeof(Point));
+        iti.points[i].x = 20.0f * i;
+        iti.points[i].depacement = i >= 500;
+    }
+    annoter_itineraire(&iti, &a);
+    MarquageSol* marquage = &det.marquage_sol;
+    marquage->nb_points_gauche = marquage->nb_points_droite = 20;
+    for (int i = 0; i < 20; i++) {
+        marquage->ligne_gauche[i] = (Point){ .x = 150.0f * i, .y = 200.0f };
+        marquage->ligne_droite[i] = (Point){ .x = 150.0f * i, .y = -200.0f };
+    }
+    ajuster_voie(marquage, &det.voie);   // en repère voiture, avant le passage en monde
+    det.pose_valide = 1;
+    suivis.count = 1;
+    memset(&suivis.piste[0], 0, sizeof(PisteObstacle));
+    suivis.piste[0].type = OBSTACLE_VOITURE;
+    suivis.piste[0].etat = PISTE_MISE_A_JOUR;
+    suivis.piste[0].vx = 20.0f;
+    suivis.piste[0].pointg = (Point){ .y = 70.0f };
+    suivis.piste[0].pointd = (Point){ .y = -70.0f };
+
+    const float x0[2] = { 2000.0f, 12000.0f };   // hors et dans la zone de dépassement
+    const int nb_threads[2] = { 1, TREILLIS_NB_THREADS };
+    for (int n = 0; n < 2; n++) {
+        init_planificateur_treillis(nb_threads[n]);
+        for (int zone = 0; zone < 2; zone++) {
+            PositionVoiture pos = { x0[zone], 0.0f, 0.0f, 0.0f, 80.0f, 0.0f, 0.0f };
+            PisteObstacle* o = &suivis.piste[0];
+            o->x = o->pointg.x = o->pointd.x = x0[zone] + 600.0f;
+            det.pose = pos;
+            for (int i = 0; i < 20; i++)
+                marquage->ligne_gauche[i].x = marquage->ligne_droite[i].x = x0[zone] + 150.0f * i;
+
+            static Point points[MAX_POINTS_CHEMIN];
+            Trajectoire t;
+            StatsTreillis st;
+            double total = 0.0, pire = 0.0;
+            int ret = 0;
+            for (int r = 0; r < BENCH_TREILLIS_PLANIFICATIONS; r++) {
+                ret = planifier_treillis(&iti, &a, &pos, pos.vx, &suivis, &det, points, MAX_POINTS_CHEMIN, &t, &st);
+                total += st.duree_us;
+                if (st.duree_us > pire) pire = st.duree_us;
+            }
+            INFO(TAG, "Treillis (%d travailleur(s), %s) : %.1f us en moyenne, pire %.1f us, %d/%d évalués, "
+                      "%d libres, retenu d=%.0f mm sur %.0f mm%s",
+                 nb_travailleurs, zone ? "dépassement autorisé" : "dans la voie",
+                 total / BENCH_TREILLIS_PLANIFICATIONS, pire, st.evalues, NB_CANDIDATS, st.libres,
+                 st.d_fin, st.longueur, ret == 1 ? " (arrêt)" : "");
+        }
+        stop_planificateur_treillis();
+    }
+}
+#endif
@@ -0,0 +1,62 @@
+#ifndef PLANIFICATEUR_TREILLIS_H
+#define PLANIFICATEUR_TREILLIS_H
+
+#include "messages.h"
+
+/*  Planificateur en treillis pour l'évitement et le dépassement.
+    Repère de Frenet de l'itinéraire : s abscisse curviligne, d écart latéral
+    (positif à gauche). Les états finaux échantillonnés combinent
+    TREILLIS_NB_LATERAUX décalages d_fin et TREILLIS_NB_LONGITUDINAUX longueurs
+    de manœuvre ; chaque candidat est un polynôme de degré 5 d(s) partant de
+    l'état de la voiture (d, d', d''=0) et arrivant à (d_fin, 0, 0), puis
+    prolongé à d_fin jusqu'à TREILLIS_HORIZON_MM.
+
+    Coût d'un candidat, évalué tous les TREILLIS_PAS_MM :
+     - collision de l'emprise de la voiture avec une piste confirmée (boîtes
+       orientées, position prédite à vitesse constante, cf. collision_boites.h)
+       ou sortie de la voie (bords du modèle de voie s'il est confiant, points
+       du marquage sinon, demi-voie par défaut sans pose ; voie voisine
+       autorisée dans les zones de dépassement de l'itinéraire) : le candidat
+       s'arrête là ;
+     - progrès : distance non parcourue avant la collision ;
+     - confort : intégrale de d''(s)² et décalage final ;
+     - proximité : empiètement sur TREILLIS_MARGE_CONFORT_MM autour des pistes.
+
+    Les candidats sont répartis entre TREILLIS_NB_THREADS travailleurs (le
+    thread appelant est le travailleur 0), du plus centré au plus décalé ;
+    ceux qui ne sont pas commencés après TREILLIS_BUDGET_US sont ignorés.
+*/
+
+typedef struct {
+    int evalues;          // candidats évalués dans le budget
+    int libres;           // candidats sans collision
+    float d_fin;          // candidat retenu
+    float longueur;
+    float cout;
+    double duree_us;
+} StatsTreillis;
+
+// Lance les travailleurs ; sans appel, la planification reste sur le thread appelant
+int init_planificateur_treillis(int nb_threads);
+void stop_planificateur_treillis(void);
+
+/*  Planifie depuis pos ; l'itinéraire doit être annoté (abscisses).
+    Ecrit dans points (au plus max_points, typiquement un chemin partagé) un point
+    tous les TREILLIS_PAS_MM du meilleur candidat, et out en fait la vue ;
+    out->chemin est laissé à l'appelant. vitesse (mm/s) est la vitesse commandée
+    pendant la manœuvre : elle date les positions prédites des pistes et devient
+    out->vitesse.
+    Retour : 0 si un candidat sans collision existe, 1 si tous sont bloqués
+    (out s'arrête avant la collision, arreter_fin = 1, un seul point si la
+    collision est au premier échantillon), -1 sans itinéraire. */
+int planifier_treillis(const Itineraire* iti, const AnnotationItineraire* a,
+                       const PositionVoiture* pos, float vitesse, const ObstaclesSuivis* suivis,
+                       const DetectionMonde* detection, Point* points, int max_points,
+                       Trajectoire* out, StatsTreillis* stats);
+
+#ifdef BENCH
+// Voiture lente devant dans la voie : coût d'une planification selon le nombre de travailleurs
+void benchmark_planificateur_treillis(void);
+#endif
+
+#endif
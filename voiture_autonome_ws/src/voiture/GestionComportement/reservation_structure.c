@@ -0,0 +1,106 @@
+#include <stdbool.h>
+#include "reservation_structure.h"
+#include "communication_tcp_voiture.h"
+#include "config.h"
+#include "logger.h"
+#include "messages.h"
+#include "utils.h"
+#include "voiture_globals.h"
+
+#define TAG "reservation"
+
+// Etat propre au thread de comportement : pas de verrou
+static struct {
+    EtatReservation etat;
+    int structure_id;
+    int essais;                        // envois sans réponse depuis la dernière consigne
+    struct timespec echeance;          // renvoi (DEMANDEE) ou nouvelle demande (EN_ATTENTE)
+    struct timespec derniere_consigne; // last_update de la dernière consigne traitée
+} resa = { .etat = RESA_REPOS, .structure_id = -1 };
+
+static const char* NOMS_ETATS[] = { "REPOS", "DEMANDEE", "EN_ATTENTE", "ACCORDEE", "ABANDONNEE" };
+
+static void changer_etat(EtatReservation etat) {
+    if (etat != resa.etat)
+        INFO(TAG, "Structure %d : %s -> %s", resa.structure_id, NOMS_ETATS[resa.etat], NOMS_ETATS[etat]);
+    resa.etat = etat;
+}
+
+static struct timespec dans(struct timespec t, double s) {
+    long ns = t.tv_nsec + (long)(s * 1e9);
+    t.tv_sec += ns / 1000000000L;
+    t.tv_nsec = ns % 1000000000L;
+    return t;
+}
+
+static void envoyer(DemandeType type) {
+    Demande d = { .structure_id = resa.structure_id, .type = type, .direction = 'n' };
+    set_demande(&d);
+    if (est_connectee() && sendMessage(MESSAGE_DEMANDE, &d) < 0)
+        WARN(TAG, "Envoi de la demande (structure %d) impossible", resa.structure_id);
+}
+
+static void envoyer_reservation(struct timespec now) {
+    envoyer(RESERVATION_STRUCTURE);
+    resa.essais++;
+    resa.echeance = dans(now, RESERVATION_DELAI_S);
+    changer_etat(RESA_DEMANDEE);
+}
+
+void reservation_demander(int structure_id) {
+    if (resa.etat != RESA_REPOS && resa.structure_id == structure_id) return;
+    if (resa.etat != RESA_REPOS) reservation_liberer();
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    resa.structure_id = structure_id;
+    resa.essais = 0;
+    // Une consigne reçue avant la demande ne peut pas y répondre
+    resa.derniere_consigne = get_consigne_last_update();
+    envoyer_reservation(now);
+}
+
+void reservation_liberer(void) {
+    if (resa.etat == RESA_REPOS) return;
+    envoyer(LIBERATION_STRUCTURE);
+    changer_etat(RESA_REPOS);
+}
+
+void reservation_nouvel_itineraire(void) {
+    if (resa.etat == RESA_ABANDONNEE) reservation_liberer();
+}
+
+void reservation_mettre_a_jour(struct timespec now) {
+    if (resa.etat == RESA_REPOS || resa.etat == RESA_ABANDONNEE) return;
+
+    struct timespec maj = get_consigne_last_update();
+    if (maj.tv_sec != resa.derniere_consigne.tv_sec || maj.tv_nsec != resa.derniere_consigne.tv_nsec) {
+        resa.derniere_consigne = maj;
+        Consigne c;
+        if (get_consigne(&c) == 0 && c.structure_id == resa.structure_id && resa.etat != RESA_ACCORDEE) {
+            resa.essais = 0;
+            if (c.autorisation == CONSIGNE_AUTORISATION) {
+                changer_etat(RESA_ACCORDEE);
+            } else {
+                resa.echeance = dans(now, RESERVATION_REESSAI_S);
+                changer_etat(RESA_EN_ATTENTE);
+            }
+        }
+    }
+
+    if (resa.etat == RESA_ACCORDEE || timespec_diff_s(resa.echeance, now) < 0.0) return;
+    if (resa.etat == RESA_DEMANDEE && resa.essais >= RESERVATION_ESSAIS_MAX) {
+        ERR(TAG, "Structure %d : pas de réponse du contrôleur après %d demandes, abandon",
+            resa.structure_id, resa.essais);
+        changer_etat(RESA_ABANDONNEE);
+        return;
+    }
+    envoyer_reservation(now);
+}
+
+EtatReservation reservation_etat(void) {
+    return resa.etat;
+}
+
+int reservation_structure_id(void) {
+    return resa.etat == RESA_REPOS ? -1 : resa.structure_id;
+}
@@ -0,0 +1,46 @@
+#ifndef RESERVATION_STRUCTURE_H
+#define RESERVATION_STRUCTURE_H
+
+#include <time.h>
+
+/*  Réservation d'une structure (pont) auprès du contrôleur routier, sans attente
+    bloquante. Machine à états pilotée par le thread de comportement :
+
+        REPOS --demander--> DEMANDEE --consigne AUTORISATION--> ACCORDEE --liberer--> REPOS
+                               |  ^
+          consigne ATTENTE     v  |  après RESERVATION_REESSAI_S
+                             EN_ATTENTE
+
+    Sans consigne RESERVATION_DELAI_S après l'envoi, la demande est renvoyée ;
+    au bout de RESERVATION_ESSAIS_MAX envois sans réponse elle est abandonnée
+    (ABANDONNEE) : les demandes suivantes pour la même structure sont ignorées
+    jusqu'à sa libération, une demande pour une autre structure ou un nouvel
+    itinéraire (reservation_nouvel_itineraire).
+    Les demandes sont publiées par set_demande() et envoyées au contrôleur si
+    la voiture est connectée.
+*/
+
+typedef enum {
+    RESA_REPOS = 0,
+    RESA_DEMANDEE,      // demande envoyée, consigne attendue
+    RESA_EN_ATTENTE,    // structure occupée, nouvelle demande programmée
+    RESA_ACCORDEE,
+    RESA_ABANDONNEE     // pas de réponse du contrôleur, plus de demande pour cette structure
+} EtatReservation;
+
+// Demande la structure ; sans effet si elle est déjà demandée, accordée ou abandonnée
+void reservation_demander(int structure_id);
+
+// Libère la structure réservée (ou annule la demande en cours)
+void reservation_liberer(void);
+
+// Lève l'abandon éventuel : le nouvel itinéraire peut redemander la structure
+void reservation_nouvel_itineraire(void);
+
+// Traite la dernière consigne reçue et les délais écoulés ; appelée à chaque cycle
+void reservation_mettre_a_jour(struct timespec now);
+
+EtatReservation reservation_etat(void);
+int reservation_structure_id(void);   // -1 au repos
+
+#endif
@@ -1,20 +1,24 @@
 // Fichier : voiture_evitement.c
-// Module minimal de réaction locale : stop / ralentir / contournement dans la voie
-// Dépendances : messages.h, voiture_globals.h
+// Module minimal de réaction locale : stop / ralentir / contournement (planificateur en treillis)
+// Dépendances : messages.h, voiture_globals.h (obstacles suivis, cf. SuiviObstacles),
+//               planificateur_treillis.h, annotation_itineraire.h, collision_boites.h
 
 #include <math.h>
 #include <string.h>
 #include <stdbool.h>
 #include "messages.h"
+#include "config.h"
 #include "voiture_globals.h"
+#include "annotation_itineraire.h"
+#include "planificateur_treillis.h"
+#include "collision_boites.h"
+#include "arbitrage_trajectoire.h"
 
 // -------------------- Paramètres simples (mm / mm.s-1) --------------------
 #define VITESSE_EVITEMENT   10    // mm/s
-#define LONGUEUR_VOITURE   240    // mm
-#define LARGEUR_VOITURE    140    // mm
+#define LARGEUR_VOITURE    LARGEUR_VOITURE_MM
 #define SECURITY_MARGE      50    // mm
 #define DISTANCE_STOP      100    // mm
-#define NB_PTS_TRAJ          4
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -26,41 +30,46 @@ static inline float hypot2f(float dx, float dy){ return sqrtf(dx*dx + dy*dy); }
 
 // ============================================================================
 // Fonction : lire_donnees_capteurs
-// Rôle     : Lire les données nécessaires (détection & position) via les globals.
+// Rôle     : Lire les données nécessaires (détection, pistes & position) via les globals.
 // Retour   : 0 si OK, <0 si indisponible.
 // ============================================================================
-static int lire_donnees_capteurs(DonneesDetection* det, PositionVoiture* pos) {
-    if (get_donnees_detection(det) != 0) return -1;
-    if (get_position(pos) != 0)          return -2;
+static int lire_donnees_capteurs(DetectionMonde* det, ObstaclesSuivis* suivis, PositionVoiture* pos) {
+    if (get_detection_monde(det) != 0)    return -1;
+    if (get_obstacles_suivis(suivis) != 0) return -1;
+    if (get_position(pos) != 0)           return -2;
     return 0;
 }
 
 // ============================================================================
 // Fonction : trajectoire_actuelle_permet_de_passer
-// Rôle     : Tester grossièrement si la trajectoire courante passe loin de l'obstacle.
-//            Critère simple : tous les points de la spline sont à > marge de l'obstacle.
+// Rôle     : Balayer l'emprise de la voiture (boîte orientée) le long de la
+//            trajectoire courante, depuis la position actuelle, contre la piste
+//            (prédite à vitesse constante) et la ligne de droite du marquage.
 // Retour   : true si ça passe ; false sinon (il faut réagir).
-// Remarque : on mesure par rapport au centre de l'obstacle (moyenne pointg/pointd).
+// Remarque : la ligne de gauche n'est pas testée : le planificateur peut
+//            emprunter la voie de gauche dans les zones de dépassement.
 // ============================================================================
-static bool trajectoire_actuelle_permet_de_passer(const Obstacle* obs_abs) {
+static bool trajectoire_actuelle_permet_de_passer(const PisteObstacle* piste,
+                                                  const PositionVoiture* pos,
+                                                  const MarquageSol* ms) {
     Trajectoire t;
-    if (get_trajectoire(&t) != 0 || t.nb_points <= 0) {
+    if (get_trajectoire(&t) != 0) return false;
+    if (t.nb_points <= 0) {
         // Pas de trajectoire: mieux vaut considérer qu'il faut en générer une
+        rendre_trajectoire(&t);
         return false;
     }
 
-    const float cx = 0.5f * (obs_abs->pointg.x + obs_abs->pointd.x);
-    const float cy = 0.5f * (obs_abs->pointg.y + obs_abs->pointd.y);
-    const float clearance = (LARGEUR_VOITURE * 0.5f) + SECURITY_MARGE;
+    ObstacleMobile obs[1 + MAX_POINTS_MARQUAGE];
+    obstacle_depuis_piste(piste, &obs[0]);
+    int nb = ajouter_ligne(ms->ligne_droite, ms->nb_points_droite, obs, 1, 1 + MAX_POINTS_MARQUAGE);
 
-    for (int i = 0; i < t.nb_points; ++i) {
-        float dx = (float)t.points[i].x - cx;
-        float dy = (float)t.points[i].y - cy;
-        if (hypot2f(dx, dy) < clearance) {
-            return false; // trop près : ne passe pas
-        }
-    }
-    return true;
+    float v = hypot2f(pos->vx, pos->vy);
+    CheminEchantillonne ch;
+    echantillonner_polyligne(pos->x, pos->y, t.points, t.nb_points, COLLISION_PAS_MM,
+                             v > VITESSE_EVITEMENT ? v : VITESSE_EVITEMENT, &ch);
+    rendre_trajectoire(&t);
+    return collision_chemin(&ch, SECURITY_MARGE, obs, nb) < 0;
 }
 
 // ============================================================================
@@ -80,258 +89,219 @@ static int evaluer_distance_obstacle_local(const Obstacle* obs_local) {
 }
 
 // ============================================================================
-// Fonction : convertir_obstacle_local_vers_absolu
-// Rôle     : Convertir les points de l'obstacle (repère voiture) vers repère global.
-// Effet    : Écrase obs_local -> obs_abs (écriture dans *obs_abs).
+// Fonction : convertir_piste_vers_local
+// Rôle     : Ramener une piste suivie (repère global) dans le repère voiture,
+//            inverse de la conversion faite par le suivi d'obstacles.
+// Effet    : Écrit *obs_local (type et points gauche/droite).
 // ============================================================================
-static void convertir_obstacle_local_vers_absolu(const Obstacle* obs_local,
-                                                 const PositionVoiture* pos,
-                                                 Obstacle* obs_abs)
+static void convertir_piste_vers_local(const PisteObstacle* piste,
+                                       const PositionVoiture* pos,
+                                       Obstacle* obs_local)
 {
     const float th = deg2rad(pos->theta);
     const float cg = cosf(th), sg = sinf(th);
 
+    obs_local->pointg = piste->pointg;
+    obs_local->pointd = piste->pointd;
+
     // Gauche
-    float xg = (float)obs_local->pointg.x;
-    float yg = (float)obs_local->pointg.y;
-    obs_abs->pointg.x = (int)lroundf(pos->x + xg * cg - yg * sg);
-    obs_abs->pointg.y = (int)lroundf(pos->y + xg * sg + yg * cg);
-    obs_abs->pointg.z = (int)lroundf(pos->z);
-    obs_abs->pointg.theta = pos->theta;
+    float dxg = piste->pointg.x - pos->x;
+    float dyg = piste->pointg.y - pos->y;
+    obs_local->pointg.x =  dxg * cg + dyg * sg;
+    obs_local->pointg.y = -dxg * sg + dyg * cg;
 
     // Droite
-    float xd = (float)obs_local->pointd.x;
-    float yd = (float)obs_local->pointd.y;
-    obs_abs->pointd.x = (int)lroundf(pos->x + xd * cg - yd * sg);
-    obs_abs->pointd.y = (int)lroundf(pos->y + xd * sg + yd * cg);
-    obs_abs->pointd.z = (int)lroundf(pos->z);
-    obs_abs->pointd.theta = pos->theta;
-
-    obs_abs->type = obs_local->type;
+    float dxd = piste->pointd.x - pos->x;
+    float dyd = piste->pointd.y - pos->y;
+    obs_local->pointd.x =  dxd * cg + dyd * sg;
+    obs_local->pointd.y = -dxd * sg + dyd * cg;
+
+    obs_local->type = piste->type;
 }
 
 // ============================================================================
-// Fonction : choisir_cote_contournement
-// Rôle     : Choisir le côté à passer (gauche = -1, droite = +1) selon la marge
-//            disponible vis-à-vis des bords de voie.
+// Fonction : lire_itineraire
+// Rôle     : Copie locale de l'itinéraire annoté, relue seulement quand il change
+//            (annoté ici s'il a été publié sans annotation).
+// Retour   : 0 si OK, <0 si pas d'itinéraire exploitable.
 // ============================================================================
-static int choisir_cote_contournement(const Obstacle* obs_abs, const MarquageSol* ms) {
-    if (ms->nb_points_gauche <= 0 || ms->nb_points_droite <= 0) return +1; // défaut : droite
-
-    Point bordG = ms->ligne_gauche[0];
-    Point bordD = ms->ligne_droite[0];
-
-    float mg = hypot2f((float)obs_abs->pointg.x - bordG.x, (float)obs_abs->pointg.y - bordG.y);
-    float md = hypot2f((float)obs_abs->pointd.x - bordD.x, (float)obs_abs->pointd.y - bordD.y);
-
-    // Plus de marge du côté gauche -> passer à gauche (-1), sinon à droite (+1)
-    return (mg > md) ? -1 : +1;
+static Itineraire iti;
+static AnnotationItineraire annotation;
+static struct timespec maj_iti;
+static bool iti_lu = false;
+
+static int lire_itineraire(void) {
+    struct timespec maj = get_itineraire_last_update();
+    if (!iti_lu || maj.tv_sec != maj_iti.tv_sec || maj.tv_nsec != maj_iti.tv_nsec) {
+        if (get_itineraire_annote(&iti, &annotation) != 0) return -1;
+        if (iti.nb_points > 1 && annotation.abscisse[iti.nb_points - 1] <= 0.0f)
+            annoter_itineraire(&iti, &annotation);
+        maj_iti = maj;
+        iti_lu = true;
+    }
+    return iti.nb_points >= 2 ? 0 : -1;
 }
 
 // ============================================================================
-// Fonction : contournement_est_possible
-// Rôle     : Vérifier qu'il reste au moins SECURITY_MARGE de part et d'autre entre
-//            l'obstacle et les bords ; sinon, contournement risqué.
+// Fonction : preparer_traj
+// Rôle     : Réserver le chemin partagé qui portera les points d'une trajectoire.
+// Retour   : ses points (MAX_POINTS_CHEMIN), NULL si aucun chemin n'est libre.
 // ============================================================================
-static bool contournement_est_possible(const Obstacle* obs_abs, const MarquageSol* ms) {
-    if (ms->nb_points_gauche <= 0 || ms->nb_points_droite <= 0) return false;
-
-    Point bordG = ms->ligne_gauche[0];
-    Point bordD = ms->ligne_droite[0];
-
-    float mg = hypot2f((float)obs_abs->pointg.x - bordG.x, (float)obs_abs->pointg.y - bordG.y);
-    float md = hypot2f((float)obs_abs->pointd.x - bordD.x, (float)obs_abs->pointd.y - bordD.y);
-
-    const float min_clear = SECURITY_MARGE + (LARGEUR_VOITURE * 0.5f);
-    return (mg > min_clear && md > min_clear);
+static Point* preparer_traj(Trajectoire* out) {
+    Point* points;
+    memset(out, 0, sizeof(*out));
+    out->chemin = reserver_chemin(&points);
+    return out->chemin >= 0 ? points : NULL;
 }
 
 // ============================================================================
 // Fonction : generer_traj_stop_ou_ralentir
 // Rôle     : Générer une petite trajectoire de stop (v=0) ou de ralentissement
 //            (v=VITESSE_EVITEMENT) dans l'axe courant.
+// Retour   : 0 si OK, -1 si aucun chemin partagé n'est libre.
 // ============================================================================
-static void generer_traj_stop_ou_ralentir(Trajectoire* out,
-                                          const PositionVoiture* pos,
-                                          bool stop)
+static int generer_traj_stop_ou_ralentir(Trajectoire* out,
+                                         const PositionVoiture* pos,
+                                         bool stop)
 {
-    memset(out, 0, sizeof(*out));
+    Point* pts = preparer_traj(out);
+    if (!pts) return -1;
     const float th = deg2rad(pos->theta);
     const float hx = cosf(th), hy = sinf(th);
 
-    out->nb_points = 2;
-    out->points[0].x = (int)lroundf(pos->x);
-    out->points[0].y = (int)lroundf(pos->y);
-    out->points[0].z = (int)lroundf(pos->z);
-    out->points[0].theta = pos->theta;
+    memset(pts, 0, 2 * sizeof(Point));
+    pts[0].x = (int)lroundf(pos->x);
+    pts[0].y = (int)lroundf(pos->y);
+    pts[0].z = (int)lroundf(pos->z);
+    pts[0].theta = pos->theta;
 
-    out->points[1].x = (int)lroundf(pos->x + 100.0f * hx);
-    out->points[1].y = (int)lroundf(pos->y + 100.0f * hy);
-    out->points[1].z = (int)lroundf(pos->z);
-    out->points[1].theta = pos->theta;
+    pts[1].x = (int)lroundf(pos->x + 100.0f * hx);
+    pts[1].y = (int)lroundf(pos->y + 100.0f * hy);
+    pts[1].z = (int)lroundf(pos->z);
+    pts[1].theta = pos->theta;
 
+    out->points      = pts;
+    out->nb_points   = 2;
+    out->horizon     = 100.0f;
     out->vitesse     = stop ? 0.0f : (float)VITESSE_EVITEMENT;
     out->vitesse_max = stop ? 0.0f : (float)(2 * VITESSE_EVITEMENT);
     out->arreter_fin = stop;
-}
-
-// ============================================================================
-// Fonction : generer_traj_contournement_dans_voie
-// Rôle     : Créer 4 points à l'intérieur du couloir (MarquageSol). On suit
-//            grossièrement la ligne centrale et on applique un décalage latéral
-//            "offset" vers le côté choisi (cote = -1 gauche, +1 droite).
-// ============================================================================
-static void generer_traj_contournement_dans_voie(Trajectoire* out,
-                                                 const MarquageSol* ms,
-                                                 int cote /* -1 gauche, +1 droite */)
-{
-    memset(out, 0, sizeof(*out));
-
-    // Sécurité : si pas assez de points de marquage, on fait simple et court
-    int n = ms->nb_points_gauche;
-    if (ms->nb_points_droite < n) n = ms->nb_points_droite;
-    if (n <= 0) {
-        out->nb_points = 0;
-        return;
-    }
-
-    out->nb_points = (n >= NB_PTS_TRAJ) ? NB_PTS_TRAJ : n;
-
-    for (int i = 0; i < out->nb_points; ++i) {
-        Point g = ms->ligne_gauche[i];
-        Point d = ms->ligne_droite[i];
-
-        // centre et vecteur latéral
-        float cx = 0.5f * (g.x + d.x);
-        float cy = 0.5f * (g.y + d.y);
-        float vx = (float)(d.x - g.x), vy = (float)(d.y - g.y);
-        float w  = hypot2f(vx, vy);
-        if (w < 1e-6f) w = 1.0f;
-        vx /= w; vy /= w;
-
-        // offset latéral limité pour rester dans la voie
-        float offset_max = 0.5f * w - SECURITY_MARGE - (LARGEUR_VOITURE * 0.5f);
-        if (offset_max < 0.0f) offset_max = 0.0f;
-        float offset = 0.3f * w;              // décale d'environ 30% de la voie
-        if (offset > offset_max) offset = offset_max;
-        offset *= (float)cote;                // signe du côté choisi
-
-        out->points[i].x = (int)lroundf(cx + offset * vx);
-        out->points[i].y = (int)lroundf(cy + offset * vy);
-        out->points[i].z = 0;
-        out->points[i].theta = 0.0f;          // simple : orientation non critique pour la spline
-    }
-
-    out->vitesse     = (float)VITESSE_EVITEMENT;
-    out->vitesse_max = (float)(2 * VITESSE_EVITEMENT);
-    out->arreter_fin = false;
+    return 0;
 }
 
 // ============================================================================
 // Fonction : publier_traj
-// Rôle     : Publier la trajectoire calculée au suiveur via les globals.
+// Rôle     : Proposer la trajectoire calculée à l'arbitrage (une nouvelle
+//            séquence par manœuvre), puis rendre le chemin réservé (la
+//            proposition garde le sien).
 // ============================================================================
-static void publier_traj(const Trajectoire* t) {
+static void publier_traj(const Trajectoire* t, PrioriteTrajectoire priorite) {
+    static unsigned int sequence = 0;
     if (t && t->nb_points >= 2) {
-        (void)set_trajectoire(t);
+        soumettre_trajectoire(PRODUCTEUR_EVITEMENT, t, priorite, ARBITRAGE_VALIDITE_EVITEMENT_S, ++sequence);
     }
+    if (t) rendre_chemin(t->chemin);
 }
 
 // ============================================================================
 // Fonction : voiture_evitement_main
 // Rôle     : Orchestration complète :
 //            0) si la trajectoire actuelle passe, ne rien faire,
-//            1) décider stop/ralentir selon distance locale,
-//            2) convertir obstacle en absolu,
-//            3) choisir côté & vérifier la faisabilité,
-//            4) générer la trajectoire de contournement dans la voie,
-//            5) publier.
+//            1) décider stop/ralentir selon distance locale (piste la plus proche),
+//            2) reprendre la piste en absolu,
+//            3) planifier le contournement (treillis de candidats sur l'itinéraire,
+//               voie voisine dans les zones de dépassement),
+//            4) proposer à l'arbitrage (cf. arbitrage_trajectoire.h).
 // Retour   : 0 si OK, <0 si problème / impossibilité.
 // ============================================================================
 int voiture_evitement_main(void)
 {
-    DonneesDetection det;
+    DetectionMonde   det;      // marquage déjà en repère monde (cf. SuiviObstacles)
+    ObstaclesSuivis  suivis;
     PositionVoiture  pos;
-    if (lire_donnees_capteurs(&det, &pos) < 0) return -1;
-    if (det.count <= 0) return 0;  // Pas d'obstacle détecté
+    if (lire_donnees_capteurs(&det, &suivis, &pos) < 0) return -1;
+    if (suivis.count <= 0) return 0;  // Pas d'obstacle confirmé
 
     // --- Filtrer pour garder UNIQUEMENT les voitures (OBSTACLE_VOITURE) ---
-    // Trouver la voiture la PLUS PROCHE (Y minimal en coordonnées locales)
+    // On travaille sur les pistes confirmées : une détection isolée sur une
+    // image ne déclenche rien. Trouver la voiture la PLUS PROCHE (Y local minimal)
     int nearest_car_idx = -1;
     float nearest_y = 1e9f;  // Grande valeur initiale
-    
-    for (int i = 0; i < det.count; i++) {
-        // Filtrer: garder uniquement les voitures
-        if (det.obstacle[i].type != OBSTACLE_VOITURE) continue;
-        
+    Obstacle obs_local;
+
+    for (int i = 0; i < suivis.count; i++) {
+        // Filtrer: garder uniquement les voitures encore suivies
+        if (suivis.piste[i].type != OBSTACLE_VOITURE) continue;
+        if (suivis.piste[i].etat == PISTE_TERMINEE) continue;
+
         // Calculer Y local (position devant la voiture)
-        float cy = 0.5f * (det.obstacle[i].pointg.y + det.obstacle[i].pointd.y);
-        
+        Obstacle candidat;
+        convertir_piste_vers_local(&suivis.piste[i], &pos, &candidat);
+        float cy = 0.5f * (candidat.pointg.y + candidat.pointd.y);
+
         // Ignorer les obstacles derrière (Y <= 0)
         if (cy <= 0.0f) continue;
-        
+
         // Garder la plus proche (Y minimal)
         if (cy < nearest_y) {
             nearest_y = cy;
             nearest_car_idx = i;
+            obs_local = candidat;
         }
     }
-    
+
     // Aucune voiture détectée devant nous
     if (nearest_car_idx < 0) return 0;
 
-    // --- Étape 1 : stop / ralentir (avec coordonnées locales IA) ---
-    // (On duplique l'obstacle pour garder la version "locale" utile ici)
-    Obstacle obs_local = det.obstacle[nearest_car_idx];  // Traiter la voiture la plus proche
+    // --- Étape 1 : stop / ralentir (avec coordonnées locales) ---
     int decision = evaluer_distance_obstacle_local(&obs_local);
     if (decision == 0) {
         Trajectoire t_stop;
-        generer_traj_stop_ou_ralentir(&t_stop, &pos, /*stop=*/true);
-        publier_traj(&t_stop);
+        if (generer_traj_stop_ou_ralentir(&t_stop, &pos, /*stop=*/true) != 0) return -1;
+        publier_traj(&t_stop, PRIORITE_URGENCE);
         return 0;
     }
     // decision == 1 -> on ralentit, et on prépare un éventuel contournement
     // decision == 2 -> rien de spécial, mais on peut quand même vérifier 0)
 
-    // --- Étape 2 : convertir obstacle en absolu pour s'aligner avec MarquageSol ---
-    Obstacle obs_abs;
-    convertir_obstacle_local_vers_absolu(&obs_local, &pos, &obs_abs);
+    // --- Étape 2 : la piste est déjà en absolu, comme le marquage de DetectionMonde ---
+    const PisteObstacle* piste = &suivis.piste[nearest_car_idx];
 
     // --- Étape 0 : si la trajectoire actuelle passe déjà, on ne touche à rien ---
-    if (trajectoire_actuelle_permet_de_passer(&obs_abs)) {
+    if (trajectoire_actuelle_permet_de_passer(piste, &pos, &det.marquage_sol)) {
         // Optionnel : si on veut quand même ralentir un peu en approche
         if (decision == 1) {
             Trajectoire t_slow;
-            generer_traj_stop_ou_ralentir(&t_slow, &pos, /*stop=*/false);
-            publier_traj(&t_slow);
+            if (generer_traj_stop_ou_ralentir(&t_slow, &pos, /*stop=*/false) != 0) return -1;
+            publier_traj(&t_slow, PRIORITE_EVITEMENT);
         }
         return 0;
     }
 
-    // --- Étape 3 : choisir côté + Étape 4 : vérifier faisabilité ---
-    int cote = choisir_cote_contournement(&obs_abs, &det.marquage_sol);
-    if (!contournement_est_possible(&obs_abs, &det.marquage_sol)) {
-        // Trop étroit -> stop propre
-        Trajectoire t_stop;
-        generer_traj_stop_ou_ralentir(&t_stop, &pos, /*stop=*/true);
-        publier_traj(&t_stop);
-        return -2;
+    // --- Étape 3 : planifier le contournement sur l'itinéraire ---
+    if (lire_itineraire() != 0) return -1;
+    Trajectoire t_contour;
+    Point* pts = preparer_traj(&t_contour);
+    if (!pts) return -1;
+    int ret = planifier_treillis(&iti, &annotation, &pos, (float)VITESSE_EVITEMENT, &suivis, &det,
+                                 pts, MAX_POINTS_CHEMIN, &t_contour, NULL);
+    if (ret < 0) {
+        rendre_chemin(t_contour.chemin);
+        return -1;
     }
+    t_contour.vitesse_max = (float)(2 * VITESSE_EVITEMENT);
 
-    // --- Étape 5 : générer la trajectoire de contournement dans la voie ---
-    Trajectoire t_contour;
-    generer_traj_contournement_dans_voie(&t_contour, &det.marquage_sol, cote);
-    if (t_contour.nb_points < 2) {
-        // Marquage indisponible -> prudence : stop
+    // Collision dès le premier échantillon : moins de deux points, que
+    // publier_traj() écarterait ; l'arrêt d'urgence est publié à la place
+    if (ret == 1 && t_contour.nb_points < 2) {
+        rendre_chemin(t_contour.chemin);
         Trajectoire t_stop;
-        generer_traj_stop_ou_ralentir(&t_stop, &pos, /*stop=*/true);
-        publier_traj(&t_stop);
-        return -3;
+        if (generer_traj_stop_ou_ralentir(&t_stop, &pos, /*stop=*/true) != 0) return -1;
+        publier_traj(&t_stop, PRIORITE_URGENCE);
+        return -2;
     }
 
-    // --- Étape 6 : publier ---
-    publier_traj(&t_contour);
-
-    // --- Étape 7 : OK ---
-    return 0;
-}
\ No newline at end of file
+    // --- Étape 4 : publier (tous les candidats bloqués -> arrêt avant la collision) ---
+    publier_traj(&t_contour, ret == 1 ? PRIORITE_URGENCE : PRIORITE_EVITEMENT);
+    return ret == 1 ? -2 : 0;
+}
@@ -17,16 +17,19 @@ extern "C" {
  * @brief Orchestration complète d'évitement.
  *
  * Étapes (résumé) :
- *  0) Si la trajectoire actuelle passe, ne rien faire (option : ralentir).
- *  1) Décider stop/ralentir selon la distance locale à l’obstacle.
- *  2) Convertir l’obstacle en repère absolu.
- *  3) Choisir le côté de contournement et vérifier la faisabilité.
- *  4) Générer la trajectoire et la publier.
+ *  0) Si la trajectoire actuelle passe (emprise balayée en boîtes orientées,
+ *     collision_boites.h), ne rien faire (option : ralentir).
+ *  1) Décider stop/ralentir selon la distance locale à la voiture suivie la plus proche.
+ *  2) Reprendre sa piste (SuiviObstacles) en repère absolu.
+ *  3) Planifier le contournement avec le planificateur en treillis
+ *     (planificateur_treillis.h) : pistes suivies, marquage en repère monde
+ *     (get_detection_monde), zones de dépassement de l'itinéraire annoté.
+ *  4) Proposer la trajectoire à l'arbitrage (arbitrage_trajectoire.h),
+ *     prioritaire sur la génération nominale.
  *
  * @return 0 si OK,
- *        -1 si données capteurs indisponibles,
- *        -2 si contournement impossible (trop étroit) → stop publié,
- *        -3 si marquage indisponible → stop publié.
+ *        -1 si données capteurs, itinéraire ou chemin partagé indisponibles,
+ *        -2 si tous les candidats sont bloqués → arrêt avant la collision publié.
  */
 int voiture_evitement_main(void);
 
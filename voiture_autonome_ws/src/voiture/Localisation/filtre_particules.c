@@ -0,0 +1,385 @@
+// filtre_particules.c
+#include "filtre_particules.h"
+#include "map_matching.h"
+#include "config.h"
+#include "logger.h"
+#include "utils.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+
+#define TAG "loc-pf"
+
+#define DEG2RAD(x) ((x) * (float)PI / 180.0f)
+#define RAD2DEG(x) ((x) * 180.0f / (float)PI)
+
+#define VRAISEMBLANCE_PLANCHER 1e-4f  // évite l'effondrement sur une mesure aberrante
+#define NB_CYCLES_KIDNAPPING 5
+
+typedef enum {
+    PHASE_CYCLE = 0,
+    PHASE_ARRET = 1
+} PhasePF;
+
+// Particules stockées en SoA : chaque travailleur parcourt des tableaux contigus
+static float px[PF_NB_PARTICULES];
+static float py[PF_NB_PARTICULES];
+static float ptheta[PF_NB_PARTICULES]; // rad
+static float pw[PF_NB_PARTICULES];
+// Tampons du rééchantillonnage
+static float rx[PF_NB_PARTICULES];
+static float ry[PF_NB_PARTICULES];
+static float rtheta[PF_NB_PARTICULES];
+
+typedef struct {
+    int debut, fin;
+    uint32_t graine;
+    // Sommes partielles, réduites par le thread appelant
+    double sw, swx, swy, swc, sws;
+} TravailleurPF;
+
+static struct {
+    float ds;          // mm parcourus depuis le cycle précédent
+    float dtheta;      // rad
+    bool mesure_mm;
+    float mx, my;
+    PhasePF phase;
+} commande;
+
+static TravailleurPF travailleurs[PF_MAX_THREADS];
+static pthread_t threads[PF_MAX_THREADS];
+static pthread_barrier_t barriere_debut, barriere_fin;
+static int nb_travailleurs = 0;
+static bool pf_init = false;
+
+// Les travailleurs n'entrent dans les barrières qu'une fois toutes les créations
+// tentées : les barrières sont alors dimensionnées au nombre réellement démarré
+static pthread_mutex_t lancement_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t lancement_cond = PTHREAD_COND_INITIALIZER;
+static bool lancement = false;
+
+static float angle_prec = 0.0f;
+static bool angle_prec_init = false;
+static int cycles_faible_vraisemblance = 0;
+static unsigned long mesures_mm_utilisees = 0;   // cycles pondérés par une mesure Marvelmind
+static uint32_t graine_principale = 0x9e3779b9u;
+
+// --- Générateurs pseudo-aléatoires (un état par travailleur, sans verrou) ---
+static inline uint32_t xorshift32(uint32_t* s) {
+    uint32_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *s = x;
+}
+
+static inline float uniforme(uint32_t* s) {
+    return (xorshift32(s) >> 8) * (1.0f / 16777216.0f);
+}
+
+static inline float gaussienne(uint32_t* s) {
+    float u1 = uniforme(s) + 1e-7f;
+    float u2 = uniforme(s);
+    return sqrtf(-2.0f * logf(u1)) * cosf(2.0f * (float)PI * u2);
+}
+
+// Distance de (x, y) à la ligne centrale la plus proche (INFINITY hors graphe)
+static float distance_route(const IndexSpatial* idx, float x, float y) {
+    const int* arcs;
+    int n = index_candidats(idx, x, y, &arcs);
+    float dmin = INFINITY;
+    for (int k = 0; k < n; k++) {
+        ProjectionArc p;
+        projeter_sur_arc(idx, arcs[k], x, y, &p);
+        float d = hypotf(x - (float)p.x, y - (float)p.y);
+        if (d < dmin) dmin = d;
+    }
+    return dmin;
+}
+
+// Propagation + pondération d'une tranche de particules
+static void traiter_tranche(TravailleurPF* t) {
+    const IndexSpatial* idx = map_matching_index();
+    const float inv_mm = 1.0f / (2.0f * PF_SIGMA_MARVELMIND * PF_SIGMA_MARVELMIND);
+    const float inv_route = 1.0f / (2.0f * PF_SIGMA_ROUTE * PF_SIGMA_ROUTE);
+    const float bruit_cap = DEG2RAD(PF_BRUIT_CAP);
+    const float bruit_ds = PF_BRUIT_DISTANCE * fabsf(commande.ds) + 1.0f;
+    double sw = 0.0, swx = 0.0, swy = 0.0, swc = 0.0, sws = 0.0;
+
+    for (int i = t->debut; i < t->fin; i++) {
+        float th = ptheta[i] + commande.dtheta + bruit_cap * gaussienne(&t->graine);
+        float ds = commande.ds + bruit_ds * gaussienne(&t->graine);
+        float c = cosf(th), s = sinf(th);
+        px[i] += ds * c;
+        py[i] += ds * s;
+        ptheta[i] = th;
+
+        float lw = 0.0f;
+        if (commande.mesure_mm) {
+            float dx = px[i] - commande.mx, dy = py[i] - commande.my;
+            lw -= (dx*dx + dy*dy) * inv_mm;
+        }
+        if (idx) {
+            float d = distance_route(idx, px[i], py[i]);
+            lw -= isfinite(d) ? d * d * inv_route : 20.0f;
+        }
+        float w = pw[i] * (expf(lw) + VRAISEMBLANCE_PLANCHER);
+        pw[i] = w;
+
+        sw += w;
+        swx += w * px[i];
+        swy += w * py[i];
+        swc += w * c;
+        sws += w * s;
+    }
+    t->sw = sw;
+    t->swx = swx;
+    t->swy = swy;
+    t->swc = swc;
+    t->sws = sws;
+}
+
+static void* boucle_travailleur(void* arg) {
+    TravailleurPF* t = (TravailleurPF*)arg;
+    pthread_mutex_lock(&lancement_mutex);
+    while (!lancement) pthread_cond_wait(&lancement_cond, &lancement_mutex);
+    pthread_mutex_unlock(&lancement_mutex);
+    while (1) {
+        pthread_barrier_wait(&barriere_debut);
+        if (commande.phase == PHASE_ARRET) break;
+        traiter_tranche(t);
+        pthread_barrier_wait(&barriere_fin);
+    }
+    return NULL;
+}
+
+// Rééchantillonnage systématique : un seul tirage, N pointeurs équidistants
+static void reechantillonner(double somme) {
+    const int n = PF_NB_PARTICULES;
+    const double pas = somme / n;
+    double u = uniforme(&graine_principale) * pas;
+    double cumul = pw[0];
+    int j = 0;
+    for (int i = 0; i < n; i++) {
+        while (u > cumul && j < n - 1) cumul += pw[++j];
+        rx[i] = px[j];
+        ry[i] = py[j];
+        rtheta[i] = ptheta[j];
+        u += pas;
+    }
+    memcpy(px, rx, sizeof(px));
+    memcpy(py, ry, sizeof(py));
+    memcpy(ptheta, rtheta, sizeof(ptheta));
+    for (int i = 0; i < n; i++) pw[i] = 1.0f;
+}
+
+void reinitialiser_filtre_particules(void) {
+    const IndexSpatial* idx = map_matching_index();
+    const Graph* g = map_matching_graph();
+    cycles_faible_vraisemblance = 0;
+
+    if (!idx || !g) {
+        // Sans graphe : nuage autour de l'origine, la mesure Marvelmind fera le reste
+        for (int i = 0; i < PF_NB_PARTICULES; i++) {
+            px[i] = 1000.0f * gaussienne(&graine_principale);
+            py[i] = 1000.0f * gaussienne(&graine_principale);
+            ptheta[i] = 2.0f * (float)PI * uniforme(&graine_principale);
+            pw[i] = 1.0f;
+        }
+        return;
+    }
+
+    // Tirage uniforme en abscisse curviligne sur l'ensemble du réseau
+    double longueur_totale = 0.0;
+    for (int a = 0; a < g->n_arcs; a++) longueur_totale += idx->geo[a].longueur;
+    for (int i = 0; i < PF_NB_PARTICULES; i++) {
+        double cible = uniforme(&graine_principale) * longueur_totale;
+        int a = 0;
+        while (a < g->n_arcs - 1 && cible > idx->geo[a].longueur) cible -= idx->geo[a++].longueur;
+        const GeometrieArc* geo = &idx->geo[a];
+        const Arc* arc = &g->arcs[a];
+        double x, y, cap;
+        if (geo->circulaire) {
+            double sens = geo->balayage >= 0.0 ? 1.0 : -1.0;
+            double phi = geo->angle_debut + sens * cible / geo->rayon;
+            x = arc->cx + geo->rayon * cos(phi);
+            y = arc->cy + geo->rayon * sin(phi);
+            cap = phi + sens * PI / 2.0;
+        } else {
+            double L = geo->longueur > 1e-9 ? geo->longueur : 1e-9;
+            double tx = (arc->v->x - arc->u->x) / L, ty = (arc->v->y - arc->u->y) / L;
+            x = arc->u->x + cible * tx;
+            y = arc->u->y + cible * ty;
+            cap = atan2(ty, tx);
+        }
+        px[i] = (float)x + PF_SIGMA_ROUTE * gaussienne(&graine_principale);
+        py[i] = (float)y + PF_SIGMA_ROUTE * gaussienne(&graine_principale);
+        ptheta[i] = (float)cap + DEG2RAD(10.0f) * gaussienne(&graine_principale);
+        pw[i] = 1.0f;
+    }
+}
+
+int init_filtre_particules(int nb_threads) {
+    if (pf_init) return 0;
+    if (nb_threads < 1) nb_threads = 1;
+    if (nb_threads > PF_MAX_THREADS) nb_threads = PF_MAX_THREADS;
+
+    nb_travailleurs = nb_threads;
+    commande.phase = PHASE_CYCLE;
+    lancement = false;
+
+    // Le travailleur 0 est le thread appelant
+    for (int k = 1; k < nb_travailleurs; k++) {
+        if (pthread_create(&threads[k], NULL, boucle_travailleur, &travailleurs[k]) != 0) {
+            ERR(TAG, "Impossible de créer le travailleur %d", k);
+            nb_travailleurs = k;
+            break;
+        }
+    }
+
+    // Tranches et barrières au nombre de travailleurs effectivement créés
+    for (int k = 0; k < nb_travailleurs; k++) {
+        travailleurs[k].debut = (int)((long)PF_NB_PARTICULES * k / nb_travailleurs);
+        travailleurs[k].fin = (int)((long)PF_NB_PARTICULES * (k + 1) / nb_travailleurs);
+        travailleurs[k].graine = 0x12345u + 7919u * (uint32_t)k;
+    }
+    pthread_barrier_init(&barriere_debut, NULL, nb_travailleurs);
+    pthread_barrier_init(&barriere_fin, NULL, nb_travailleurs);
+
+    pthread_mutex_lock(&lancement_mutex);
+    lancement = true;
+    pthread_cond_broadcast(&lancement_cond);
+    pthread_mutex_unlock(&lancement_mutex);
+
+    reinitialiser_filtre_particules();
+    angle_prec_init = false;
+    pf_init = true;
+    INFO(TAG, "Filtre particulaire : %d particules, %d travailleurs", PF_NB_PARTICULES, nb_travailleurs);
+    return 0;
+}
+
+void stop_filtre_particules(void) {
+    if (!pf_init) return;
+    commande.phase = PHASE_ARRET;
+    if (nb_travailleurs > 1) pthread_barrier_wait(&barriere_debut);
+    for (int k = 1; k < nb_travailleurs; k++)
+        pthread_join(threads[k], NULL);
+    pthread_barrier_destroy(&barriere_debut);
+    pthread_barrier_destroy(&barriere_fin);
+    pf_init = false;
+}
+
+PositionVoiture mettre_a_jour_filtre_particules(const SensorData* sdata, const MarvelmindPosition* mm, double dt) {
+    PositionVoiture est = {0};
+    if (!pf_init) return est;
+
+    // Odométrie : même modèle que calculer_odometrie(), le cap vient de l'angle MegaPi
+    float v = RAYON_ROUE * (sdata->vfiltre1 + sdata->vfiltre2) / 2.0f;
+    float dtheta = 0.0f;
+    if (angle_prec_init) {
+        dtheta = DEG2RAD(sdata->angle - angle_prec);
+        if (dtheta > PI) dtheta -= 2.0f * (float)PI;
+        if (dtheta < -PI) dtheta += 2.0f * (float)PI;
+    }
+    angle_prec = sdata->angle;
+    angle_prec_init = true;
+
+    commande.ds = v * (float)dt;
+    commande.dtheta = dtheta;
+    commande.mesure_mm = mm && mm->valid && mm->is_new;
+    if (commande.mesure_mm) {
+        commande.mx = mm->x;
+        commande.my = mm->y;
+        mesures_mm_utilisees++;
+    }
+
+    if (nb_travailleurs > 1) pthread_barrier_wait(&barriere_debut);
+    traiter_tranche(&travailleurs[0]);
+    if (nb_travailleurs > 1) pthread_barrier_wait(&barriere_fin);
+
+    double sw = 0.0, swx = 0.0, swy = 0.0, swc = 0.0, sws = 0.0;
+    for (int k = 0; k < nb_travailleurs; k++) {
+        sw += travailleurs[k].sw;
+        swx += travailleurs[k].swx;
+        swy += travailleurs[k].swy;
+        swc += travailleurs[k].swc;
+        sws += travailleurs[k].sws;
+    }
+    if (sw <= 0.0) {
+        reinitialiser_filtre_particules();
+        return est;
+    }
+
+    est.x = (float)(swx / sw);
+    est.y = (float)(swy / sw);
+    est.theta = RAD2DEG((float)atan2(sws, swc));
+    est.vx = v * cosf(DEG2RAD(est.theta));
+    est.vy = v * sinf(DEG2RAD(est.theta));
+
+    // Les poids valent 1 après chaque rééchantillonnage : sw/N est la vraisemblance moyenne
+    double neff_denominateur = 0.0;
+    for (int i = 0; i < PF_NB_PARTICULES; i++) neff_denominateur += (double)pw[i] * pw[i];
+    double neff = sw * sw / neff_denominateur;
+    bool reechantillonne = neff < PF_NB_PARTICULES / 2.0;
+    if (reechantillonne) {
+        double vraisemblance_moyenne = sw / PF_NB_PARTICULES;
+        reechantillonner(sw);
+        if (commande.mesure_mm && vraisemblance_moyenne < PF_VRAISEMBLANCE_KIDNAPPING) {
+            if (++cycles_faible_vraisemblance >= NB_CYCLES_KIDNAPPING) {
+                WARN(TAG, "Vraisemblance moyenne %.4f : relocalisation globale", vraisemblance_moyenne);
+                reinitialiser_filtre_particules();
+            }
+        } else {
+            cycles_faible_vraisemblance = 0;
+        }
+    } else {
+        // Renormalisation pour garder des poids de l'ordre de 1
+        float inv = (float)(PF_NB_PARTICULES / sw);
+        for (int i = 0; i < PF_NB_PARTICULES; i++) pw[i] *= inv;
+    }
+    return est;
+}
+
+#ifdef BENCH
+#define BENCH_PF_CYCLES 200
+
+void benchmark_filtre_particules(void) {
+    // Voiture à l'arrêt sur un noeud du graphe : le coût par cycle ne dépend pas du scénario.
+    // Mesure publiée et lue comme dans update_localisation_particules() : chaque
+    // nouvelle position doit atteindre la pondération, une seule fois
+    SensorData sdata = {0};
+    MarvelmindPosition mm = { .valid = true };
+    if (init_map_matching(MAP_NODES_FILE, MAP_ARCS_FILE) == 0) {
+        mm.x = map_matching_graph()->nodes[0].x;
+        mm.y = map_matching_graph()->nodes[0].y;
+    } else {
+        WARN(TAG, "Benchmark sans graphe routier");
+    }
+
+    for (int t = 1; t <= PF_MAX_THREADS; t++) {
+        init_filtre_particules(t);
+        struct timespec t0, t1;
+        unsigned long avant = mesures_mm_utilisees;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        for (int c = 0; c < BENCH_PF_CYCLES; c++) {
+            _set_marvelmind_position(mm);
+            MarvelmindPosition lu = get_marvelmind_position(true);
+            mettre_a_jour_filtre_particules(&sdata, &lu, 0.1);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        // Position déjà lue : un cycle de plus ne doit pas la réutiliser
+        MarvelmindPosition relu = get_marvelmind_position(true);
+        mettre_a_jour_filtre_particules(&sdata, &relu, 0.1);
+        unsigned long utilisees = mesures_mm_utilisees - avant;
+        if (utilisees != BENCH_PF_CYCLES)
+            ERR(TAG, "%lu mesures Marvelmind pour %d publiées ont pondéré les particules",
+                utilisees, BENCH_PF_CYCLES);
+        double dt = timespec_diff_s(t0, t1);
+        INFO(TAG, "%d thread(s) : %.2f ms/cycle, %.3g particules/s, %lu mesures Marvelmind utilisées", t,
+             1e3 * dt / BENCH_PF_CYCLES, (double)PF_NB_PARTICULES * BENCH_PF_CYCLES / dt, utilisees);
+        stop_filtre_particules();
+    }
+    stop_map_matching();
+}
+#endif
@@ -0,0 +1,28 @@
+// filtre_particules.h
+#ifndef FILTRE_PARTICULES_H
+#define FILTRE_PARTICULES_H
+
+#include <stdbool.h>
+#include "messages.h"
+#include "marvelmind_manager.h"
+
+// Démarre le pool de nb_threads travailleurs (thread appelant compris) et
+// initialise les particules uniformément le long du graphe routier.
+int init_filtre_particules(int nb_threads);
+void stop_filtre_particules(void);
+
+// Relocalisation globale (démarrage, kidnapping)
+void reinitialiser_filtre_particules(void);
+
+// Un cycle complet : propagation par l'odométrie (sdata), pondération par la mesure
+// Marvelmind (si valide et nouvelle) et la distance aux lignes centrales du graphe,
+// puis rééchantillonnage systématique si nécessaire.
+// Retourne l'estimation (moyenne pondérée) de la position.
+PositionVoiture mettre_a_jour_filtre_particules(const SensorData* sdata, const MarvelmindPosition* mm, double dt);
+
+#ifdef BENCH
+// Mesure le débit (particules/s) du filtre pour 1 à PF_MAX_THREADS travailleurs
+void benchmark_filtre_particules(void);
+#endif
+
+#endif
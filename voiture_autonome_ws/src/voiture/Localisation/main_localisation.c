@@ -7,6 +7,8 @@
 #include "logger.h"
 #include "marvelmind_manager.h"
 #include "localisation_fusion.h"
+#include "map_matching.h"
+#include "filtre_particules.h"
 #include "voiture_globals.h"
 #include "config.h"
 #include "utils.h"
@@ -21,6 +23,8 @@ bool running = false;
 PositionVoiture pos_globale = {0};
 PositionOdom odom_pos_estimee = {0};
 MarvelmindPosition mm_pos_estimee = {0};
+PositionCarte pos_carte = { .arc_id = -1 };
+struct timespec t_cycle_prec = {0};
 
 void update_localisation_ponderation() 
 {
@@ -48,12 +52,48 @@ void update_localisation_ponderation()
     pos_globale.vz = odom_pos_estimee.vz;
     pos_globale.theta = odom_pos_estimee.theta;
 
+    // --- Map-matching : arc le plus probable + recalage latéral ---
+    if (USE_MAP_MATCHING && map_matching_pret()) {
+        pos_carte = mettre_a_jour_map_matching(&pos_globale);
+        corriger_position_laterale(&pos_globale, &pos_carte);
+        set_position_carte(&pos_carte);
+    }
+
     // --- Mise à jour de la position globale partagée ---
     set_position(&pos_globale);
 
 }
 
 
+// Variante : filtre particulaire contraint par le graphe routier (USE_FILTRE_PARTICULES)
+void update_localisation_particules()
+{
+    struct timespec t_now;
+    clock_gettime(CLOCK_MONOTONIC, &t_now);
+    double dt = t_cycle_prec.tv_sec ? timespec_diff_s(t_cycle_prec, t_now) : 0.0;
+    t_cycle_prec = t_now;
+
+    SensorData sdata = {0};
+    get_sensor_data(&sdata);
+    mm_pos_estimee = get_marvelmind_position(true);
+    pos_globale = mettre_a_jour_filtre_particules(&sdata, USE_MARVELMIND ? &mm_pos_estimee : NULL, dt);
+
+    if (map_matching_pret()) {
+        pos_carte = mettre_a_jour_map_matching(&pos_globale);
+        set_position_carte(&pos_carte);
+    }
+    set_position(&pos_globale);
+}
+
+static void update_localisation()
+{
+    if (USE_FILTRE_PARTICULES)
+        update_localisation_particules();
+    else
+        update_localisation_ponderation();
+}
+
+
 void* lancer_localisation_thread(void* arg) {
     (void)arg;
     running = true;
@@ -70,21 +110,31 @@ void* lancer_localisation_thread(void* arg) {
         WARN(TAG, "Marvelmind désactivé (USE_MARVELMIND=0).");
     }
 
+    if ((USE_MAP_MATCHING || USE_FILTRE_PARTICULES) && init_map_matching(MAP_NODES_FILE, MAP_ARCS_FILE) != 0) {
+        WARN(TAG, "Map-matching désactivé (graphe indisponible).");
+    }
+    if (USE_FILTRE_PARTICULES)
+        init_filtre_particules(PF_NB_THREADS);
+
     while(running) {       
         #ifdef DEBUG_LOC
         struct timespec t_before, t_after;
         clock_gettime(CLOCK_MONOTONIC, &t_before);
-        update_localisation_ponderation();
+        update_localisation();
         clock_gettime(CLOCK_MONOTONIC, &t_after);
         double dt_exec = timespec_diff_s(t_before, t_after);
-        DBG(TAG, "Cycle localisation exécuté en %.7fs => x=%.1f y=%.1f (odom_pos_estimee θ=%.1f°, marvelmind valid=%d)",
-            dt_exec, pos_globale.x, pos_globale.y, odom_pos_estimee.theta, mm_pos_estimee.valid);
+        DBG(TAG, "Cycle localisation exécuté en %.7fs => x=%.1f y=%.1f (odom_pos_estimee θ=%.1f°, marvelmind valid=%d, arc=%d s=%.0f d_lat=%.0f)",
+            dt_exec, pos_globale.x, pos_globale.y, odom_pos_estimee.theta, mm_pos_estimee.valid,
+            pos_carte.arc_id, pos_carte.s, pos_carte.d_lat);
         #else
-        update_localisation_ponderation();
+        update_localisation();
         #endif
         my_sleep(LOCALISATION_DT);
     }
 
+    if (USE_FILTRE_PARTICULES)
+        stop_filtre_particules();
+    stop_map_matching();
     INFO(TAG, "Thread de localisation terminé.");
     return NULL;
 }
@@ -0,0 +1,188 @@
+// map_matching.c
+#include "map_matching.h"
+#include "config.h"
+#include "logger.h"
+#include "utils.h"
+#include <math.h>
+
+#define TAG "loc-map"
+
+#define MAX_CANDIDATS 16
+#define TAILLE_CELLULE_INDEX 200.0  // mm
+#define DEPLACEMENT_MIN 10.0f       // mm, en dessous on ne fait pas de transition
+#define COUT_SUCCESSEUR 1.0f        // coût (-log) de passage à un arc suivant
+#define COUT_SAUT 6.0f              // coût d'un changement d'arc non connexe
+#define COUT_RECUL 3.0f             // coût d'un recul notable sur le même arc
+#define TOLERANCE_RECUL 30.0f       // mm
+
+#define DEG2RAD(x) ((x) * PI / 180.0)
+#define RAD2DEG(x) ((x) * 180.0 / PI)
+
+typedef struct {
+    int arc_id;
+    float cout;     // -log probabilité cumulée (Viterbi)
+    ProjectionArc proj;
+} Candidat;
+
+static Graph* graph = NULL;
+static IndexSpatial* index_spatial = NULL;
+
+static Candidat precedents[MAX_CANDIDATS];
+static int nb_precedents = 0;
+static float x_prec = 0.0f, y_prec = 0.0f;
+static PositionCarte dernier_resultat = { .arc_id = -1 };
+
+int init_map_matching(const char* nodes_file, const char* arcs_file) {
+    if (graph) return 0;
+    graph = load_graph(nodes_file, arcs_file);
+    if (!graph) {
+        ERR(TAG, "Impossible de charger le graphe (%s, %s)", nodes_file, arcs_file);
+        return -1;
+    }
+    index_spatial = construire_index_spatial(graph, TAILLE_CELLULE_INDEX, MAP_MATCHING_DIST_MAX);
+    if (!index_spatial) {
+        ERR(TAG, "Impossible de construire l'index spatial");
+        free_graph(graph);
+        graph = NULL;
+        return -1;
+    }
+    INFO(TAG, "Graphe chargé : %d noeuds, %d arcs, grille %dx%d", graph->n_nodes, graph->n_arcs,
+         index_spatial->nx, index_spatial->ny);
+    return 0;
+}
+
+void stop_map_matching(void) {
+    free_index_spatial(index_spatial);
+    free_graph(graph);
+    index_spatial = NULL;
+    graph = NULL;
+    nb_precedents = 0;
+}
+
+bool map_matching_pret(void) {
+    return index_spatial != NULL;
+}
+
+const Graph* map_matching_graph(void) {
+    return graph;
+}
+
+const IndexSpatial* map_matching_index(void) {
+    return index_spatial;
+}
+
+static float ecart_angle(float a, float b) {
+    float d = fmodf(a - b, 2.0f * (float)PI);
+    if (d > PI) d -= 2.0f * (float)PI;
+    if (d < -PI) d += 2.0f * (float)PI;
+    return d;
+}
+
+static float cout_emission(const ProjectionArc* p, float cap_voiture) {
+    float el = (float)p->d_lat / MAP_MATCHING_SIGMA_LAT;
+    float ec = ecart_angle(cap_voiture, (float)p->cap) / (float)DEG2RAD(MAP_MATCHING_SIGMA_CAP);
+    return 0.5f * (el * el + ec * ec);
+}
+
+static bool est_successeur(int arc_a, int arc_b) {
+    const Node* v = graph->arcs[arc_a].v;
+    for (int k = 0; k < v->n_out_arcs; k++)
+        if (v->out_arcs[k]->id == arc_b) return true;
+    return false;
+}
+
+static float cout_transition(const Candidat* prec, const Candidat* cour) {
+    if (prec->arc_id == cour->arc_id)
+        return (cour->proj.s < prec->proj.s - TOLERANCE_RECUL) ? COUT_RECUL : 0.0f;
+    if (est_successeur(prec->arc_id, cour->arc_id))
+        return COUT_SUCCESSEUR;
+    return COUT_SAUT;
+}
+
+PositionCarte mettre_a_jour_map_matching(const PositionVoiture* pos) {
+    PositionCarte res = { .arc_id = -1 };
+    if (!index_spatial) return res;
+
+    float cap_voiture = (float)DEG2RAD(pos->theta);
+    float dx = pos->x - x_prec, dy = pos->y - y_prec;
+    bool transition = nb_precedents > 0 && (dx*dx + dy*dy) >= DEPLACEMENT_MIN * DEPLACEMENT_MIN;
+
+    // À l'arrêt, on garde l'arc courant et on met seulement la projection à jour
+    if (nb_precedents > 0 && !transition && dernier_resultat.arc_id >= 0) {
+        ProjectionArc p;
+        projeter_sur_arc(index_spatial, dernier_resultat.arc_id, pos->x, pos->y, &p);
+        dernier_resultat.s = (float)p.s;
+        dernier_resultat.d_lat = (float)p.d_lat;
+        dernier_resultat.cap_arc = (float)RAD2DEG(p.cap);
+        return dernier_resultat;
+    }
+
+    const int* arcs;
+    int n = index_candidats(index_spatial, pos->x, pos->y, &arcs);
+    Candidat courants[MAX_CANDIDATS];
+    int nb = 0;
+
+    for (int k = 0; k < n; k++) {
+        Candidat c = { .arc_id = arcs[k] };
+        projeter_sur_arc(index_spatial, c.arc_id, pos->x, pos->y, &c.proj);
+        float dist = hypotf(pos->x - (float)c.proj.x, pos->y - (float)c.proj.y);
+        if (dist > MAP_MATCHING_DIST_MAX) continue;
+
+        float emission = cout_emission(&c.proj, cap_voiture);
+        float meilleur = transition ? INFINITY : 0.0f;
+        for (int i = 0; transition && i < nb_precedents; i++) {
+            float t = precedents[i].cout + cout_transition(&precedents[i], &c);
+            if (t < meilleur) meilleur = t;
+        }
+        c.cout = meilleur + emission;
+
+        // On ne garde que les MAX_CANDIDATS moins coûteux
+        if (nb < MAX_CANDIDATS) {
+            courants[nb++] = c;
+        } else {
+            int pire = 0;
+            for (int i = 1; i < nb; i++)
+                if (courants[i].cout > courants[pire].cout) pire = i;
+            if (c.cout < courants[pire].cout) courants[pire] = c;
+        }
+    }
+
+    if (nb == 0) {
+        nb_precedents = 0;
+        dernier_resultat = res;
+        return res;
+    }
+
+    // Normalisation (évite la dérive des coûts cumulés) et confiance du meilleur
+    int best = 0;
+    for (int i = 1; i < nb; i++)
+        if (courants[i].cout < courants[best].cout) best = i;
+    float cout_min = courants[best].cout;
+    float somme = 0.0f;
+    for (int i = 0; i < nb; i++) {
+        courants[i].cout -= cout_min;
+        somme += expf(-courants[i].cout);
+    }
+
+    for (int i = 0; i < nb; i++)
+        precedents[i] = courants[i];
+    nb_precedents = nb;
+    x_prec = pos->x;
+    y_prec = pos->y;
+
+    res.arc_id = courants[best].arc_id;
+    res.s = (float)courants[best].proj.s;
+    res.d_lat = (float)courants[best].proj.d_lat;
+    res.cap_arc = (float)RAD2DEG(courants[best].proj.cap);
+    res.confiance = 1.0f / somme;
+    dernier_resultat = res;
+    return res;
+}
+
+void corriger_position_laterale(PositionVoiture* pos, const PositionCarte* pc) {
+    if (pc->arc_id < 0 || fabsf(pc->d_lat) > MAP_MATCHING_DIST_MAX) return;
+    float cap = (float)DEG2RAD(pc->cap_arc);
+    float correction = MAP_MATCHING_GAIN * pc->d_lat;
+    pos->x += correction * sinf(cap);
+    pos->y -= correction * cosf(cap);
+}
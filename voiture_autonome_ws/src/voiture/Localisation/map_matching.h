@@ -0,0 +1,30 @@
+// map_matching.h
+#ifndef MAP_MATCHING_H
+#define MAP_MATCHING_H
+
+#include <stdbool.h>
+#include "messages.h"
+#include "map.h"
+#include "map_index.h"
+
+// Charge le graphe routier et construit l'index spatial (retourne 0 si OK)
+int init_map_matching(const char* nodes_file, const char* arcs_file);
+void stop_map_matching(void);
+bool map_matching_pret(void);
+
+// Accès au graphe et à son index (NULL si non chargés), partagés avec les autres
+// modules de localisation
+const Graph* map_matching_graph(void);
+const IndexSpatial* map_matching_index(void);
+
+// Une étape de Viterbi en ligne : les arcs proches de la position sont les états
+// cachés, l'émission combine écart latéral et écart de cap, la transition favorise
+// le même arc ou un arc successeur dans le graphe.
+// Retourne l'arc le plus probable (arc_id = -1 si aucun candidat).
+PositionCarte mettre_a_jour_map_matching(const PositionVoiture* pos);
+
+// Recale la position sur la ligne centrale de l'arc associé (part MAP_MATCHING_GAIN
+// de l'écart latéral), sans toucher à la composante longitudinale.
+void corriger_position_laterale(PositionVoiture* pos, const PositionCarte* pc);
+
+#endif
@@ -699,6 +699,224 @@ static void process_generic_user_data(struct MarvelmindHedge * hedge, uint8_t *b
 
 ////////////////////////
 
+//////////////////////////////////////////////////////////////////////////////
+// Process one received byte (datagram state machine)
+// The receive state is kept in the hedge structure so that bytes can come
+// from the internal thread or from an external event loop
+//////////////////////////////////////////////////////////////////////////////
+static void processHedgeByte_ (struct MarvelmindHedge * hedge, uint8_t receivedChar)
+{
+    struct PositionValue curPosition;
+    uint8_t *input_buffer= hedge->recvBuffer_;
+    uint8_t recvState= hedge->recvState_;
+    uint8_t nBytesInBlockReceived= hedge->nBytesInBlockReceived_;
+    uint16_t dataId= hedge->recvDataId_;
+    uint8_t packetType= hedge->recvPacketType_;
+
+    memset(&curPosition, 0, sizeof(curPosition));
+    bool goodByte= false;
+    input_buffer[nBytesInBlockReceived]= receivedChar;
+    switch (recvState)
+    {
+    case RECV_HDR:
+        switch(nBytesInBlockReceived)
+        {
+            case 0:
+                goodByte= (receivedChar == 0xff);
+                break;
+            case 1:
+                packetType= receivedChar;
+                goodByte= (packetType == 0x47) || (packetType == 0x4a);
+                break;
+            case 2:
+                goodByte= true;
+                break;
+            case 3:
+                dataId= (((uint16_t) receivedChar)<<8) + input_buffer[2];
+
+                if (packetType == 0x47) {
+                    goodByte= (dataId == POSITION_DATAGRAM_ID) ||
+                              (dataId == BEACONS_POSITIONS_DATAGRAM_ID) ||
+                              (dataId == POSITION_DATAGRAM_HIGHRES_ID) ||
+                              (dataId == BEACONS_POSITIONS_DATAGRAM_HIGHRES_ID) ||
+                              (dataId == IMU_RAW_DATAGRAM_ID) ||
+                              (dataId == IMU_FUSION_DATAGRAM_ID) ||
+                              (dataId == BEACON_RAW_DISTANCE_DATAGRAM_ID) ||
+                              (dataId == TELEMETRY_DATAGRAM_ID) ||
+                              (dataId == QUALITY_DATAGRAM_ID) ||
+                              (dataId == NT_POSITION_DATAGRAM_HIGHRES_ID) ||
+                              (dataId == NT_IMU_RAW_DATAGRAM_ID) ||
+                              (dataId == NT_BEACON_RAW_DISTANCE_DATAGRAM_ID) ||
+                              (dataId == NT_IMU_FUSION_DATAGRAM_ID);
+                } else if (packetType == 0x4a) {
+                    goodByte= (dataId == WAYPOINT_DATAGRAM_ID) ||
+                              (dataId == GENERIC_USER_DATA_DATAGRAM_ID);
+                } else {
+                    goodByte= false;
+                }
+                break;
+            case 4:
+                switch(dataId )
+                {
+                    case POSITION_DATAGRAM_ID:
+                        goodByte= (receivedChar == 0x10);
+                        break;
+                    case BEACONS_POSITIONS_DATAGRAM_ID:
+                    case BEACONS_POSITIONS_DATAGRAM_HIGHRES_ID:
+                        goodByte= true;
+                        break;
+                    case POSITION_DATAGRAM_HIGHRES_ID:
+                        goodByte= (receivedChar == 0x16);
+                        break;
+                    case IMU_RAW_DATAGRAM_ID:
+								goodByte= (receivedChar == 0x20);
+                        break;
+                    case IMU_FUSION_DATAGRAM_ID:
+                        goodByte= (receivedChar == 0x2a);
+                        break;
+                    case BEACON_RAW_DISTANCE_DATAGRAM_ID:
+                        goodByte= (receivedChar == 0x20);
+                        break;
+                    case TELEMETRY_DATAGRAM_ID:
+                        goodByte= (receivedChar == 0x10);
+                        break;
+                    case QUALITY_DATAGRAM_ID:
+                        goodByte= (receivedChar == 0x10);
+                        break;
+                    case WAYPOINT_DATAGRAM_ID:
+                        goodByte= (receivedChar == 0x0c);
+                        break;
+                    case NT_POSITION_DATAGRAM_HIGHRES_ID:
+                    case NT_IMU_RAW_DATAGRAM_ID:
+                    case NT_BEACON_RAW_DISTANCE_DATAGRAM_ID:
+                    case NT_IMU_FUSION_DATAGRAM_ID:
+                    case GENERIC_USER_DATA_DATAGRAM_ID:
+                        goodByte= true;
+                        break;
+                }
+                if (goodByte)
+                    recvState=RECV_DGRAM;
+                break;
+        }
+        if (goodByte)
+        {
+            // correct header byte
+            nBytesInBlockReceived++;
+        }
+        else
+        {
+            // ...or incorrect
+            recvState=RECV_HDR;
+            nBytesInBlockReceived=0;
+        }
+        break;
+    case RECV_DGRAM:
+        nBytesInBlockReceived++;
+        if (nBytesInBlockReceived>=7+input_buffer[4])
+        {
+            // parse dgram
+            uint16_t blockCrc=
+                CalcCrcModbus_(input_buffer,nBytesInBlockReceived);
+            if (blockCrc==0)
+            {
+#if defined(WIN32) || defined(_WIN64)
+                EnterCriticalSection(&hedge->lock_);
+#else
+                pthread_mutex_lock (&hedge->lock_);
+#endif
+                switch(dataId )
+                {
+                    case POSITION_DATAGRAM_ID:
+                        // add to positionBuffer
+                        curPosition= process_position_datagram(hedge, input_buffer);
+                        break;
+                    case BEACONS_POSITIONS_DATAGRAM_ID:
+                        process_beacons_positions_datagram(hedge, input_buffer);
+                        break;
+                    case POSITION_DATAGRAM_HIGHRES_ID:
+                        // add to positionBuffer
+                        curPosition= process_position_highres_datagram(hedge, input_buffer);
+                        break;
+                    case NT_POSITION_DATAGRAM_HIGHRES_ID:
+                        curPosition= process_nt_position_highres_datagram(hedge, input_buffer);
+                        break;
+                    case BEACONS_POSITIONS_DATAGRAM_HIGHRES_ID:
+                        process_beacons_positions_highres_datagram(hedge, input_buffer);
+                        break;
+                    case IMU_RAW_DATAGRAM_ID:
+								process_imu_raw_datagram(hedge, input_buffer);
+                        break;
+                    case NT_IMU_RAW_DATAGRAM_ID:
+                        process_nt_imu_raw_datagram(hedge, input_buffer);
+                        break;
+                    case IMU_FUSION_DATAGRAM_ID:
+                        process_imu_fusion_datagram(hedge, input_buffer);
+                        break;
+                    case NT_IMU_FUSION_DATAGRAM_ID:
+                        process_nt_imu_fusion_datagram(hedge, input_buffer);
+                        break;
+                    case BEACON_RAW_DISTANCE_DATAGRAM_ID:
+                        process_raw_distances_datagram(hedge, input_buffer);
+                        break;
+                    case NT_BEACON_RAW_DISTANCE_DATAGRAM_ID:
+                        process_nt_raw_distances_datagram(hedge, input_buffer);
+                        break;
+                    case TELEMETRY_DATAGRAM_ID:
+                        process_telemetry_datagram(hedge, input_buffer);
+                        break;
+                    case QUALITY_DATAGRAM_ID:
+                        process_quality_datagram(hedge, input_buffer);
+                        break;
+                    case WAYPOINT_DATAGRAM_ID:
+                        process_waypoint_data(hedge, input_buffer);
+                        break;
+                    case GENERIC_USER_DATA_DATAGRAM_ID:
+                        process_generic_user_data(hedge, input_buffer);
+                        break;
+                }
+#if defined(WIN32) || defined(_WIN64)
+                LeaveCriticalSection(&hedge->lock_);
+#else
+                pthread_mutex_unlock (&hedge->lock_);
+#endif
+                // callback
+                if (hedge->anyInputPacketCallback)
+                {
+                   hedge->anyInputPacketCallback();
+                }
+
+                if (hedge->receiveDataCallback)
+                {
+                    if (dataId == POSITION_DATAGRAM_ID)
+                    {
+                        hedge->receiveDataCallback (curPosition);
+                    }
+                }
+            }
+            // and repeat
+            recvState=RECV_HDR;
+            nBytesInBlockReceived=0;
+        }
+    }
+
+    hedge->recvState_= recvState;
+    hedge->nBytesInBlockReceived_= nBytesInBlockReceived;
+    hedge->recvDataId_= dataId;
+    hedge->recvPacketType_= packetType;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Feed bytes read from the serial port by an external event loop
+//////////////////////////////////////////////////////////////////////////////
+void processMarvelmindHedgeBytes (struct MarvelmindHedge * hedge, const uint8_t *data, size_t n)
+{size_t i;
+
+    for(i=0;i<n;i++)
+        processHedgeByte_(hedge, data[i]);
+}
+
+////////////////////////
+
 void
 #if (!defined(WIN32)) && (!defined(_WIN64))
 *
@@ -706,11 +924,6 @@ void
 Marvelmind_Thread_ (void* param)
 {
     struct MarvelmindHedge * hedge=(struct MarvelmindHedge*) param;
-    struct PositionValue curPosition;
-    uint8_t input_buffer[256];
-    uint8_t recvState=RECV_HDR; // current state of receive data
-    uint8_t nBytesInBlockReceived=0; // bytes received
-    uint16_t dataId;
 #if (!defined(WIN32)) && (!defined(_WIN64))
     struct pollfd fds[1];
     int pollrc;
@@ -725,7 +938,6 @@ Marvelmind_Thread_ (void* param)
     while (hedge->terminationRequired==false)
     {
         uint8_t receivedChar;
-        uint8_t packetType;
         bool readSuccessed=true;
 #if defined(WIN32) || defined(_WIN64)
         DWORD nBytesRead;
@@ -764,192 +976,7 @@ Marvelmind_Thread_ (void* param)
         if (nBytesRead<0) readSuccessed=false;
 #endif
         if (nBytesRead && readSuccessed)
-        {
-            bool goodByte= false;
-            input_buffer[nBytesInBlockReceived]= receivedChar;
-            switch (recvState)
-            {
-            case RECV_HDR:
-                switch(nBytesInBlockReceived)
-                {
-                    case 0:
-                        goodByte= (receivedChar == 0xff);
-                        break;
-                    case 1:
-                        packetType= receivedChar;
-                        goodByte= (packetType == 0x47) || (packetType == 0x4a);
-                        break;
-                    case 2:
-                        goodByte= true;
-                        break;
-                    case 3:
-                        dataId= (((uint16_t) receivedChar)<<8) + input_buffer[2];
-
-                        if (packetType == 0x47) {
-                            goodByte= (dataId == POSITION_DATAGRAM_ID) ||
-                                      (dataId == BEACONS_POSITIONS_DATAGRAM_ID) ||
-                                      (dataId == POSITION_DATAGRAM_HIGHRES_ID) ||
-                                      (dataId == BEACONS_POSITIONS_DATAGRAM_HIGHRES_ID) ||
-                                      (dataId == IMU_RAW_DATAGRAM_ID) ||
-                                      (dataId == IMU_FUSION_DATAGRAM_ID) ||
-                                      (dataId == BEACON_RAW_DISTANCE_DATAGRAM_ID) ||
-                                      (dataId == TELEMETRY_DATAGRAM_ID) ||
-                                      (dataId == QUALITY_DATAGRAM_ID) ||
-                                      (dataId == NT_POSITION_DATAGRAM_HIGHRES_ID) ||
-                                      (dataId == NT_IMU_RAW_DATAGRAM_ID) ||
-                                      (dataId == NT_BEACON_RAW_DISTANCE_DATAGRAM_ID) ||
-                                      (dataId == NT_IMU_FUSION_DATAGRAM_ID);
-                        } else if (packetType == 0x4a) {
-                            goodByte= (dataId == WAYPOINT_DATAGRAM_ID) ||
-                                      (dataId == GENERIC_USER_DATA_DATAGRAM_ID);
-                        } else {
-                            goodByte= false;
-                        }
-                        break;
-                    case 4:
-                        switch(dataId )
-                        {
-                            case POSITION_DATAGRAM_ID:
-                                goodByte= (receivedChar == 0x10);
-                                break;
-                            case BEACONS_POSITIONS_DATAGRAM_ID:
-                            case BEACONS_POSITIONS_DATAGRAM_HIGHRES_ID:
-                                goodByte= true;
-                                break;
-                            case POSITION_DATAGRAM_HIGHRES_ID:
-                                goodByte= (receivedChar == 0x16);
-                                break;
-                            case IMU_RAW_DATAGRAM_ID:
-								goodByte= (receivedChar == 0x20);
-                                break;
-                            case IMU_FUSION_DATAGRAM_ID:
-                                goodByte= (receivedChar == 0x2a);
-                                break;
-                            case BEACON_RAW_DISTANCE_DATAGRAM_ID:
-                                goodByte= (receivedChar == 0x20);
-                                break;
-                            case TELEMETRY_DATAGRAM_ID:
-                                goodByte= (receivedChar == 0x10);
-                                break;
-                            case QUALITY_DATAGRAM_ID:
-                                goodByte= (receivedChar == 0x10);
-                                break;
-                            case WAYPOINT_DATAGRAM_ID:
-                                goodByte= (receivedChar == 0x0c);
-                                break;
-                            case NT_POSITION_DATAGRAM_HIGHRES_ID:
-                            case NT_IMU_RAW_DATAGRAM_ID:
-                            case NT_BEACON_RAW_DISTANCE_DATAGRAM_ID:
-                            case NT_IMU_FUSION_DATAGRAM_ID:
-                            case GENERIC_USER_DATA_DATAGRAM_ID:
-                                goodByte= true;
-                                break;
-                        }
-                        if (goodByte)
-                            recvState=RECV_DGRAM;
-                        break;
-                }
-                if (goodByte)
-                {
-                    // correct header byte
-                    nBytesInBlockReceived++;
-                }
-                else
-                {
-                    // ...or incorrect
-                    recvState=RECV_HDR;
-                    nBytesInBlockReceived=0;
-                }
-                break;
-            case RECV_DGRAM:
-                nBytesInBlockReceived++;
-                if (nBytesInBlockReceived>=7+input_buffer[4])
-                {
-                    // parse dgram
-                    uint16_t blockCrc=
-                        CalcCrcModbus_(input_buffer,nBytesInBlockReceived);
-                    if (blockCrc==0)
-                    {
-#if defined(WIN32) || defined(_WIN64)
-                        EnterCriticalSection(&hedge->lock_);
-#else
-                        pthread_mutex_lock (&hedge->lock_);
-#endif
-                        switch(dataId )
-                        {
-                            case POSITION_DATAGRAM_ID:
-                                // add to positionBuffer
-                                curPosition= process_position_datagram(hedge, input_buffer);
-                                break;
-                            case BEACONS_POSITIONS_DATAGRAM_ID:
-                                process_beacons_positions_datagram(hedge, input_buffer);
-                                break;
-                            case POSITION_DATAGRAM_HIGHRES_ID:
-                                // add to positionBuffer
-                                curPosition= process_position_highres_datagram(hedge, input_buffer);
-                                break;
-                            case NT_POSITION_DATAGRAM_HIGHRES_ID:
-                                curPosition= process_nt_position_highres_datagram(hedge, input_buffer);
-                                break;
-                            case BEACONS_POSITIONS_DATAGRAM_HIGHRES_ID:
-                                process_beacons_positions_highres_datagram(hedge, input_buffer);
-                                break;
-                            case IMU_RAW_DATAGRAM_ID:
-								process_imu_raw_datagram(hedge, input_buffer);
-                                break;
-                            case NT_IMU_RAW_DATAGRAM_ID:
-                                process_nt_imu_raw_datagram(hedge, input_buffer);
-                                break;
-                            case IMU_FUSION_DATAGRAM_ID:
-                                process_imu_fusion_datagram(hedge, input_buffer);
-                                break;
-                            case NT_IMU_FUSION_DATAGRAM_ID:
-                                process_nt_imu_fusion_datagram(hedge, input_buffer);
-                                break;
-                            case BEACON_RAW_DISTANCE_DATAGRAM_ID:
-                                process_raw_distances_datagram(hedge, input_buffer);
-                                break;
-                            case NT_BEACON_RAW_DISTANCE_DATAGRAM_ID:
-                                process_nt_raw_distances_datagram(hedge, input_buffer);
-                                break;
-                            case TELEMETRY_DATAGRAM_ID:
-                                process_telemetry_datagram(hedge, input_buffer);
-                                break;
-                            case QUALITY_DATAGRAM_ID:
-                                process_quality_datagram(hedge, input_buffer);
-                                break;
-                            case WAYPOINT_DATAGRAM_ID:
-                                process_waypoint_data(hedge, input_buffer);
-                                break;
-                            case GENERIC_USER_DATA_DATAGRAM_ID:
-                                process_generic_user_data(hedge, input_buffer);
-                                break;
-                        }
-#if defined(WIN32) || defined(_WIN64)
-                        LeaveCriticalSection(&hedge->lock_);
-#else
-                        pthread_mutex_unlock (&hedge->lock_);
-#endif
-                        // callback
-                        if (hedge->anyInputPacketCallback)
-                        {
-                           hedge->anyInputPacketCallback();
-                        }
-
-                        if (hedge->receiveDataCallback)
-                        {
-                            if (dataId == POSITION_DATAGRAM_ID)
-                            {
-                                hedge->receiveDataCallback (curPosition);
-                            }
-                        }
-                    }
-                    // and repeat
-                    recvState=RECV_HDR;
-                    nBytesInBlockReceived=0;
-                }
-            }
-        }
+            processHedgeByte_(hedge, receivedChar);
     }
 #if (!defined(WIN32)) && (!defined(_WIN64))
     return NULL;
@@ -975,6 +1002,12 @@ struct MarvelmindHedge * createMarvelmindHedge ()
         hedge->lastValues_next= 0;
         hedge->haveNewValues_=false;
         hedge->terminationRequired= false;
+        hedge->threadStarted_= false;
+
+        hedge->recvState_= RECV_HDR;
+        hedge->nBytesInBlockReceived_= 0;
+        hedge->recvDataId_= 0;
+        hedge->recvPacketType_= 0;
 
         hedge->rawIMU.updated= false;
         hedge->fusionIMU.updated= false;
@@ -1005,7 +1038,7 @@ static int timezone_offset() {
     return lt->tm_mon ? unaligned - 24*60*60 : unaligned;
 }
 
-void startMarvelmindHedge (struct MarvelmindHedge * hedge)
+static bool prepareMarvelmindHedge_ (struct MarvelmindHedge * hedge)
 {uint8_t i;
 
     hedge->positionBuffer=
@@ -1014,7 +1047,7 @@ void startMarvelmindHedge (struct MarvelmindHedge * hedge)
     {
         if (hedge->verbose) puts ("Not enough memory");
         hedge->terminationRequired=true;
-        return;
+        return false;
     }
     for(i=0;i<MAX_BUFFERED_POSITIONS;i++)
     {
@@ -1029,13 +1062,39 @@ void startMarvelmindHedge (struct MarvelmindHedge * hedge)
 
     hedge->timeOffset= timezone_offset();
     //printf("TZ= %d\r\n",(int) hedge->timeOffset);
+    return true;
+}
+
+void startMarvelmindHedge (struct MarvelmindHedge * hedge)
+{
+    if (!prepareMarvelmindHedge_(hedge)) return;
 
 #if defined(WIN32) || defined(_WIN64)
     _beginthread (Marvelmind_Thread_, 0, hedge);
 #else
     pthread_create (&hedge->thread_, NULL, Marvelmind_Thread_, hedge);
 #endif
+    hedge->threadStarted_= true;
+}
+
+#if (!defined(WIN32)) && (!defined(_WIN64))
+//////////////////////////////////////////////////////////////////////////////
+// Initialize without starting the work thread: the caller reads the returned
+// serial port and passes the bytes to processMarvelmindHedgeBytes
+// returncode: file descriptor of the opened port or -1 on error
+//////////////////////////////////////////////////////////////////////////////
+int openMarvelmindHedgePort (struct MarvelmindHedge * hedge)
+{
+    if (!prepareMarvelmindHedge_(hedge)) return -1;
+
+    int ttyHandle=OpenSerialPort_(hedge->ttyFileName,
+                                  hedge->baudRate, hedge->verbose);
+    if (ttyHandle==PORT_NOT_OPENED) hedge->terminationRequired=true;
+    else if (hedge->verbose) printf ("Opened serial port %s with baudrate %u\n",
+                                         hedge->ttyFileName, hedge->baudRate);
+    return ttyHandle;
 }
+#endif
 
 //////////////////////////////////////////////////////////////////////////////
 // Write average position coordinates
@@ -1588,6 +1647,7 @@ void stopMarvelmindHedge (struct MarvelmindHedge * hedge)
 {
     hedge->terminationRequired=true;
     if (hedge->verbose) puts ("stopping");
+    if (!hedge->threadStarted_) return;
 #if defined(WIN32) || defined(_WIN64)
     WaitForSingleObject (hedge->thread_, INFINITE);
 #else
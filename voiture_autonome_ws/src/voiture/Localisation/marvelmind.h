@@ -201,6 +201,13 @@ struct MarvelmindHedge
     uint8_t lastValuesCount_;
     uint8_t lastValues_next;
     bool haveNewValues_;
+    bool threadStarted_;
+// receive state machine
+    uint8_t recvBuffer_[256];
+    uint8_t recvState_;
+    uint8_t nBytesInBlockReceived_;
+    uint16_t recvDataId_;
+    uint8_t recvPacketType_;
 #if defined(WIN32) || defined(_WIN64)
     HANDLE thread_;
     CRITICAL_SECTION lock_;
@@ -229,6 +236,9 @@ struct MarvelmindHedge
 struct MarvelmindHedge * createMarvelmindHedge ();
 void destroyMarvelmindHedge (struct MarvelmindHedge * hedge);
 void startMarvelmindHedge (struct MarvelmindHedge * hedge);
+// Without work thread (external event loop): open port, then feed bytes
+int openMarvelmindHedgePort (struct MarvelmindHedge * hedge);
+void processMarvelmindHedgeBytes (struct MarvelmindHedge * hedge, const uint8_t *data, size_t n);
 
 void printPositionFromMarvelmindHedge (struct MarvelmindHedge * hedge,
                                        bool onlyNew);
@@ -12,6 +12,10 @@
 #include <time.h>
 #include "marvelmind.h"
 #include "marvelmind_manager.h"
+#include "multilateration.h"
+#include "voiture_globals.h"
+#include "config.h"
+#include "reacteur.h"
 
 #define TAG "loc-marvelmind"
 #define RECONNECT_DELAY_SEC 5
@@ -28,6 +32,17 @@ static pthread_cond_t pos_cond = PTHREAD_COND_INITIALIZER;
 
 static MarvelmindPosition current_position = {0};
 struct MarvelmindHedge *hedge;
+static int fd_marvelmind = -1;  // port lu par le réacteur (USE_REACTEUR)
+
+#if USE_MULTILATERATION
+static int64_t last_raw_timestamp = 0;
+static struct timespec last_multilat = {0, 0};
+static ResultatMultilateration last_solution = {0};
+#ifdef DEBUG_LOC
+static double multilat_total_us = 0.0;
+static long multilat_count = 0;
+#endif
+#endif
 
 // ===========================
 // Thread principal
@@ -35,19 +50,120 @@ struct MarvelmindHedge *hedge;
 
 static void positionCallback(struct PositionValue position) {
     pthread_mutex_lock(&pos_mutex);
+#if USE_MULTILATERATION
+    // La solution du modem ne sert que de secours si la multilatération locale est muette
+    struct timespec t_now;
+    clock_gettime(CLOCK_MONOTONIC, &t_now);
+    if (last_multilat.tv_sec != 0 && timespec_diff_s(last_multilat, t_now) < MULTILAT_FALLBACK_S) {
+        pthread_mutex_unlock(&pos_mutex);
+        return;
+    }
+#endif
     current_position.x = (float) position.x;
     current_position.y = (float) position.y;
     current_position.z = (float) position.z;
-    clock_gettime(CLOCK_REALTIME, &current_position.t);
+    clock_gettime(CLOCK_MONOTONIC, &current_position.t);
+    current_position.valid = true;
+    current_position.is_new = true;
+    pthread_mutex_unlock(&pos_mutex);
+    pthread_cond_broadcast(&pos_cond);
+}
+
+#if USE_MULTILATERATION
+// Appelé par le thread Marvelmind après chaque paquet : on ne traite que
+// les nouveaux paquets de distances brutes, dès leur arrivée.
+static void rawDistancesCallback() {
+    struct RawDistances raw;
+    struct StationaryBeaconsPositions beacons;
+
+    getRawDistancesFromMarvelmindHedge(hedge, &raw);
+    if (!raw.updated || raw.timestamp.timestamp64 == last_raw_timestamp)
+        return;
+    last_raw_timestamp = raw.timestamp.timestamp64;
+    getStationaryBeaconsPositionsFromMarvelmindHedge(hedge, &beacons);
+
+    BaliseFixe balises[MULTILAT_MAX_BALISES];
+    float distances[MULTILAT_MAX_BALISES];
+    float cx = 0.0f, cy = 0.0f;
+    int n = 0;
+    for (int i = 0; i < MULTILAT_MAX_BALISES; i++) {
+        const struct RawDistanceItem* item = &raw.distances[i];
+        distances[i] = 0.0f;
+        if (item->address_beacon == 0 || item->distance == 0) continue;
+        for (int j = 0; j < beacons.numBeacons; j++) {
+            if (beacons.beacons[j].address != item->address_beacon) continue;
+            balises[i].x = (float) beacons.beacons[j].x;
+            balises[i].y = (float) beacons.beacons[j].y;
+            balises[i].z = (float) beacons.beacons[j].z;
+            distances[i] = (float) item->distance;
+            cx += balises[i].x;
+            cy += balises[i].y;
+            n++;
+            break;
+        }
+    }
+    if (n < 3) return;
+
+    // Démarrage à chaud depuis la position fusionnée, sinon dernière solution ou barycentre
+    float x0 = cx / n, y0 = cy / n;
+    PositionVoiture pos;
+    struct timespec t_pos = get_position_last_update();
+    if ((t_pos.tv_sec != 0 || t_pos.tv_nsec != 0) && get_position(&pos) == 0) {
+        x0 = pos.x;
+        y0 = pos.y;
+    } else if (last_solution.valid) {
+        x0 = last_solution.x;
+        y0 = last_solution.y;
+    }
+
+#ifdef DEBUG_LOC
+    struct timespec t_before, t_after;
+    clock_gettime(CLOCK_MONOTONIC, &t_before);
+#endif
+    ResultatMultilateration sol = resoudre_multilateration(balises, distances, MULTILAT_MAX_BALISES,
+                                                           x0, y0, MARVELMIND_HAUTEUR_HEDGE);
+#ifdef DEBUG_LOC
+    clock_gettime(CLOCK_MONOTONIC, &t_after);
+    multilat_total_us += timespec_diff_s(t_before, t_after) * 1e6;
+    multilat_count++;
+    DBG(TAG, "Multilatération en %d itérations (rms=%.1f mm, rejet=%d), moyenne %.2f µs/résolution",
+        sol.iterations, sol.rms, sol.rejetee, multilat_total_us / multilat_count);
+#endif
+    if (!sol.valid) {
+        DBG(TAG, "Multilatération rejetée (rms=%.1f mm, %d balises)", sol.rms, sol.nb_utilisees);
+        return;
+    }
+    last_solution = sol;
+
+    pthread_mutex_lock(&pos_mutex);
+    current_position.x = sol.x;
+    current_position.y = sol.y;
+    current_position.z = sol.z;
+    clock_gettime(CLOCK_MONOTONIC, &current_position.t);
+    last_multilat = current_position.t;
     current_position.valid = true;
     current_position.is_new = true;
     pthread_mutex_unlock(&pos_mutex);
     pthread_cond_broadcast(&pos_cond);
 }
+#endif
 
 
 
 
+// Variante réacteur : le port est lisible, on passe les octets à la bibliothèque
+static void gestionnaire_marvelmind(int fd, uint32_t evenements, void* ctx) {
+    (void)ctx;
+    uint8_t buf[256];
+    ssize_t n = read(fd, buf, sizeof(buf));
+    if (n > 0) {
+        processMarvelmindHedgeBytes(hedge, buf, (size_t)n);
+    } else if (evenements & REACTEUR_ERREUR) {
+        WARN(TAG, "Port Marvelmind fermé");
+        reacteur_retirer_fd(fd);
+    }
+}
+
 // ===========================
 // Fonctions publiques
 // ===========================
@@ -82,7 +198,22 @@ int lancer_marvelmind() {
     #endif
     hedge->terminationRequired = false;
     hedge->receiveDataCallback = positionCallback; // a definir
+#if USE_MULTILATERATION
+    hedge->anyInputPacketCallback = rawDistancesCallback;
+#endif
 
+    if (USE_REACTEUR && reacteur_actif()) {
+        fd_marvelmind = openMarvelmindHedgePort(hedge);
+        if (fd_marvelmind < 0 || reacteur_ajouter_fd(fd_marvelmind, gestionnaire_marvelmind, NULL) != 0) {
+            // Comme en mode thread : pas de position, mais la localisation continue
+            if (fd_marvelmind >= 0) close(fd_marvelmind);
+            fd_marvelmind = -1;
+            WARN(TAG, "Port Marvelmind %s indisponible.", marvelmind_port);
+            return 0;
+        }
+        INFO(TAG, "Marvelmind confié au réacteur sur %s.", marvelmind_port);
+        return 0;
+    }
     startMarvelmindHedge(hedge);
     
     INFO(TAG, "Thread Marvelmind lancé avec succès sur %s.", marvelmind_port);
@@ -96,6 +227,11 @@ void stop_marvelmind() {
 
     running = false;
     pthread_cond_broadcast(&pos_cond); // débloque un éventuel wait_for_position()
+    if (fd_marvelmind >= 0) {
+        reacteur_retirer_fd(fd_marvelmind);
+        close(fd_marvelmind);
+        fd_marvelmind = -1;
+    }
     if (hedge) {
         stopMarvelmindHedge(hedge);
         destroyMarvelmindHedge(hedge);
@@ -127,9 +263,10 @@ int wait_for_position(int timeout_sec) {
 }
 
 MarvelmindPosition get_marvelmind_position(bool change_to_read) {
+    // La copie garde is_new : c'est la lecture suivante qui voit la position déjà lue
     pthread_mutex_lock(&pos_mutex);
-    current_position.is_new = false;
     MarvelmindPosition pos_copy = current_position;
+    if (change_to_read) current_position.is_new = false;
     pthread_mutex_unlock(&pos_mutex);
     return pos_copy;
 }
@@ -137,5 +274,6 @@ MarvelmindPosition get_marvelmind_position(bool change_to_read) {
 void _set_marvelmind_position(MarvelmindPosition pos) {
     pthread_mutex_lock(&pos_mutex);
     current_position = pos;
+    current_position.is_new = true;
     pthread_mutex_unlock(&pos_mutex);
 }
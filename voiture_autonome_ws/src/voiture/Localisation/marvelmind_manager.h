@@ -23,7 +23,8 @@ void stop_marvelmind();
 // retourne 0 si nouvelle position reçue, -1 en cas de timeout
 int wait_for_position(int timeout_sec);
 
-// Renvoie la dernière position enregistrée 
+// Renvoie la dernière position enregistrée ; is_new indique qu'elle n'a pas encore
+// été lue avec change_to_read, qui la marque alors comme lue
 MarvelmindPosition get_marvelmind_position(bool change_to_read);
 void _set_marvelmind_position(MarvelmindPosition pos);
 
@@ -0,0 +1,254 @@
+// multilateration.c
+#include "multilateration.h"
+#include "config.h"
+#include "logger.h"
+#include "utils.h"
+#include <math.h>
+#include <time.h>
+
+#define TAG "multilateration"
+
+#define LM_MAX_ITER 15
+#define LM_LAMBDA_INIT 1e-3f
+#define LM_PAS_MIN 0.1f       // mm, critère d'arrêt sur la norme du pas
+#define DISTANCE_MIN 1.0f     // mm, évite la division par zéro sur une balise
+
+// Somme des carrés des résidus pour la position (x, y, z)
+static float cout_residus(const BaliseFixe* b, const float* d, int n,
+                          float x, float y, float z) {
+    float cout = 0.0f;
+    for (int i = 0; i < n; i++) {
+        float dx = x - b[i].x, dy = y - b[i].y, dz = z - b[i].z;
+        float r = sqrtf(dx*dx + dy*dy + dz*dz) - d[i];
+        cout += r * r;
+    }
+    return cout;
+}
+
+// Plus grand écart absolu entre distance mesurée et distance à (x, y, z)
+static float residu_max(const BaliseFixe* b, const float* d, int n,
+                        float x, float y, float z) {
+    float r_max = 0.0f;
+    for (int i = 0; i < n; i++) {
+        float dx = x - b[i].x, dy = y - b[i].y, dz = z - b[i].z;
+        float r = fabsf(sqrtf(dx*dx + dy*dy + dz*dz) - d[i]);
+        if (r > r_max) r_max = r;
+    }
+    return r_max;
+}
+
+// Levenberg-Marquardt 2D, le système normal 2x2 est résolu en forme close
+static int lm_2d(const BaliseFixe* b, const float* d, int n,
+                 float* x, float* y, float z) {
+    float lambda = LM_LAMBDA_INIT;
+    float cout = cout_residus(b, d, n, *x, *y, z);
+    int iter;
+
+    for (iter = 0; iter < LM_MAX_ITER; iter++) {
+        float jtj_xx = 0.0f, jtj_xy = 0.0f, jtj_yy = 0.0f;
+        float jtr_x = 0.0f, jtr_y = 0.0f;
+
+        for (int i = 0; i < n; i++) {
+            float dx = *x - b[i].x, dy = *y - b[i].y, dz = z - b[i].z;
+            float rho = sqrtf(dx*dx + dy*dy + dz*dz);
+            if (rho < DISTANCE_MIN) rho = DISTANCE_MIN;
+            float jx = dx / rho, jy = dy / rho;
+            float r = rho - d[i];
+            jtj_xx += jx * jx;
+            jtj_xy += jx * jy;
+            jtj_yy += jy * jy;
+            jtr_x += jx * r;
+            jtr_y += jy * r;
+        }
+
+        float a = jtj_xx * (1.0f + lambda), c = jtj_yy * (1.0f + lambda);
+        float det = a * c - jtj_xy * jtj_xy;
+        if (fabsf(det) < 1e-9f) break;
+
+        float px = -( c * jtr_x - jtj_xy * jtr_y) / det;
+        float py = -(-jtj_xy * jtr_x + a * jtr_y) / det;
+
+        float nx = *x + px, ny = *y + py;
+        float nouveau_cout = cout_residus(b, d, n, nx, ny, z);
+        if (nouveau_cout < cout) {
+            *x = nx;
+            *y = ny;
+            cout = nouveau_cout;
+            lambda *= 0.1f;
+            if (sqrtf(px*px + py*py) < LM_PAS_MIN) { iter++; break; }
+        } else {
+            lambda *= 10.0f;
+        }
+    }
+    return iter;
+}
+
+ResultatMultilateration resoudre_multilateration(const BaliseFixe* balises,
+                                                 const float* distances, int n,
+                                                 float x0, float y0, float z) {
+    ResultatMultilateration res = {0};
+    res.rejetee = -1;
+    res.z = z;
+
+    // Sélection des mesures exploitables (distance nulle = balise non reçue)
+    BaliseFixe b[MULTILAT_MAX_BALISES];
+    float d[MULTILAT_MAX_BALISES];
+    int idx[MULTILAT_MAX_BALISES];
+    int m = 0;
+    for (int i = 0; i < n && m < MULTILAT_MAX_BALISES; i++) {
+        if (distances[i] <= 0.0f) continue;
+        b[m] = balises[i];
+        d[m] = distances[i];
+        idx[m] = i;
+        m++;
+    }
+    if (m < 3) return res;
+
+    float x = x0, y = y0;
+    res.iterations = lm_2d(b, d, m, &x, &y, z);
+
+    // Rejet d'une balise aberrante : avec 4 balises, si un résidu dépasse le seuil,
+    // on résout sur chacun des 4 sous-ensembles de 3. Trois distances suffisent
+    // souvent à s'accorder en incluant l'aberrante : une hypothèse n'est retenue
+    // que si ses 3 balises s'accordent et que la balise écartée est mesurée trop
+    // longue (un trajet réfléchi allonge la distance). Entre plusieurs hypothèses
+    // cohérentes, (x0, y0) ne départage que si l'une en est deux fois plus proche
+    // que les autres ; sinon, ou sans hypothèse cohérente, la solution est invalide.
+    bool ambigue = false;
+    if (m == MULTILAT_MAX_BALISES && residu_max(b, d, m, x, y, z) > MULTILAT_SEUIL_ABERRANT) {
+        BaliseFixe sb[MULTILAT_MAX_BALISES - 1];
+        float sd[MULTILAT_MAX_BALISES - 1];
+        int retenue = -1, coherentes = 0;
+        float bx = x, by = y, ecart_retenue = INFINITY, ecart_autre = INFINITY;
+        for (int k = 0; k < m; k++) {
+            int j = 0;
+            for (int i = 0; i < m; i++) {
+                if (i == k) continue;
+                sb[j] = b[i];
+                sd[j] = d[i];
+                j++;
+            }
+            float sx = x0, sy = y0;
+            res.iterations += lm_2d(sb, sd, m - 1, &sx, &sy, z);
+            float dx = sx - b[k].x, dy = sy - b[k].y, dz = z - b[k].z;
+            float exces = d[k] - sqrtf(dx*dx + dy*dy + dz*dz);
+            if (exces < MULTILAT_SEUIL_ABERRANT || residu_max(sb, sd, m - 1, sx, sy, z) > MULTILAT_RESIDU_MAX)
+                continue;
+            coherentes++;
+            float ecart = hypotf(sx - x0, sy - y0);
+            if (ecart < ecart_retenue) {
+                ecart_autre = ecart_retenue;
+                ecart_retenue = ecart;
+                retenue = k;
+                bx = sx;
+                by = sy;
+            } else if (ecart < ecart_autre) {
+                ecart_autre = ecart;
+            }
+        }
+        if (coherentes == 1 || (coherentes > 1 && ecart_autre > 2.0f * ecart_retenue)) {
+            res.rejetee = idx[retenue];
+            for (int i = retenue; i < m - 1; i++) {
+                b[i] = b[i + 1];
+                d[i] = d[i + 1];
+            }
+            m--;
+            x = bx;
+            y = by;
+        } else {
+            ambigue = true;
+        }
+    }
+
+    res.x = x;
+    res.y = y;
+    res.nb_utilisees = m;
+    res.rms = sqrtf(cout_residus(b, d, m, x, y, z) / m);
+    res.valid = !ambigue && isfinite(x) && isfinite(y) && res.rms < MULTILAT_RMS_MAX
+             && residu_max(b, d, m, x, y, z) <= MULTILAT_RESIDU_MAX;
+    return res;
+}
+
+#ifdef BENCH
+#define BENCH_MULTILAT_TIRAGES 20000
+#define BENCH_MULTILAT_BRUIT_MM 20.0f
+#define BENCH_MULTILAT_ABERRANT_MM 600.0f   // trajet réfléchi sur une balise
+#define BENCH_MULTILAT_PROPORTION_ABERRANTS 0.25f
+#define BENCH_MULTILAT_ECART_DEPART_MM 300.0f
+
+static unsigned int graine = 2024;
+
+static float uniforme(void) {
+    graine = graine * 1103515245u + 12345u;
+    return ((graine >> 8) & 0xFFFF) / 65536.0f;
+}
+
+static float gaussienne(void) {
+    float u = uniforme() + 1e-6f, v = uniforme();
+    return sqrtf(-2.0f * logf(u)) * cosf(2.0f * (float)PI * v);
+}
+
+void benchmark_multilateration(void) {
+    // Quatre balises aux coins d'une piste de 4 m x 3 m, hedge à 150 mm du sol ;
+    // départ décalé de la vraie position comme une position fusionnée en retard
+    const BaliseFixe balises[MULTILAT_MAX_BALISES] = {
+        {    0.0f,    0.0f, 2000.0f }, { 4000.0f,    0.0f, 2100.0f },
+        { 4000.0f, 3000.0f, 1900.0f }, {    0.0f, 3000.0f, 2000.0f },
+    };
+    const float z = 150.0f;
+    int valides = 0, aberrants = 0, detectes = 0, invalidees = 0, mauvaise_balise = 0;
+    int fausses_alertes = 0, iterations = 0;
+    double erreur_totale = 0.0, duree_totale = 0.0, pire_duree = 0.0;
+    float pire_erreur = 0.0f;
+
+    for (int t = 0; t < BENCH_MULTILAT_TIRAGES; t++) {
+        float x = 200.0f + 3600.0f * uniforme(), y = 200.0f + 2600.0f * uniforme();
+        float d[MULTILAT_MAX_BALISES];
+        for (int i = 0; i < MULTILAT_MAX_BALISES; i++) {
+            float dx = x - balises[i].x, dy = y - balises[i].y, dz = z - balises[i].z;
+            d[i] = sqrtf(dx * dx + dy * dy + dz * dz) + BENCH_MULTILAT_BRUIT_MM * gaussienne();
+        }
+        int aberrante = -1;
+        if (uniforme() < BENCH_MULTILAT_PROPORTION_ABERRANTS) {
+            aberrante = (int)(uniforme() * MULTILAT_MAX_BALISES) % MULTILAT_MAX_BALISES;
+            d[aberrante] += BENCH_MULTILAT_ABERRANT_MM;
+            aberrants++;
+        }
+        float angle = 2.0f * (float)PI * uniforme();
+        float x0 = x + BENCH_MULTILAT_ECART_DEPART_MM * cosf(angle);
+        float y0 = y + BENCH_MULTILAT_ECART_DEPART_MM * sinf(angle);
+
+        struct timespec t0, t1;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        ResultatMultilateration r = resoudre_multilateration(balises, d, MULTILAT_MAX_BALISES, x0, y0, z);
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        double duree = timespec_diff_s(t0, t1);
+        duree_totale += duree;
+        if (duree > pire_duree) pire_duree = duree;
+        iterations += r.iterations;
+
+        if (aberrante >= 0 && r.rejetee == aberrante) detectes++;
+        if (aberrante < 0 && r.rejetee >= 0) fausses_alertes++;
+        if (!r.valid) {
+            if (aberrante >= 0) invalidees++;
+            continue;
+        }
+        // Erreur mesurée après le contrôle des résidus : seules les solutions valides comptent
+        valides++;
+        if (aberrante >= 0 && r.rejetee != aberrante) mauvaise_balise++;
+        float erreur = hypotf(r.x - x, r.y - y);
+        erreur_totale += erreur;
+        if (erreur > pire_erreur) pire_erreur = erreur;
+    }
+
+    INFO(TAG, "Multilatération (%d tirages, bruit %.0f mm) : %.2f us en moyenne, pire %.1f us, "
+              "%.1f itérations LM",
+         BENCH_MULTILAT_TIRAGES, BENCH_MULTILAT_BRUIT_MM, 1e6 * duree_totale / BENCH_MULTILAT_TIRAGES,
+         1e6 * pire_duree, (double)iterations / BENCH_MULTILAT_TIRAGES);
+    INFO(TAG, "Multilatération : %d/%d solutions valides, erreur moyenne %.1f mm, pire %.1f mm ; "
+              "aberrantes (+%.0f mm) rejetées %d/%d, %d solutions invalidées, %d valides sur une "
+              "mauvaise balise, fausses alertes %d",
+         valides, BENCH_MULTILAT_TIRAGES, valides ? erreur_totale / valides : 0.0, pire_erreur,
+         BENCH_MULTILAT_ABERRANT_MM, detectes, aberrants, invalidees, mauvaise_balise, fausses_alertes);
+}
+#endif
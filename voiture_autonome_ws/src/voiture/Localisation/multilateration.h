@@ -0,0 +1,46 @@
+// multilateration.h
+#ifndef MULTILATERATION_H
+#define MULTILATERATION_H
+
+#include <stdbool.h>
+
+// Nombre maximal de distances dans un paquet brut Marvelmind (RawDistances)
+#define MULTILAT_MAX_BALISES 4
+
+typedef struct {
+    float x; // mm
+    float y; // mm
+    float z; // mm
+} BaliseFixe;
+
+typedef struct {
+    float x;         // mm
+    float y;         // mm
+    float z;         // mm (hauteur imposée, non estimée)
+    float rms;       // mm, résidu quadratique moyen des balises retenues
+    int nb_utilisees;
+    int rejetee;     // indice de la balise rejetée comme aberrante, -1 sinon
+    int iterations;
+    bool valid;
+} ResultatMultilateration;
+
+// Résout la position (x, y) par Levenberg-Marquardt à partir de n distances (mm)
+// vers des balises fixes. La hauteur z est imposée (hedge monté sur la voiture).
+// (x0, y0) sert de point de départ (typiquement la position fusionnée).
+// Aucune allocation : tout tient dans la pile (n <= MULTILAT_MAX_BALISES).
+// Si 4 balises sont disponibles et qu'un résidu dépasse MULTILAT_SEUIL_ABERRANT,
+// la balise mesurée trop longue dont l'exclusion accorde les 3 autres est écartée
+// et la position recalculée ; si ce choix est ambigu, la solution est invalide.
+// Toute balise retenue à plus de MULTILAT_RESIDU_MAX invalide aussi la solution.
+ResultatMultilateration resoudre_multilateration(const BaliseFixe* balises,
+                                                 const float* distances, int n,
+                                                 float x0, float y0, float z);
+
+#ifdef BENCH
+// Positions tirées entre quatre balises, bruit gaussien, une distance faussée
+// dans un quart des tirages : coût d'une résolution, erreur des solutions valides,
+// rejet des aberrantes et solutions invalidées
+void benchmark_multilateration(void);
+#endif
+
+#endif
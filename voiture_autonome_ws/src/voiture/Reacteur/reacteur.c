@@ -0,0 +1,245 @@
+// reacteur.c
+#include "reacteur.h"
+#include "logger.h"
+#include <pthread.h>
+#include <stddef.h>
+
+#define TAG "reacteur"
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <errno.h>
+#include <math.h>
+
+#define MAX_SOURCES 16
+#define MAX_EVENEMENTS 16
+
+typedef enum {
+    SOURCE_LIBRE = 0,
+    SOURCE_FD,
+    SOURCE_TIMER,
+    SOURCE_REVEIL
+} TypeSource;
+
+typedef struct {
+    TypeSource type;
+    int fd;
+    uint32_t generation;  // invalide les événements d'une source retirée puis réutilisée
+    GestionnaireFd gestionnaire_fd;
+    GestionnaireTimer gestionnaire_timer;
+    void* ctx;
+    unsigned long nb_appels;
+} Source;
+
+static Source sources[MAX_SOURCES];
+static pthread_mutex_t sources_mutex = PTHREAD_MUTEX_INITIALIZER;
+static int epfd = -1;
+static int fd_reveil = -1;
+static volatile bool running = false;
+
+static unsigned long nb_reveils = 0;
+static unsigned long nb_timers_en_retard = 0;
+
+static uint64_t cle_source(int i) {
+    return ((uint64_t)sources[i].generation << 32) | (uint32_t)i;
+}
+
+// Réserve une entrée et l'inscrit dans epoll (retourne l'indice ou -1)
+static int ajouter_source(TypeSource type, int fd, uint32_t evenements, GestionnaireFd gfd, GestionnaireTimer gt,
+                          void* ctx) {
+    pthread_mutex_lock(&sources_mutex);
+    int i = 0;
+    while (i < MAX_SOURCES && sources[i].type != SOURCE_LIBRE) i++;
+    if (i == MAX_SOURCES) {
+        pthread_mutex_unlock(&sources_mutex);
+        ERR(TAG, "Plus de place pour une nouvelle source (max %d)", MAX_SOURCES);
+        return -1;
+    }
+    sources[i].type = type;
+    sources[i].fd = fd;
+    sources[i].generation++;
+    sources[i].gestionnaire_fd = gfd;
+    sources[i].gestionnaire_timer = gt;
+    sources[i].ctx = ctx;
+    sources[i].nb_appels = 0;
+
+    struct epoll_event ev = { .events = evenements, .data.u64 = cle_source(i) };
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        // ex. : stdin redirigé depuis un fichier (EPERM)
+        WARN(TAG, "epoll_ctl(ADD, fd=%d) : errno %d", fd, errno);
+        sources[i].type = SOURCE_LIBRE;
+        i = -1;
+    }
+    pthread_mutex_unlock(&sources_mutex);
+    return i;
+}
+
+static int retirer_source(TypeSource type, int fd) {
+    int ret = -1;
+    pthread_mutex_lock(&sources_mutex);
+    for (int i = 0; i < MAX_SOURCES; i++) {
+        if (sources[i].type == type && sources[i].fd == fd) {
+            epoll_ctl(epfd, EPOLL_CTL_DEL, fd, NULL);
+            sources[i].type = SOURCE_LIBRE;
+            ret = 0;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&sources_mutex);
+    return ret;
+}
+
+int init_reacteur(void) {
+    if (epfd >= 0) return 0;
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd < 0) {
+        ERR(TAG, "epoll_create1 : errno %d", errno);
+        return -1;
+    }
+    fd_reveil = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd_reveil < 0 || ajouter_source(SOURCE_REVEIL, fd_reveil, EPOLLIN, NULL, NULL, NULL) < 0) {
+        ERR(TAG, "Impossible de créer l'eventfd de réveil");
+        close(epfd);
+        epfd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+bool reacteur_actif(void) {
+    return epfd >= 0;
+}
+
+int reacteur_ajouter_fd(int fd, GestionnaireFd gestionnaire, void* ctx) {
+    if (epfd < 0 || fd < 0 || !gestionnaire) return -1;
+    return ajouter_source(SOURCE_FD, fd, EPOLLIN, gestionnaire, NULL, ctx) < 0 ? -1 : 0;
+}
+
+int reacteur_ajouter_fd_ecriture(int fd, GestionnaireFd gestionnaire, void* ctx) {
+    if (epfd < 0 || fd < 0 || !gestionnaire) return -1;
+    return ajouter_source(SOURCE_FD, fd, EPOLLOUT, gestionnaire, NULL, ctx) < 0 ? -1 : 0;
+}
+
+int reacteur_retirer_fd(int fd) {
+    if (epfd < 0) return -1;
+    return retirer_source(SOURCE_FD, fd);
+}
+
+int reacteur_ajouter_timer(double periode_s, GestionnaireTimer gestionnaire, void* ctx) {
+    if (epfd < 0 || periode_s <= 0.0 || !gestionnaire) return -1;
+    int tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (tfd < 0) {
+        ERR(TAG, "timerfd_create : errno %d", errno);
+        return -1;
+    }
+    struct itimerspec its;
+    its.it_interval.tv_sec = (time_t)periode_s;
+    its.it_interval.tv_nsec = (long)((periode_s - floor(periode_s)) * 1e9);
+    its.it_value = its.it_interval;
+    if (timerfd_settime(tfd, 0, &its, NULL) < 0 ||
+        ajouter_source(SOURCE_TIMER, tfd, EPOLLIN, NULL, gestionnaire, ctx) < 0) {
+        close(tfd);
+        return -1;
+    }
+    return tfd;
+}
+
+int reacteur_retirer_timer(int id) {
+    if (epfd < 0 || retirer_source(SOURCE_TIMER, id) < 0) return -1;
+    close(id);
+    return 0;
+}
+
+static void distribuer(const struct epoll_event* ev) {
+    int i = (int)(uint32_t)ev->data.u64;
+    uint32_t generation = (uint32_t)(ev->data.u64 >> 32);
+
+    // Copie sous verrou : la source peut être retirée par son propre gestionnaire
+    pthread_mutex_lock(&sources_mutex);
+    if (i >= MAX_SOURCES || sources[i].type == SOURCE_LIBRE || sources[i].generation != generation) {
+        pthread_mutex_unlock(&sources_mutex);
+        return;
+    }
+    sources[i].nb_appels++;
+    Source s = sources[i];
+    pthread_mutex_unlock(&sources_mutex);
+
+    switch (s.type) {
+        case SOURCE_FD: {
+            uint32_t e = 0;
+            if (ev->events & EPOLLIN) e |= REACTEUR_LECTURE;
+            if (ev->events & EPOLLOUT) e |= REACTEUR_ECRITURE;
+            if (ev->events & (EPOLLERR | EPOLLHUP)) e |= REACTEUR_ERREUR;
+            s.gestionnaire_fd(s.fd, e, s.ctx);
+            break;
+        }
+        case SOURCE_TIMER: {
+            uint64_t expirations = 0;
+            if (read(s.fd, &expirations, sizeof(expirations)) == sizeof(expirations) && expirations > 1)
+                nb_timers_en_retard += expirations - 1;
+            s.gestionnaire_timer(s.ctx);
+            break;
+        }
+        case SOURCE_REVEIL: {
+            uint64_t v;
+            if (read(s.fd, &v, sizeof(v)) < 0) { /* déjà vidé */ }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void* lancer_reacteur(void* arg) {
+    (void)arg;
+    if (epfd < 0 && init_reacteur() != 0) return NULL;
+    running = true;
+    INFO(TAG, "Réacteur d'entrées/sorties démarré");
+
+    struct epoll_event evs[MAX_EVENEMENTS];
+    while (running) {
+        int n = epoll_wait(epfd, evs, MAX_EVENEMENTS, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            ERR(TAG, "epoll_wait : errno %d", errno);
+            break;
+        }
+        nb_reveils++;
+        for (int k = 0; k < n && running; k++)
+            distribuer(&evs[k]);
+    }
+
+    pthread_mutex_lock(&sources_mutex);
+    for (int i = 0; i < MAX_SOURCES; i++) {
+        if (sources[i].type == SOURCE_FD || sources[i].type == SOURCE_TIMER)
+            DBG(TAG, "Source fd=%d : %lu appels", sources[i].fd, sources[i].nb_appels);
+    }
+    pthread_mutex_unlock(&sources_mutex);
+    INFO(TAG, "Réacteur arrêté : %lu réveils, %lu échéances de timer manquées",
+         nb_reveils, nb_timers_en_retard);
+    return NULL;
+}
+
+void stop_reacteur(void) {
+    running = false;
+    if (fd_reveil >= 0) {
+        uint64_t un = 1;
+        if (write(fd_reveil, &un, sizeof(un)) < 0) { /* réveil déjà en attente */ }
+    }
+}
+
+#else
+// epoll/timerfd n'existent que sous Linux : les modules gardent leurs threads (USE_REACTEUR=0)
+int init_reacteur(void) { return -1; }
+bool reacteur_actif(void) { return false; }
+int reacteur_ajouter_fd(int fd, GestionnaireFd g, void* ctx) { (void)fd; (void)g; (void)ctx; return -1; }
+int reacteur_ajouter_fd_ecriture(int fd, GestionnaireFd g, void* ctx) { (void)fd; (void)g; (void)ctx; return -1; }
+int reacteur_retirer_fd(int fd) { (void)fd; return -1; }
+int reacteur_ajouter_timer(double p, GestionnaireTimer g, void* ctx) { (void)p; (void)g; (void)ctx; return -1; }
+int reacteur_retirer_timer(int id) { (void)id; return -1; }
+void* lancer_reacteur(void* arg) { (void)arg; ERR(TAG, "Réacteur indisponible sur cette plateforme"); return NULL; }
+void stop_reacteur(void) {}
+#endif
@@ -0,0 +1,43 @@
+// reacteur.h
+#ifndef REACTEUR_H
+#define REACTEUR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*  Réacteur d'entrées/sorties (epoll) de la voiture
+
+    Un seul thread attend sur tous les descripteurs (série MegaPi, Marvelmind,
+    UDP caméra, TCP contrôleur) et appelle le gestionnaire de celui qui est prêt.
+    Les traitements périodiques passent par des timerfd.
+    Les gestionnaires s'exécutent dans le thread du réacteur : ils ne doivent
+    jamais bloquer (lire ce qui est disponible, publier, rendre la main).
+    L'ajout et le retrait de sources sont possibles depuis n'importe quel thread.
+*/
+
+#define REACTEUR_LECTURE  0x1u
+#define REACTEUR_ERREUR   0x2u   // erreur ou fermeture côté distant
+#define REACTEUR_ECRITURE 0x4u   // fd inscrit par reacteur_ajouter_fd_ecriture devenu inscriptible
+
+typedef void (*GestionnaireFd)(int fd, uint32_t evenements, void* ctx);
+typedef void (*GestionnaireTimer)(void* ctx);
+
+int init_reacteur(void);
+bool reacteur_actif(void);
+
+// Surveille fd en lecture (retourne 0 si OK)
+int reacteur_ajouter_fd(int fd, GestionnaireFd gestionnaire, void* ctx);
+// Surveille fd en écriture (ex. : fin d'un connect() non bloquant)
+int reacteur_ajouter_fd_ecriture(int fd, GestionnaireFd gestionnaire, void* ctx);
+// Ne ferme pas fd
+int reacteur_retirer_fd(int fd);
+
+// Appelle gestionnaire toutes les periode_s secondes ; retourne un identifiant (>= 0)
+int reacteur_ajouter_timer(double periode_s, GestionnaireTimer gestionnaire, void* ctx);
+int reacteur_retirer_timer(int id);
+
+// Boucle du réacteur (à lancer dans un thread)
+void* lancer_reacteur(void* arg);
+void stop_reacteur(void);
+
+#endif
@@ -0,0 +1,252 @@
+#include <math.h>
+#include <stdbool.h>
+#include <string.h>
+#include "ajustement_voie.h"
+#include "config.h"
+#include "logger.h"
+#include "utils.h"
+
+#define TAG "ajustement_voie"
+
+#define ECHELLE_MM 1000.0     // x ramené en mètres : équations normales bien conditionnées
+#define POIDS_LARGEUR 0.1     // a priori de largeur, en points équivalents
+#define POIDS_FORME 1e-3      // a priori pente et courbure nulles (lignes vues sur un seul x)
+
+typedef struct {
+    double n, u, u2, u3, u4, y, uy, u2y;
+} Sommes;
+
+static void accumuler(const Point* pts, const bool* retenu, int nb, Sommes* s) {
+    memset(s, 0, sizeof(*s));
+    for (int i = 0; i < nb; i++) {
+        if (!retenu[i]) continue;
+        double u = pts[i].x / ECHELLE_MM, u2 = u * u, y = pts[i].y;
+        s->n += 1.0;
+        s->u += u;
+        s->u2 += u2;
+        s->u3 += u2 * u;
+        s->u4 += u2 * u2;
+        s->y += y;
+        s->uy += u * y;
+        s->u2y += u2 * y;
+    }
+}
+
+// Elimination de Gauss avec pivot partiel ; 0 si le système est singulier
+static int resoudre4(double a[4][4], double b[4], double x[4]) {
+    for (int k = 0; k < 4; k++) {
+        int p = k;
+        for (int i = k + 1; i < 4; i++)
+            if (fabs(a[i][k]) > fabs(a[p][k])) p = i;
+        if (fabs(a[p][k]) < 1e-12) return 0;
+        if (p != k) {
+            for (int j = 0; j < 4; j++) { double t = a[k][j]; a[k][j] = a[p][j]; a[p][j] = t; }
+            double t = b[k]; b[k] = b[p]; b[p] = t;
+        }
+        for (int i = k + 1; i < 4; i++) {
+            double f = a[i][k] / a[k][k];
+            for (int j = k; j < 4; j++) a[i][j] -= f * a[k][j];
+            b[i] -= f * b[k];
+        }
+    }
+    for (int k = 3; k >= 0; k--) {
+        double s = b[k];
+        for (int j = k + 1; j < 4; j++) s -= a[k][j] * x[j];
+        x[k] = s / a[k][k];
+    }
+    return 1;
+}
+
+// x = [gauche, droite, b1, b2] avec y = bord + b1.u + b2.u², u = x / ECHELLE_MM
+static int ajuster(const Sommes* g, const Sommes* d, double x[4]) {
+    const double w = POIDS_LARGEUR, l = VOIE_LARGEUR_DEFAUT_MM;
+    double a[4][4] = {
+        { g->n + w, -w,       g->u,         g->u2 },
+        { -w,       d->n + w, d->u,         d->u2 },
+        { g->u,     d->u,     g->u2 + d->u2 + POIDS_FORME, g->u3 + d->u3 },
+        { g->u2,    d->u2,    g->u3 + d->u3, g->u4 + d->u4 + POIDS_FORME }
+    };
+    double b[4] = { g->y + w * l, d->y - w * l, g->uy + d->uy, g->u2y + d->u2y };
+    return resoudre4(a, b, x);
+}
+
+// Retient les points à moins de seuil ; retourne 1 si la sélection a changé
+static int selectionner(const Point* pts, int nb, double bord, double b1, double b2,
+                        float seuil, bool* retenu, double* somme_r2, int* nb_retenus) {
+    int change = 0;
+    for (int i = 0; i < nb; i++) {
+        double u = pts[i].x / ECHELLE_MM;
+        float r = (float)(pts[i].y - (bord + b1 * u + b2 * u * u));
+        bool garde = fabsf(r) <= seuil;
+        if (garde != retenu[i]) change = 1;
+        retenu[i] = garde;
+        if (garde) { *somme_r2 += (double)r * r; (*nb_retenus)++; }
+    }
+    return change;
+}
+
+static double residu2(const Point* pts, const bool* retenu, int nb, double bord, double b1, double b2) {
+    double s = 0.0;
+    for (int i = 0; i < nb; i++) {
+        if (!retenu[i]) continue;
+        double u = pts[i].x / ECHELLE_MM;
+        double r = pts[i].y - (bord + b1 * u + b2 * u * u);
+        s += r * r;
+    }
+    return s;
+}
+
+static float qualite_ligne(int retenus, int nb) {
+    if (retenus < VOIE_POINTS_MIN) return 0.0f;
+    float q = (float)retenus / VOIE_POINTS_PLEINS;
+    return (q < 1.0f ? q : 1.0f) * retenus / nb;
+}
+
+void ajuster_voie(const MarquageSol* m, ModeleVoie* out) {
+    memset(out, 0, sizeof(*out));
+    int ng = m->nb_points_gauche < MAX_POINTS_MARQUAGE ? m->nb_points_gauche : MAX_POINTS_MARQUAGE;
+    int nd = m->nb_points_droite < MAX_POINTS_MARQUAGE ? m->nb_points_droite : MAX_POINTS_MARQUAGE;
+    if (ng < 0) ng = 0;
+    if (nd < 0) nd = 0;
+    if (ng + nd < VOIE_POINTS_MIN) return;
+
+    bool rg[MAX_POINTS_MARQUAGE], rd[MAX_POINTS_MARQUAGE];
+    for (int i = 0; i < ng; i++) rg[i] = true;
+    for (int i = 0; i < nd; i++) rd[i] = true;
+
+    Sommes sg, sd;
+    double x[4];
+    int kg = ng, kd = nd;
+    double r2 = 0.0;
+    for (int it = 0; it < VOIE_ITERATIONS; it++) {
+        accumuler(m->ligne_gauche, rg, ng, &sg);
+        accumuler(m->ligne_droite, rd, nd, &sd);
+        if (!ajuster(&sg, &sd, x)) return;
+        r2 = residu2(m->ligne_gauche, rg, ng, x[0], x[2], x[3]) +
+             residu2(m->ligne_droite, rd, nd, x[1], x[2], x[3]);
+        if (it == VOIE_ITERATIONS - 1) break;
+
+        float sigma = kg + kd > 0 ? (float)sqrt(r2 / (kg + kd)) : 0.0f;
+        float seuil = VOIE_K_SIGMA * sigma;
+        if (seuil < VOIE_SEUIL_RESIDU_MM) seuil = VOIE_SEUIL_RESIDU_MM;
+        double r2_sel = 0.0;
+        int kg_sel = 0, kd_sel = 0;
+        int change = selectionner(m->ligne_gauche, ng, x[0], x[2], x[3], seuil, rg, &r2_sel, &kg_sel);
+        change |= selectionner(m->ligne_droite, nd, x[1], x[2], x[3], seuil, rd, &r2_sel, &kd_sel);
+        kg = kg_sel;
+        kd = kd_sel;
+        if (!change) break;   // résidus déjà calculés pour cet ensemble : r2 est à jour
+    }
+    if (kg < VOIE_POINTS_MIN && kd < VOIE_POINTS_MIN) return;
+
+    out->valide = 1;
+    out->gauche = (float)x[0];
+    out->droite = (float)x[1];
+    out->a1 = (float)(x[2] / ECHELLE_MM);
+    out->a2 = (float)(x[3] / (ECHELLE_MM * ECHELLE_MM));
+    out->largeur = out->gauche - out->droite;
+    out->decalage = 0.5f * (out->gauche + out->droite);
+    out->cap = atanf(out->a1) * 180.0f / (float)PI;
+    out->courbure = 2.0f * out->a2 / powf(1.0f + out->a1 * out->a1, 1.5f);
+    out->residu = (float)sqrt(r2 / (kg + kd));
+    out->retenus_gauche = kg;
+    out->retenus_droite = kd;
+    for (int i = 0; i < ng; i++)
+        if (rg[i] && m->ligne_gauche[i].x > out->portee) out->portee = m->ligne_gauche[i].x;
+    for (int i = 0; i < nd; i++)
+        if (rd[i] && m->ligne_droite[i].x > out->portee) out->portee = m->ligne_droite[i].x;
+
+    float c = 0.5f * (qualite_ligne(kg, ng) + qualite_ligne(kd, nd));
+    float e = out->residu / VOIE_SEUIL_RESIDU_MM;
+    c /= 1.0f + e * e;
+    if (out->largeur < VOIE_LARGEUR_MIN_MM || out->largeur > VOIE_LARGEUR_MAX_MM) c = 0.0f;
+    out->confiance = c;
+}
+
+float ordonnee_voie(const ModeleVoie* v, int cote, float x) {
+    float bord = cote > 0 ? v->gauche : cote < 0 ? v->droite : v->decalage;
+    return bord + v->a1 * x + v->a2 * x * x;
+}
+
+#ifdef BENCH
+#define BENCH_VOIE_IMAGES 2000
+#define BENCH_VOIE_POINTS 24
+
+static unsigned int graine = 4242;
+
+static float uniforme(void) {
+    graine = graine * 1103515245u + 12345u;
+    return ((graine >> 8) & 0xFFFF) / 65536.0f;
+}
+
+static float gaussienne(void) {
+    float u = uniforme() + 1e-6f, v = uniforme();
+    return sqrtf(-2.0f * logf(u)) * cosf(2.0f * (float)PI * v);
+}
+
+void benchmark_ajustement_voie(void) {
+    // Voie de 400 mm, voiture décalée et de travers, virage de rayon 1,5 à 5 m ;
+    // bruit 10 mm, 10 % de points aberrants (jusqu'à 300 mm), une ligne perdue
+    // une image sur 8
+    static MarquageSol m;
+    double e_larg = 0.0, e_dec = 0.0, e_cap = 0.0, e_courb = 0.0;
+    double n_larg = 0.0, n_dec = 0.0;
+    double t_total = 0.0, pire = 0.0;
+    int nb_confiants = 0;
+    struct timespec t0, t1;
+
+    for (int k = 0; k < BENCH_VOIE_IMAGES; k++) {
+        const float largeur = 400.0f;
+        const float dec = 120.0f * (2.0f * uniforme() - 1.0f);
+        const float a1 = 0.2f * (2.0f * uniforme() - 1.0f);
+        const float rayon = (1500.0f + 3500.0f * uniforme()) * (uniforme() < 0.5f ? -1.0f : 1.0f);
+        const float a2 = 0.5f / rayon;
+        const int perdue = k % 8 == 0 ? 1 + (k / 8) % 2 : 0;   // 1 : gauche, 2 : droite
+
+        m.nb_points_gauche = perdue == 1 ? 0 : BENCH_VOIE_POINTS;
+        m.nb_points_droite = perdue == 2 ? 0 : BENCH_VOIE_POINTS;
+        for (int i = 0; i < BENCH_VOIE_POINTS; i++) {
+            float x = 150.0f + 60.0f * i;
+            float yc = dec + a1 * x + a2 * x * x;
+            float og = uniforme() < 0.1f ? 300.0f * (2.0f * uniforme() - 1.0f) : 0.0f;
+            float od = uniforme() < 0.1f ? 300.0f * (2.0f * uniforme() - 1.0f) : 0.0f;
+            m.ligne_gauche[i] = (Point){ .x = x, .y = yc + 0.5f * largeur + 10.0f * gaussienne() + og };
+            m.ligne_droite[i] = (Point){ .x = x, .y = yc - 0.5f * largeur + 10.0f * gaussienne() + od };
+        }
+
+        ModeleVoie v;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        ajuster_voie(&m, &v);
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        double dt = timespec_diff_s(t0, t1);
+        t_total += dt;
+        if (dt > pire) pire = dt;
+
+        // Référence : premier point de chaque ligne, comme l'ancien comportement
+        if (!perdue) {
+            float l0 = m.ligne_gauche[0].y - m.ligne_droite[0].y;
+            float d0 = 0.5f * (m.ligne_gauche[0].y + m.ligne_droite[0].y) - (dec + a1 * 150.0f + a2 * 150.0f * 150.0f);
+            n_larg += (l0 - largeur) * (l0 - largeur);
+            n_dec += d0 * d0;
+        }
+        if (v.valide && v.confiance >= VOIE_CONFIANCE_MIN) {
+            float courbure = 2.0f * a2 / powf(1.0f + a1 * a1, 1.5f);
+            float cap = atanf(a1) * 180.0f / (float)PI;
+            e_larg += (v.largeur - largeur) * (v.largeur - largeur);
+            e_dec += (v.decalage - dec) * (v.decalage - dec);
+            e_cap += (v.cap - cap) * (v.cap - cap);
+            e_courb += (v.courbure - courbure) * (v.courbure - courbure);
+            nb_confiants++;
+        }
+    }
+
+    int nb_ref = BENCH_VOIE_IMAGES - BENCH_VOIE_IMAGES / 8;
+    double c = nb_confiants ? nb_confiants : 1;
+    INFO(TAG, "Voie (%d images, %d points par ligne) : %.2f us par image (pire %.2f us), %d confiantes ; "
+              "RMS largeur %.1f mm, décalage %.1f mm, cap %.2f deg, courbure %.2e 1/mm ; "
+              "premier point seul : largeur %.1f mm, décalage %.1f mm",
+         BENCH_VOIE_IMAGES, BENCH_VOIE_POINTS, t_total / BENCH_VOIE_IMAGES * 1e6, pire * 1e6, nb_confiants,
+         sqrt(e_larg / c), sqrt(e_dec / c), sqrt(e_cap / c), sqrt(e_courb / c),
+         sqrt(n_larg / nb_ref), sqrt(n_dec / nb_ref));
+}
+#endif
@@ -0,0 +1,31 @@
+#ifndef AJUSTEMENT_VOIE_H
+#define AJUSTEMENT_VOIE_H
+
+#include "messages.h"
+
+/*  Ajustement de la voie sur le marquage au sol d'une image (repère voiture).
+    Les deux lignes sont ajustées ensemble par moindres carrés en forme close :
+    bords parallèles y = gauche|droite + a1.x + a2.x² (4 inconnues, équations
+    normales résolues directement), plus un a priori faible sur la largeur
+    (VOIE_LARGEUR_DEFAUT_MM) qui ne fixe que le bord d'une ligne non vue.
+    Les points aberrants sont rejetés entre deux ajustements (résidu au-delà de
+    VOIE_K_SIGMA écarts-types, jamais en deçà de VOIE_SEUIL_RESIDU_MM) ; au plus
+    VOIE_ITERATIONS ajustements : coût borné par image (2 x MAX_POINTS_MARQUAGE points).
+    La confiance tient compte du nombre et de la proportion de points retenus
+    sur chaque ligne, du résidu et de la plausibilité de la largeur.
+*/
+
+// Appelé par publier_detection() ; out->valide = 0 si aucune ligne exploitable
+void ajuster_voie(const MarquageSol* marquage, ModeleVoie* out);
+
+// Ordonnée (repère voiture) du bord gauche (cote = 1), droit (-1) ou de la
+// ligne centrale (0) à l'abscisse x
+float ordonnee_voie(const ModeleVoie* v, int cote, float x);
+
+#ifdef BENCH
+// Voie courbe synthétique (bruit, points aberrants, ligne perdue) : erreurs sur
+// largeur, décalage, cap et courbure contre le premier point de chaque ligne
+void benchmark_ajustement_voie(void);
+#endif
+
+#endif
@@ -0,0 +1,333 @@
+#include <math.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "grille_occupation.h"
+#include "config.h"
+#include "logger.h"
+#include "utils.h"
+
+#define TAG "grille_occupation"
+
+#define COTE (1 << GRILLE_LOG2_CELLULES)          // cellules par côté
+#define MASQUE (COTE - 1)
+#define TUILE_LOG2 3
+#define TUILE (1 << TUILE_LOG2)                   // 8 x 8 cellules = 64 octets
+#define TUILES_COTE (COTE / TUILE)
+#define NB_TUILES (TUILES_COTE * TUILES_COTE)
+#define CELLULE ((float)GRILLE_CELLULE_MM)
+#define OUBLI_Q8 ((int)(GRILLE_OUBLI * 256.0f))
+#define ECHELLE_LOG 16.0f                         // unités de log-odds par nat
+
+static struct {
+    int8_t cellule[NB_TUILES][TUILE * TUILE] __attribute__((aligned(64)));
+    uint8_t non_nulles[NB_TUILES];
+    uint8_t occupees[NB_TUILES];
+    int oi, oj;                 // cellule monde du coin bas gauche de la fenêtre
+    bool initialisee;
+} grille;
+
+static pthread_mutex_t grille_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Indices de stockage (cellule monde & MASQUE) -> tuile et rang dans la tuile
+static inline int tuile_de(int i, int j) {
+    return (j >> TUILE_LOG2) * TUILES_COTE + (i >> TUILE_LOG2);
+}
+
+static inline int rang_de(int i, int j) {
+    return ((j & (TUILE - 1)) << TUILE_LOG2) | (i & (TUILE - 1));
+}
+
+static inline int cellule_de(float v) {
+    return (int)floorf(v / CELLULE);
+}
+
+static inline bool dans_fenetre(int ci, int cj) {
+    return (unsigned)(ci - grille.oi) < COTE && (unsigned)(cj - grille.oj) < COTE;
+}
+
+static void ecrire(int t, int r, int v) {
+    if (v > GRILLE_LOG_MAX) v = GRILLE_LOG_MAX;
+    if (v < -GRILLE_LOG_MAX) v = -GRILLE_LOG_MAX;
+    int ancien = grille.cellule[t][r];
+    grille.non_nulles[t] += (v != 0) - (ancien != 0);
+    grille.occupees[t] += (v >= GRILLE_SEUIL_OCCUPE) - (ancien >= GRILLE_SEUIL_OCCUPE);
+    grille.cellule[t][r] = (int8_t)v;
+}
+
+static void ajouter(int ci, int cj, int delta) {
+    if (!dans_fenetre(ci, cj)) return;
+    int i = ci & MASQUE, j = cj & MASQUE;
+    int t = tuile_de(i, j), r = rang_de(i, j);
+    ecrire(t, r, grille.cellule[t][r] + delta);
+}
+
+static void effacer_tout(void) {
+    memset(grille.cellule, 0, sizeof(grille.cellule));
+    memset(grille.non_nulles, 0, sizeof(grille.non_nulles));
+    memset(grille.occupees, 0, sizeof(grille.occupees));
+}
+
+// Colonnes monde [c0, c1) (axe = 0) ou lignes monde [c0, c1) (axe = 1)
+static void effacer_bande(int c0, int c1, int axe) {
+    for (int c = c0; c < c1; c++) {
+        int s = c & MASQUE;
+        for (int k = 0; k < COTE; k++) {
+            int i = axe ? k : s, j = axe ? s : k;
+            int t = tuile_de(i, j);
+            if (grille.non_nulles[t]) ecrire(t, rang_de(i, j), 0);
+        }
+    }
+}
+
+// Fait glisser la fenêtre pour que la voiture soit au centre
+static void recentrer(float x, float y) {
+    int oi = cellule_de(x) - COTE / 2, oj = cellule_de(y) - COTE / 2;
+    int di = oi - grille.oi, dj = oj - grille.oj;
+    if (!grille.initialisee || di >= COTE || di <= -COTE || dj >= COTE || dj <= -COTE) {
+        effacer_tout();
+    } else {
+        if (di > 0) effacer_bande(grille.oi + COTE, oi + COTE, 0);
+        if (di < 0) effacer_bande(oi, grille.oi, 0);
+        if (dj > 0) effacer_bande(grille.oj + COTE, oj + COTE, 1);
+        if (dj < 0) effacer_bande(oj, grille.oj, 1);
+    }
+    grille.oi = oi;
+    grille.oj = oj;
+    grille.initialisee = true;
+}
+
+static void oublier(void) {
+    for (int t = 0; t < NB_TUILES; t++) {
+        if (!grille.non_nulles[t]) continue;
+        int8_t* c = grille.cellule[t];
+        int non_nulles = 0, occupees = 0;
+        for (int r = 0; r < TUILE * TUILE; r++) {
+            int v = c[r] * OUBLI_Q8 / 256;   // division tronquée : tend vers 0 des deux côtés
+            c[r] = (int8_t)v;
+            non_nulles += v != 0;
+            occupees += v >= GRILLE_SEUIL_OCCUPE;
+        }
+        grille.non_nulles[t] = (uint8_t)non_nulles;
+        grille.occupees[t] = (uint8_t)occupees;
+    }
+}
+
+// Cellules de (x0, y0) jusqu'à une cellule avant (x1, y1), chacune une fois
+static void rayon_libre(float x0, float y0, float x1, float y1) {
+    float dx = x1 - x0, dy = y1 - y0;
+    float l = sqrtf(dx * dx + dy * dy);
+    if (l < CELLULE) return;
+    int n = (int)(l / CELLULE) - 1;
+    float ux = dx / l * CELLULE, uy = dy / l * CELLULE;
+    const int ci_fin = cellule_de(x1), cj_fin = cellule_de(y1);   // la face n'est pas libérée
+    int pi = INT32_MIN, pj = INT32_MIN;
+    for (int k = 0; k < n; k++) {
+        int ci = cellule_de(x0 + ux * k), cj = cellule_de(y0 + uy * k);
+        if ((ci == pi && cj == pj) || (ci == ci_fin && cj == cj_fin)) continue;
+        ajouter(ci, cj, -GRILLE_LOG_LIBRE);
+        pi = ci;
+        pj = cj;
+    }
+}
+
+static void marquer_obstacle(const Obstacle* o, float px, float py) {
+    float dx = o->pointd.x - o->pointg.x, dy = o->pointd.y - o->pointg.y;
+    int n = (int)ceilf(sqrtf(dx * dx + dy * dy) / CELLULE);
+    if (n < 1) n = 1;
+    for (int k = 0; k <= n; k++) {
+        float fx = o->pointg.x + dx * k / n, fy = o->pointg.y + dy * k / n;
+        rayon_libre(px, py, fx, fy);
+    }
+    // Occupation après les rayons : un rayon vers un coin ne libère pas la face voisine
+    for (int k = 0; k <= n; k++) {
+        float fx = o->pointg.x + dx * k / n, fy = o->pointg.y + dy * k / n;
+        float rx = fx - px, ry = fy - py;
+        float l = sqrtf(rx * rx + ry * ry);
+        if (l < 1e-3f) continue;
+        rx *= CELLULE / l;
+        ry *= CELLULE / l;
+        for (int e = 0; e * CELLULE <= GRILLE_EPAISSEUR_MM; e++)
+            ajouter(cellule_de(fx + rx * e), cellule_de(fy + ry * e), GRILLE_LOG_OCCUPE);
+    }
+}
+
+void mettre_a_jour_grille(const DetectionMonde* monde) {
+    if (!monde->pose_valide) return;
+    const float px = monde->pose.x, py = monde->pose.y;
+    pthread_mutex_lock(&grille_mutex);
+    oublier();
+    recentrer(px, py);
+    for (int j = 0; j < monde->count; j++) {
+        if (monde->obstacle[j].type == PONT) continue;   // structure franchie, pas un obstacle
+        marquer_obstacle(&monde->obstacle[j], px, py);
+    }
+    pthread_mutex_unlock(&grille_mutex);
+}
+
+static inline bool occupee(float x, float y, bool* hors) {
+    int ci = cellule_de(x), cj = cellule_de(y);
+    if (!dans_fenetre(ci, cj)) { *hors = true; return false; }
+    int i = ci & MASQUE, j = cj & MASQUE;
+    int t = tuile_de(i, j);
+    return grille.occupees[t] && grille.cellule[t][rang_de(i, j)] >= GRILLE_SEUIL_OCCUPE;
+}
+
+int grille_chemin_libre(float x0, float y0, const Point* pts, int nb, float demi_largeur,
+                        float* distance_libre) {
+    const int r = (int)ceilf(demi_largeur / CELLULE);
+    float parcouru = 0.0f;
+    int libre = 1;
+    pthread_mutex_lock(&grille_mutex);
+    if (!grille.initialisee) nb = 0;
+    float ax = x0, ay = y0;
+    for (int k = 0; k < nb; k++) {
+        float dx = pts[k].x - ax, dy = pts[k].y - ay;
+        float l = sqrtf(dx * dx + dy * dy);
+        if (l < 1e-3f) continue;
+        float ux = dx / l, uy = dy / l;
+        float nx = -uy * CELLULE, ny = ux * CELLULE;
+        for (float e = 0.0f; e < l; e += CELLULE) {
+            float cx = ax + ux * e, cy = ay + uy * e;
+            bool hors = false;
+            if (occupee(cx, cy, &hors)) libre = 0;
+            if (hors) { parcouru += e; goto fin; }   // au-delà de la grille : rien n'est connu
+            for (int m = 1; libre && m <= r; m++) {
+                bool h = false;
+                if (occupee(cx + nx * m, cy + ny * m, &h) || occupee(cx - nx * m, cy - ny * m, &h))
+                    libre = 0;
+            }
+            if (!libre) { parcouru += e; goto fin; }
+        }
+        parcouru += l;
+        ax = pts[k].x;
+        ay = pts[k].y;
+    }
+fin:
+    pthread_mutex_unlock(&grille_mutex);
+    if (distance_libre) *distance_libre = parcouru;
+    return libre;
+}
+
+float grille_probabilite(float x, float y) {
+    int ci = cellule_de(x), cj = cellule_de(y);
+    float p = 0.5f;
+    pthread_mutex_lock(&grille_mutex);
+    if (grille.initialisee && dans_fenetre(ci, cj)) {
+        int i = ci & MASQUE, j = cj & MASQUE;
+        p = 1.0f / (1.0f + expf(-grille.cellule[tuile_de(i, j)][rang_de(i, j)] / ECHELLE_LOG));
+    }
+    pthread_mutex_unlock(&grille_mutex);
+    return p;
+}
+
+void reinitialiser_grille_occupation(void) {
+    pthread_mutex_lock(&grille_mutex);
+    effacer_tout();
+    grille.initialisee = false;
+    pthread_mutex_unlock(&grille_mutex);
+}
+
+#ifdef BENCH
+#define BENCH_GRILLE_IMAGES 300
+#define BENCH_GRILLE_PLOTS 24
+#define BENCH_GRILLE_PORTEE_MM 1500.0f
+#define BENCH_GRILLE_DT (1.0f / 30.0f)
+
+static unsigned int graine = 777;
+
+static float uniforme(void) {
+    graine = graine * 1103515245u + 12345u;
+    return ((graine >> 8) & 0xFFFF) / 65536.0f;
+}
+
+void benchmark_grille_occupation(void) {
+    // Voiture à 300 mm/s le long de x ; plots de 60 mm tous les 250 mm de part et
+    // d'autre de la voie (y = +-250), un plot sur la voie à x = 2500. La caméra
+    // ne rapporte que MAX_OBSTACLES_SIMULTANES plots tirés parmi ceux visibles
+    // (moins de BENCH_GRILLE_PORTEE_MM devant), chacun manqué 15 % du temps
+    float plot_x[BENCH_GRILLE_PLOTS + 1], plot_y[BENCH_GRILLE_PLOTS + 1];
+    for (int k = 0; k < BENCH_GRILLE_PLOTS; k++) {
+        plot_x[k] = 400.0f + 250.0f * (k / 2);
+        plot_y[k] = k % 2 ? 250.0f : -250.0f;
+    }
+    plot_x[BENCH_GRILLE_PLOTS] = 2500.0f;
+    plot_y[BENCH_GRILLE_PLOTS] = 0.0f;
+
+    static DetectionMonde det;
+    memset(&det, 0, sizeof(det));
+    det.pose_valide = 1;
+    double t_maj = 0.0, t_req = 0.0, pire_maj = 0.0;
+    long visibles = 0, retenus = 0;
+    int bloque_vu = 0, faux_blocages = 0, images_bloquantes = 0;
+    double err_dist = 0.0;
+    struct timespec t0, t1;
+
+    reinitialiser_grille_occupation();
+    for (int n = 0; n < BENCH_GRILLE_IMAGES; n++) {
+        det.pose.x = 300.0f * n * BENCH_GRILLE_DT;
+        det.pose.y = 0.0f;
+        int vis[BENCH_GRILLE_PLOTS + 1], nb_vis = 0;
+        for (int k = 0; k <= BENCH_GRILLE_PLOTS; k++) {
+            float d = plot_x[k] - det.pose.x;
+            if (d > 0.0f && d < BENCH_GRILLE_PORTEE_MM) vis[nb_vis++] = k;
+        }
+        // Tirage sans remise de MAX_OBSTACLES_SIMULTANES plots visibles
+        det.count = 0;
+        for (int m = 0; m < nb_vis && det.count < MAX_OBSTACLES_SIMULTANES; m++) {
+            int e = m + (int)(uniforme() * (nb_vis - m));
+            int tmp = vis[m]; vis[m] = vis[e]; vis[e] = tmp;
+            if (uniforme() < 0.15f) continue;
+            Obstacle* o = &det.obstacle[det.count++];
+            memset(o, 0, sizeof(*o));
+            o->type = OBSTACLE_VOITURE;
+            o->pointg.x = o->pointd.x = plot_x[vis[m]];
+            o->pointg.y = plot_y[vis[m]] + 30.0f;
+            o->pointd.y = plot_y[vis[m]] - 30.0f;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        mettre_a_jour_grille(&det);
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        double dt = timespec_diff_s(t0, t1);
+        t_maj += dt;
+        if (dt > pire_maj) pire_maj = dt;
+
+        // Plots visibles encore occupés dans la grille
+        for (int m = 0; m < nb_vis; m++) {
+            visibles++;
+            if (grille_probabilite(plot_x[vis[m]], plot_y[vis[m]]) > 0.8f) retenus++;
+        }
+
+        // Couloir de la voiture sur 2 m tout droit
+        Point fin = { .x = det.pose.x + 2000.0f, .y = 0.0f };
+        float libre_mm;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        int libre = grille_chemin_libre(det.pose.x, 0.0f, &fin, 1,
+                                        0.5f * LARGEUR_VOITURE_MM + 50.0f, &libre_mm);
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        t_req += timespec_diff_s(t0, t1);
+        float d_plot = plot_x[BENCH_GRILLE_PLOTS] - det.pose.x;
+        bool attendu = d_plot > 0.0f && d_plot < BENCH_GRILLE_PORTEE_MM;
+        if (attendu && n > 10) {
+            images_bloquantes++;
+            if (!libre) {
+                bloque_vu++;
+                err_dist += fabsf(libre_mm - d_plot);
+            }
+        }
+        if (!libre && d_plot < -(float)GRILLE_EPAISSEUR_MM) faux_blocages++;   // plot dépassé
+    }
+
+    INFO(TAG, "Grille %dx%d de %d mm (%zu octets) : mise à jour %.2f us (pire %.2f us), requête 2 m %.2f us",
+         COTE, COTE, GRILLE_CELLULE_MM, sizeof(grille), t_maj / BENCH_GRILLE_IMAGES * 1e6, pire_maj * 1e6,
+         t_req / BENCH_GRILLE_IMAGES * 1e6);
+    INFO(TAG, "Grille (%d plots, %d par image au plus) : %.1f plots visibles retenus en moyenne sur %.1f, "
+              "plot sur la voie vu %d/%d images (écart %.0f mm), %d faux blocages",
+         BENCH_GRILLE_PLOTS + 1, MAX_OBSTACLES_SIMULTANES, (double)retenus / BENCH_GRILLE_IMAGES,
+         (double)visibles / BENCH_GRILLE_IMAGES, bloque_vu, images_bloquantes,
+         bloque_vu ? err_dist / bloque_vu : 0.0, faux_blocages);
+    reinitialiser_grille_occupation();
+}
+#endif
@@ -0,0 +1,44 @@
+#ifndef GRILLE_OCCUPATION_H
+#define GRILLE_OCCUPATION_H
+
+#include "messages.h"
+
+/*  Grille d'occupation locale, centrée sur la voiture, en repère monde.
+    2^GRILLE_LOG2_CELLULES cellules de GRILLE_CELLULE_MM de côté, un log-odds
+    sur 8 bits par cellule, rangées par tuiles de 8 x 8 (une ligne de cache)
+    elles-mêmes rangées ligne par ligne. Le tableau est torique : quand la
+    voiture avance, la fenêtre glisse d'un nombre entier de cellules et seules
+    les lignes/colonnes qui y entrent sont effacées, sans recopie.
+
+    A chaque image (DetectionMonde) : oubli (log-odds x GRILLE_OUBLI), rayons
+    libres de la voiture jusqu'à la face vue de chaque obstacle, puis face
+    marquée occupée sur GRILLE_EPAISSEUR_MM. Contrairement aux pistes, la grille
+    accumule plus de MAX_OBSTACLES_SIMULTANES objets au fil des images.
+    Chaque tuile compte ses cellules non nulles (l'oubli saute les tuiles
+    vides) et ses cellules occupées (les requêtes sautent les tuiles libres).
+    Accès protégés par un verrou : mise à jour par la réception caméra,
+    requêtes par les autres threads.
+*/
+
+// Appelé par publier_detection() ; sans pose valide, la grille n'est pas modifiée
+void mettre_a_jour_grille(const DetectionMonde* monde);
+
+// Balaye un couloir de demi-largeur demi_largeur le long de la polyligne
+// (x0, y0) -> pts[0] -> ... -> pts[nb - 1]. Retourne 0 à la première cellule
+// occupée, 1 si le couloir est libre jusqu'à sa fin ou au bord de la grille ;
+// *distance_libre (si non NULL) reçoit la longueur parcourue sans obstacle
+int grille_chemin_libre(float x0, float y0, const Point* pts, int nb, float demi_largeur,
+                        float* distance_libre);
+
+// Probabilité d'occupation de la cellule contenant (x, y), 0.5 hors de la grille
+float grille_probabilite(float x, float y);
+
+void reinitialiser_grille_occupation(void);
+
+#ifdef BENCH
+// Plus d'obstacles visibles que MAX_OBSTACLES_SIMULTANES, vus par sous-ensembles :
+// obstacles retenus par la grille, détection d'un chemin bloqué, coûts
+void benchmark_grille_occupation(void);
+#endif
+
+#endif
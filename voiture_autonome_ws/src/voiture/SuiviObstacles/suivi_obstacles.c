@@ -0,0 +1,374 @@
+#include <math.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <string.h>
+#include "suivi_obstacles.h"
+#include "ajustement_voie.h"
+#include "grille_occupation.h"
+#include "config.h"
+#include "logger.h"
+#include "utils.h"
+#include "voiture_globals.h"
+
+#define TAG "suivi_obstacles"
+
+#define DT_MAX_S 1.0f   // au-delà (caméra muette), la prédiction est bornée
+
+typedef struct {
+    bool active;
+    bool confirmee;
+    int id;
+    ObstacleType type;
+    float x, y, vx, vy;
+    // Covariance d'un axe (x, vx) ; identique pour (y, vy) car bruits isotropes
+    float pxx, pxv, pvv;
+    Point g, d;           // pointg / pointd relatifs au centre (dernière mesure)
+    int age, associations, manques;
+} Piste;
+
+typedef struct {
+    int piste, mesure;
+    float d2;
+} Paire;
+
+static Piste pistes[MAX_PISTES_OBSTACLES];
+static int prochain_id = 1;
+static unsigned long numero_image = 0;
+static struct timespec t_precedent;
+static bool t_valide = false;
+static pthread_mutex_t suivi_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void vers_monde(const Point* local, const PositionVoiture* pos, float c, float s, Point* monde) {
+    *monde = *local;
+    monde->x = pos->x + local->x * c - local->y * s;
+    monde->y = pos->y + local->x * s + local->y * c;
+}
+
+void point_local_vers_monde(const Point* local, const PositionVoiture* pos, Point* monde) {
+    const float th = pos->theta * (float)PI / 180.0f;
+    vers_monde(local, pos, cosf(th), sinf(th), monde);
+}
+
+void obstacle_local_vers_monde(const Obstacle* local, const PositionVoiture* pos, Obstacle* monde) {
+    const float th = pos->theta * (float)PI / 180.0f;
+    const float c = cosf(th), s = sinf(th);
+    monde->type = local->type;
+    vers_monde(&local->pointg, pos, c, s, &monde->pointg);
+    vers_monde(&local->pointd, pos, c, s, &monde->pointd);
+}
+
+void calculer_detection_monde(const DonneesDetection* det, struct timespec arrivee, DetectionMonde* monde) {
+    PositionVoiture pos;
+    memset(&pos, 0, sizeof(pos));
+    monde->pose_valide = 0;
+    if (get_position(&pos) == 0) {
+        struct timespec t_pos = get_position_last_update();
+        if (t_pos.tv_sec != TIMESPEC_UNDEFINED.tv_sec || t_pos.tv_nsec != TIMESPEC_UNDEFINED.tv_nsec) {
+            // La position date du dernier cycle de localisation : on la ramène à l'arrivée de l'image
+            float dt = (float)timespec_diff_s(t_pos, arrivee);
+            if (dt < 0.0f) dt = 0.0f;
+            if (dt > POSE_EXTRAPOLATION_MAX_S) dt = POSE_EXTRAPOLATION_MAX_S;
+            pos.x += pos.vx * dt;
+            pos.y += pos.vy * dt;
+            monde->pose_valide = 1;
+        }
+    }
+    monde->pose = pos;
+
+    const float th = pos.theta * (float)PI / 180.0f;
+    const float c = cosf(th), s = sinf(th);
+    int n = det->count < MAX_OBSTACLES_SIMULTANES ? det->count : MAX_OBSTACLES_SIMULTANES;
+    if (n < 0) n = 0;
+    monde->count = n;
+    for (int j = 0; j < n; j++) {
+        const Obstacle* o = &det->obstacle[j];
+        Point* ctr = &monde->centre[j];
+        monde->obstacle[j].type = o->type;
+        vers_monde(&o->pointg, &pos, c, s, &monde->obstacle[j].pointg);
+        vers_monde(&o->pointd, &pos, c, s, &monde->obstacle[j].pointd);
+        *ctr = o->pointg;
+        ctr->x = 0.5f * (monde->obstacle[j].pointg.x + monde->obstacle[j].pointd.x);
+        ctr->y = 0.5f * (monde->obstacle[j].pointg.y + monde->obstacle[j].pointd.y);
+        ctr->z = 0.5f * (o->pointg.z + o->pointd.z);
+    }
+
+    const MarquageSol* m = &det->marquage_sol;
+    MarquageSol* mm = &monde->marquage_sol;
+    mm->nb_points_gauche = m->nb_points_gauche < MAX_POINTS_MARQUAGE ? m->nb_points_gauche : MAX_POINTS_MARQUAGE;
+    mm->nb_points_droite = m->nb_points_droite < MAX_POINTS_MARQUAGE ? m->nb_points_droite : MAX_POINTS_MARQUAGE;
+    for (int i = 0; i < mm->nb_points_gauche; i++) vers_monde(&m->ligne_gauche[i], &pos, c, s, &mm->ligne_gauche[i]);
+    for (int i = 0; i < mm->nb_points_droite; i++) vers_monde(&m->ligne_droite[i], &pos, c, s, &mm->ligne_droite[i]);
+}
+
+void publier_detection(const DonneesDetection* det, struct timespec arrivee) {
+    DetectionMonde monde;
+    calculer_detection_monde(det, arrivee, &monde);
+    ajuster_voie(&det->marquage_sol, &monde.voie);
+    set_donnees_detection_horodatees(det, &monde, arrivee);
+    // Sans pose, les obstacles convertis avec une pose nulle fausseraient les pistes
+    if (monde.pose_valide) suivre_obstacles(&monde, arrivee);
+    mettre_a_jour_grille(&monde);
+}
+
+static void predire(Piste* p, float dt) {
+    const float q = (float)SUIVI_BRUIT_ACCEL * (float)SUIVI_BRUIT_ACCEL;
+    const float dt2 = dt * dt;
+    p->x += p->vx * dt;
+    p->y += p->vy * dt;
+    p->pxx += 2.0f * dt * p->pxv + dt2 * p->pvv + q * dt2 * dt2 / 4.0f;
+    p->pxv += dt * p->pvv + q * dt2 * dt / 2.0f;
+    p->pvv += q * dt2;
+}
+
+static void corriger(Piste* p, float mx, float my) {
+    const float r = (float)SUIVI_BRUIT_MESURE_MM * (float)SUIVI_BRUIT_MESURE_MM;
+    const float s = p->pxx + r;
+    const float kx = p->pxx / s, kv = p->pxv / s;
+    const float ex = mx - p->x, ey = my - p->y;
+    p->x += kx * ex;
+    p->y += kx * ey;
+    p->vx += kv * ex;
+    p->vy += kv * ey;
+    p->pvv -= kv * p->pxv;
+    p->pxx *= 1.0f - kx;
+    p->pxv *= 1.0f - kx;
+}
+
+static void centre(const Obstacle* o, float* cx, float* cy) {
+    *cx = 0.5f * (o->pointg.x + o->pointd.x);
+    *cy = 0.5f * (o->pointg.y + o->pointd.y);
+}
+
+static void memoriser_forme(Piste* p, const Obstacle* o, float cx, float cy) {
+    p->g = o->pointg;
+    p->d = o->pointd;
+    p->g.x -= cx; p->g.y -= cy;
+    p->d.x -= cx; p->d.y -= cy;
+}
+
+static void publier_piste(const Piste* p, EtatPiste etat, PisteObstacle* out) {
+    out->id = p->id;
+    out->type = p->type;
+    out->etat = etat;
+    out->x = p->x;
+    out->y = p->y;
+    out->vx = p->vx;
+    out->vy = p->vy;
+    out->pointg = p->g;
+    out->pointd = p->d;
+    out->pointg.x += p->x; out->pointg.y += p->y;
+    out->pointd.x += p->x; out->pointd.y += p->y;
+    out->age = p->age;
+    out->manques = p->manques;
+}
+
+/*  Une étape du suivi sur des obstacles déjà en repère monde :
+    prédiction, association gloutonne, correction, naissances et suppressions. */
+static void mettre_a_jour_pistes(const Obstacle* mesures, int n, float dt, ObstaclesSuivis* sortie) {
+    float mx[MAX_OBSTACLES_SIMULTANES], my[MAX_OBSTACLES_SIMULTANES];
+    bool mesure_prise[MAX_OBSTACLES_SIMULTANES] = { false };
+    bool piste_vue[MAX_PISTES_OBSTACLES] = { false };
+    bool terminee[MAX_PISTES_OBSTACLES] = { false };   // case à publier une dernière fois
+    EtatPiste etats[MAX_PISTES_OBSTACLES] = { 0 };
+    Paire paires[MAX_PISTES_OBSTACLES * MAX_OBSTACLES_SIMULTANES];
+    int nb_paires = 0;
+    const float porte2 = (float)SUIVI_PORTE_MM * (float)SUIVI_PORTE_MM;
+
+    for (int j = 0; j < n; j++) centre(&mesures[j], &mx[j], &my[j]);
+
+    for (int i = 0; i < MAX_PISTES_OBSTACLES; i++) {
+        if (!pistes[i].active) continue;
+        predire(&pistes[i], dt);
+        for (int j = 0; j < n; j++) {
+            if (mesures[j].type != pistes[i].type) continue;
+            float ex = mx[j] - pistes[i].x, ey = my[j] - pistes[i].y;
+            float d2 = ex * ex + ey * ey;
+            if (d2 > porte2) continue;
+            // Insertion triée : au plus MAX_PISTES x MAX_OBSTACLES paires
+            int k = nb_paires++;
+            while (k > 0 && paires[k - 1].d2 > d2) {
+                paires[k] = paires[k - 1];
+                k--;
+            }
+            paires[k] = (Paire){ i, j, d2 };
+        }
+    }
+
+    for (int k = 0; k < nb_paires; k++) {
+        Piste* p = &pistes[paires[k].piste];
+        int j = paires[k].mesure;
+        if (piste_vue[paires[k].piste] || mesure_prise[j]) continue;
+        piste_vue[paires[k].piste] = true;
+        mesure_prise[j] = true;
+        corriger(p, mx[j], my[j]);
+        memoriser_forme(p, &mesures[j], mx[j], my[j]);
+        p->manques = 0;
+        p->associations++;
+        etats[paires[k].piste] = PISTE_MISE_A_JOUR;
+        if (!p->confirmee && p->associations >= SUIVI_CONFIRMATION) {
+            p->confirmee = true;
+            etats[paires[k].piste] = PISTE_NOUVELLE;
+        }
+    }
+
+    for (int i = 0; i < MAX_PISTES_OBSTACLES; i++) {
+        Piste* p = &pistes[i];
+        if (!p->active) continue;
+        p->age++;
+        if (piste_vue[i]) continue;
+        p->manques++;
+        etats[i] = PISTE_PREDITE;
+        // Une piste non confirmée disparaît au premier manque (détection isolée)
+        if (!p->confirmee || p->manques > SUIVI_MANQUES_MAX) {
+            p->active = false;
+            terminee[i] = p->confirmee;
+        }
+    }
+
+    for (int j = 0; j < n; j++) {
+        if (mesure_prise[j]) continue;
+        int libre = -1;
+        for (int i = 0; i < MAX_PISTES_OBSTACLES && libre < 0; i++)
+            if (!pistes[i].active && !terminee[i]) libre = i;
+        if (libre < 0) break;   // plus de place : la détection attendra l'image suivante
+        Piste* p = &pistes[libre];
+        memset(p, 0, sizeof(*p));
+        p->active = true;
+        p->id = prochain_id++;
+        p->type = mesures[j].type;
+        p->x = mx[j];
+        p->y = my[j];
+        p->pxx = (float)SUIVI_BRUIT_MESURE_MM * (float)SUIVI_BRUIT_MESURE_MM;
+        p->pvv = (float)(MAX_VITESSE * MAX_VITESSE) * 4.0f;
+        p->associations = 1;
+        p->age = 1;
+        memoriser_forme(p, &mesures[j], mx[j], my[j]);
+        etats[libre] = PISTE_MISE_A_JOUR;
+        if (SUIVI_CONFIRMATION <= 1) {
+            p->confirmee = true;
+            etats[libre] = PISTE_NOUVELLE;
+        }
+    }
+
+    sortie->image = ++numero_image;
+    sortie->count = 0;
+    for (int i = 0; i < MAX_PISTES_OBSTACLES; i++) {
+        if (pistes[i].active && pistes[i].confirmee)
+            publier_piste(&pistes[i], etats[i], &sortie->piste[sortie->count++]);
+        else if (terminee[i])
+            publier_piste(&pistes[i], PISTE_TERMINEE, &sortie->piste[sortie->count++]);
+    }
+}
+
+void suivre_obstacles(const DetectionMonde* monde, struct timespec arrivee) {
+    static ObstaclesSuivis sortie;
+    pthread_mutex_lock(&suivi_mutex);
+    float dt = t_valide ? (float)timespec_diff_s(t_precedent, arrivee) : 0.0f;
+    if (dt < 0.0f) dt = 0.0f;
+    if (dt > DT_MAX_S) dt = DT_MAX_S;
+    t_precedent = arrivee;
+    t_valide = true;
+    mettre_a_jour_pistes(monde->obstacle, monde->count, dt, &sortie);
+    set_obstacles_suivis(&sortie);
+    pthread_mutex_unlock(&suivi_mutex);
+}
+
+void reinitialiser_suivi_obstacles(void) {
+    pthread_mutex_lock(&suivi_mutex);
+    memset(pistes, 0, sizeof(pistes));
+    t_valide = false;
+    pthread_mutex_unlock(&suivi_mutex);
+}
+
+#ifdef BENCH
+#define BENCH_SUIVI_IMAGES 900
+#define BENCH_SUIVI_OBJETS 3
+#define BENCH_SUIVI_DT (1.0f / 30.0f)
+
+static unsigned int graine = 12345;
+
+static float uniforme(void) {
+    graine = graine * 1103515245u + 12345u;
+    return ((graine >> 8) & 0xFFFF) / 65536.0f;
+}
+
+static float gaussienne(void) {
+    float u = uniforme() + 1e-6f, v = uniforme();
+    return sqrtf(-2.0f * logf(u)) * cosf(2.0f * (float)PI * v);
+}
+
+void benchmark_suivi_obstacles(void) {
+    // Voiture arrêtée, voiture qui s'éloigne, panneau fixe ; bruit 30 mm,
+    // 15 % de détections manquées, une fausse détection sur 10 images
+    const ObstacleType types[BENCH_SUIVI_OBJETS] = { OBSTACLE_VOITURE, OBSTACLE_VOITURE, PANNEAU_LIMITATION_30 };
+    const float x0[BENCH_SUIVI_OBJETS] = { 0.0f, 600.0f, -300.0f };
+    const float y0[BENCH_SUIVI_OBJETS] = { 800.0f, 500.0f, 1500.0f };
+    const float vx[BENCH_SUIVI_OBJETS] = { 0.0f, 0.0f, 0.0f };
+    const float vy[BENCH_SUIVI_OBJETS] = { 0.0f, 150.0f, 0.0f };
+    int id_objet[BENCH_SUIVI_OBJETS] = { 0 };
+    int changements_id = 0, fausses_pistes = 0, clignotements = 0;
+    double err_v2 = 0.0;
+    int nb_err_v = 0;
+    static ObstaclesSuivis sortie;
+    struct timespec t0, t1;
+    double t_total = 0.0;
+
+    reinitialiser_suivi_obstacles();
+    for (int k = 0; k < BENCH_SUIVI_IMAGES; k++) {
+        float t = k * BENCH_SUIVI_DT;
+        Obstacle mesures[MAX_OBSTACLES_SIMULTANES];
+        int n = 0;
+        for (int o = 0; o < BENCH_SUIVI_OBJETS; o++) {
+            if (uniforme() < 0.15f) continue;
+            float cx = x0[o] + vx[o] * t + SUIVI_BRUIT_MESURE_MM * gaussienne();
+            float cy = y0[o] + vy[o] * t + SUIVI_BRUIT_MESURE_MM * gaussienne();
+            memset(&mesures[n], 0, sizeof(Obstacle));
+            mesures[n].type = types[o];
+            mesures[n].pointg.x = cx - 70.0f; mesures[n].pointg.y = cy;
+            mesures[n].pointd.x = cx + 70.0f; mesures[n].pointd.y = cy;
+            n++;
+        }
+        if (k % 10 == 5) {
+            memset(&mesures[n], 0, sizeof(Obstacle));
+            mesures[n].type = OBSTACLE_VOITURE;
+            mesures[n].pointg.x = mesures[n].pointd.x = 2000.0f * uniforme() - 1000.0f;
+            mesures[n].pointg.y = mesures[n].pointd.y = 2000.0f * uniforme();
+            n++;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        mettre_a_jour_pistes(mesures, n, k ? BENCH_SUIVI_DT : 0.0f, &sortie);
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        t_total += timespec_diff_s(t0, t1);
+
+        // Chaque piste publiée doit correspondre à un objet réel, toujours le même
+        bool vu[BENCH_SUIVI_OBJETS] = { false };
+        for (int i = 0; i < sortie.count; i++) {
+            const PisteObstacle* p = &sortie.piste[i];
+            if (p->etat == PISTE_TERMINEE) continue;
+            int objet = -1;
+            for (int o = 0; o < BENCH_SUIVI_OBJETS; o++) {
+                float ex = p->x - (x0[o] + vx[o] * t), ey = p->y - (y0[o] + vy[o] * t);
+                if (p->type == types[o] && ex * ex + ey * ey < 150.0f * 150.0f) objet = o;
+            }
+            if (objet < 0) { fausses_pistes++; continue; }
+            vu[objet] = true;
+            if (id_objet[objet] != 0 && id_objet[objet] != p->id) changements_id++;
+            id_objet[objet] = p->id;
+            if (k > 60) {
+                float ex = p->vx - vx[objet], ey = p->vy - vy[objet];
+                err_v2 += ex * ex + ey * ey;
+                nb_err_v++;
+            }
+        }
+        for (int o = 0; o < BENCH_SUIVI_OBJETS; o++)
+            if (k > SUIVI_CONFIRMATION && !vu[o]) clignotements++;
+    }
+
+    INFO(TAG, "Suivi (%d images, %d objets, 15 %% de pertes) : %d changements d'id, %d fausses pistes, "
+              "%d absences, erreur vitesse RMS %.1f mm/s, %.2f us par image",
+         BENCH_SUIVI_IMAGES, BENCH_SUIVI_OBJETS, changements_id, fausses_pistes, clignotements,
+         nb_err_v ? sqrt(err_v2 / nb_err_v) : 0.0, t_total / BENCH_SUIVI_IMAGES * 1e6);
+    reinitialiser_suivi_obstacles();
+}
+#endif
@@ -0,0 +1,46 @@
+#ifndef SUIVI_OBSTACLES_H
+#define SUIVI_OBSTACLES_H
+
+#include <time.h>
+#include "messages.h"
+
+/*  Suivi d'obstacles entre images de détection.
+    Chaque DonneesDetection (repère voiture) est ramenée une seule fois en repère
+    monde (DetectionMonde, publiée avec les données brutes), puis associée aux pistes existantes : paires de même type
+    à moins de SUIVI_PORTE_MM, retenues de la plus proche à la plus lointaine
+    (association gloutonne). Chaque piste porte un filtre de Kalman à vitesse
+    constante sur son centre ; elle est publiée après SUIVI_CONFIRMATION
+    associations et supprimée après SUIVI_MANQUES_MAX images sans détection.
+    Le résultat est publié par set_obstacles_suivis().
+*/
+
+// Etage commun des réceptions caméra (UDP, anneau) après décodage d'une image
+// arrivée à l'instant arrivee (CLOCK_MONOTONIC) : conversion en repère monde,
+// ajustement de la voie (ajustement_voie.h), set_donnees_detection_horodatees,
+// suivre_obstacles puis grille d'occupation (grille_occupation.h), ces deux
+// derniers seulement si la pose est valide
+void publier_detection(const DonneesDetection* det, struct timespec arrivee);
+
+// Pose de la voiture à l'instant arrivee (dernière position extrapolée avec sa
+// vitesse, au plus POSE_EXTRAPOLATION_MAX_S) et conversion en repère monde des
+// obstacles, de leurs centres et du marquage au sol
+void calculer_detection_monde(const DonneesDetection* det, struct timespec arrivee, DetectionMonde* monde);
+
+// Traite une image déjà en repère monde
+void suivre_obstacles(const DetectionMonde* monde, struct timespec arrivee);
+
+// Oublie toutes les pistes (les identifiants ne sont pas réutilisés)
+void reinitialiser_suivi_obstacles(void);
+
+// Repère voiture -> repère monde (même convention que voiture_evitement.c),
+// z est conservé
+void obstacle_local_vers_monde(const Obstacle* local, const PositionVoiture* pos, Obstacle* monde);
+void point_local_vers_monde(const Point* local, const PositionVoiture* pos, Point* monde);
+
+#ifdef BENCH
+// Scénario synthétique (bruit, pertes, fausses détections) : changements
+// d'identifiant, fausses pistes, erreur de vitesse et coût par image
+void benchmark_suivi_obstacles(void);
+#endif
+
+#endif
@@ -79,6 +79,20 @@ int find_closest_point(PositionVoiture pv, Trajectoire traj) {
     return closest_point_id;
 }
 
+// Minimum local en avançant depuis start : la voiture ne recule pas le long de la trajectoire
+int find_closest_point_from(PositionVoiture pv, Trajectoire traj, int start) {
+    if (start < 0 || start >= traj.nb_points) return find_closest_point(pv, traj);
+    int closest_point_id = start;
+    float best_dist = distance_from_car(pv, traj.points[start]);
+    for (int i = start + 1; i < traj.nb_points; i++) {
+        float new_dist = distance_from_car(pv, traj.points[i]);
+        if (new_dist >= best_dist) break;
+        best_dist = new_dist;
+        closest_point_id = i;
+    }
+    return closest_point_id;
+}
+
 int is_point_overtaken(PositionVoiture voiture, Point p) {
     float scalar_prod = (voiture.x - p.x) * cosf(p.theta) + (voiture.y - p.y) * sinf(p.theta);
     return scalar_prod >= 0;
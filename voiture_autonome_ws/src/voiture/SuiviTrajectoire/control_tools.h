@@ -16,6 +16,7 @@ Point eval_polynome_relative(Polynome poly, float x);
 Point eval_polynome_absolute(Polynome poly, float x, PositionVoiture pv);
 
 int find_closest_point(PositionVoiture pv, Trajectoire traj);
+int find_closest_point_from(PositionVoiture pv, Trajectoire traj, int start);
 
 int is_point_overtaken(PositionVoiture voiture, Point p);
 
@@ -25,6 +25,29 @@ float omega_ref;
 float v_ref;
 struct timespec last_lost_warn = {0};
 
+// Etat gardé tant que la trajectoire gagnante ne change pas (même Trajectoire.sequence) :
+// point le plus proche, dans le chemin partagé (stable quand la fenêtre avance)
+static struct {
+    bool valide;
+    unsigned int sequence;
+    const Point* closest;
+} cache;
+
+static void update_cache(Trajectoire traj) {
+    if (!cache.valide || traj.sequence != cache.sequence) {
+        cache.valide = true;
+        cache.sequence = traj.sequence;
+        cache.closest = NULL;
+    }
+}
+
+static int find_closest_point_cached(PositionVoiture voiture, Trajectoire traj) {
+    int start = cache.closest ? (int)(cache.closest - traj.points) : -1;
+    int id = find_closest_point_from(voiture, traj, start);
+    cache.closest = &traj.points[id];
+    return id;
+}
+
 
 // Loi de commande
 float compute_omega(float v_ref) {
@@ -48,11 +71,12 @@ void compute_frenet_coordinates_using_closest_point_only(PositionVoiture voiture
     theta_e = voiture.theta - p.theta; 
 }
 
+// Les update_consignes_* calculent omega_ref (et v_ref à l'arrêt) sans envoyer :
+// un seul send_order() par tick, dans lancer_suivi_trajectoire()
 void update_consignes_closest_point_only(PositionVoiture voiture, Trajectoire traj) {
-    int closest_point_id = find_closest_point(voiture, traj);
+    int closest_point_id = find_closest_point_cached(voiture, traj);
     compute_frenet_coordinates_using_closest_point_only(voiture, traj.points[closest_point_id]);
     omega_ref = compute_omega(traj.vitesse);
-    send_order();
 }
 
 
@@ -103,20 +127,21 @@ Point move_linear_point(Point p, float distance) {
 
 
 
-// Calcul des erreurs latérale et angulaire
-void update_consignes_newton(PositionVoiture voiture, Trajectoire traj) {
+// Calcul des erreurs latérale et angulaire ; retourne false si la voiture est
+// trop loin de la trajectoire pour la projection (repli sur le point le plus proche)
+bool update_consignes_newton(PositionVoiture voiture, Trajectoire traj) {
     int closest_point_id;
     Point closest_point;
     Point p_previous;
     Point p_next;
-    closest_point_id = find_closest_point(voiture, traj);
+    closest_point_id = find_closest_point_cached(voiture, traj);
     closest_point = traj.points[closest_point_id];
     float dist_from_closest = distance_from_car(voiture, closest_point);
 
     if (closest_point_id == traj.nb_points-1 && is_point_overtaken(voiture, traj.points[closest_point_id])) {
-        send_order_stop();
+        v_ref = 0;
         WARN(TAG, "Trajectoire dépassée (distance du dernier point = %1.f)", dist_from_closest);
-        return;
+        return true;
     }
     // Calcul de p_previous et p_next
     if (closest_point_id == 0 && !is_point_overtaken(voiture, traj.points[closest_point_id])) {
@@ -129,6 +154,7 @@ void update_consignes_newton(PositionVoiture voiture, Trajectoire traj) {
             clock_gettime(CLOCK_MONOTONIC, &t_now);
             if (timespec_diff_s(last_lost_warn, t_now) > MIN_DELAY_BEETWEEN_LOST_WARNS_S)
                 WARN(TAG, "Voiture perdue, plus proche point de la traj à %1.f mm", dist_from_closest);
+            return false;
         } else{
             // Cas général
             if (is_point_overtaken(voiture, closest_point)) {
@@ -145,7 +171,7 @@ void update_consignes_newton(PositionVoiture voiture, Trajectoire traj) {
     Point p_projette_abs = compute_projection_using_l1(voiture, p_previous, poly);
     compute_errors(voiture, p_projette_abs);
     omega_ref = compute_omega(traj.vitesse);
-    send_order();
+    return true;
 }
 
 
@@ -157,9 +183,16 @@ void* lancer_suivi_trajectoire(void* arg) {
     while(running_traj) {
         Trajectoire traj; 
         PositionVoiture voiture;
-        get_trajectoire(&traj);
-        update_consignes_newton(voiture, traj);
-        update_consignes_closest_point_only(voiture, traj);
+        // Vue sur le chemin partagé : gardée jusqu'à rendre_trajectoire()
+        if (get_trajectoire(&traj) == 0) {
+            if (traj.nb_points > 0) {
+                update_cache(traj);
+                if (!update_consignes_newton(voiture, traj))
+                    update_consignes_closest_point_only(voiture, traj);
+                send_order();
+            }
+            rendre_trajectoire(&traj);
+        }
 
         my_sleep(1.0f/UPDATE_MOTOR_FREQ_HZ);
     }
@@ -11,6 +11,7 @@ void* lancer_suivi_trajectoire(void* arg);
 
 // Fonctions externes à implémenter dans ton environnement :
 int get_trajectoire(Trajectoire* t);
+void rendre_trajectoire(Trajectoire* t);
 int get_position(PositionVoiture* p);
 void set_motor_speed(float v_left, float v_right);
 
@@ -16,15 +16,31 @@
 #include "UDP_voiture.h"
 #include "Gestion_comportement.h"
 #include "suivi_trajectoire.h"
+#include "reacteur.h"
+#include "anneau_detection.h"
+#ifdef BENCH
+#include "filtre_particules.h"
+#include "multilateration.h"
+#include "parseur_capteurs.h"
+#include "parseur_detection.h"
+#include "datagramme_detection.h"
+#include "suivi_obstacles.h"
+#include "ajustement_voie.h"
+#include "grille_occupation.h"
+#include "planificateur_treillis.h"
+#include "collision_boites.h"
+#endif
 
 #define TAG "main"
 
 pthread_t thread_localisation;
 pthread_t thread_communication_tcp;
 pthread_t thread_communication_udp;
+pthread_t thread_anneau_detection;
 pthread_t thread_communication_serie;
 pthread_t thread_gestion_comportement;
 pthread_t thread_suivi_trajectoire;
+pthread_t thread_reacteur;
 
 #ifdef SIMULATION
 pthread_t thread_simulation;
@@ -72,6 +88,30 @@ int main(int argc, char *argv[]) {
     // Initialisation des variables globales
     init_voiture_globals();
 
+#if USE_REACTEUR
+    // Réacteur epoll : les modules d'entrées/sorties s'y enregistrent au lieu de lancer un thread
+    if (init_reacteur() != 0)
+        WARN(TAG, "Réacteur indisponible, retour aux threads d'entrées/sorties");
+#endif
+
+#ifdef BENCH
+    benchmark_filtre_particules();
+    benchmark_multilateration();
+    benchmark_parseur_capteurs();
+    benchmark_communication_serie();
+    benchmark_parseur_detection();
+    benchmark_datagramme_detection();
+    benchmark_anneau_detection();
+    benchmark_suivi_obstacles();
+    benchmark_ajustement_voie();
+    benchmark_grille_occupation();
+    benchmark_generation_trajectoire();
+    benchmark_projection_obstacles();
+    benchmark_planificateur_treillis();
+    benchmark_collision_boites();
+    return 0;
+#endif
+
     // Lancement de la localisation
     if (pthread_create(&thread_localisation, NULL, lancer_localisation_thread, NULL) != 0) {
         perror("Erreur pthread_create localisation");
@@ -79,9 +119,11 @@ int main(int argc, char *argv[]) {
     }
 
     // Lancement de la communication TCP avec le contrôleur
-    if (pthread_create(&thread_communication_tcp, NULL, initialisation_communication_voiture, NULL) != 0) {
-        perror("Erreur pthread_create init communication tcp");
-        return EXIT_FAILURE;
+    if (!reacteur_actif() || enregistrer_communication_voiture() != 0) {
+        if (pthread_create(&thread_communication_tcp, NULL, initialisation_communication_voiture, NULL) != 0) {
+            perror("Erreur pthread_create init communication tcp");
+            return EXIT_FAILURE;
+        }
     }
 
 #if USE_SERIAL
@@ -94,14 +136,29 @@ int main(int argc, char *argv[]) {
     INFO(TAG, "Communication série désactivée (USE_SERIAL=0)");
 #endif
 
-    // Lancement du thread UDP
-    if (pthread_create(&thread_communication_udp, NULL, initialisation_communication_camera, NULL) != 0) {
+    // Lancement de la réception UDP (réacteur, sinon thread dédié)
+    bool udp_reacteur = reacteur_actif() && enregistrer_communication_camera() == 0;
+    if (!udp_reacteur && pthread_create(&thread_communication_udp, NULL, initialisation_communication_camera, NULL) != 0) {
         perror("Erreur pthread_create lancer communication udp");
         return EXIT_FAILURE;
     } else {
         printf("Connexion UDP avec la caméra bien lancée\n");
     }
 
+#if USE_ANNEAU_DETECTION
+    // Transport optionnel des détections par mémoire partagée, en plus de l'UDP
+    if (pthread_create(&thread_anneau_detection, NULL, lancer_anneau_detection, NULL) != 0) {
+        perror("Erreur pthread_create lancer anneau detection");
+        return EXIT_FAILURE;
+    }
+#endif
+
+    // Le réacteur tourne dans son propre thread une fois les sources enregistrées
+    if (reacteur_actif() && pthread_create(&thread_reacteur, NULL, lancer_reacteur, NULL) != 0) {
+        perror("Erreur pthread_create lancer reacteur");
+        return EXIT_FAILURE;
+    }
+
     // Attente de la connexion
     printf("En attente de la connexion avec le contrôleur...\n");
     while (!est_connectee()) {
@@ -143,10 +200,17 @@ int main(int argc, char *argv[]) {
     */
    
     // Attendre la fin du thread (ici il tourne en boucle infinie)
-    pthread_join(thread_communication_udp, NULL);
+    if (reacteur_actif())
+        pthread_join(thread_reacteur, NULL);
+    else
+        pthread_join(thread_communication_udp, NULL);
     
     getchar();
     stop_comportement();
+#if USE_ANNEAU_DETECTION
+    arreter_anneau_detection();
+    pthread_join(thread_anneau_detection, NULL);
+#endif
 #if USE_SERIAL
     stop_communication_serie();
 #endif
@@ -27,7 +27,13 @@ GlobalsVoiture g = {
     .etat_voiture.mutex = PTHREAD_MUTEX_INITIALIZER,
     .position_voiture.mutex = PTHREAD_MUTEX_INITIALIZER,
     .trajectoire.mutex = PTHREAD_MUTEX_INITIALIZER,
-    .donnees_detection.mutex = PTHREAD_MUTEX_INITIALIZER
+    .trajectoire.data.chemin = -1,
+    .chemins.mutex = PTHREAD_MUTEX_INITIALIZER,
+    .donnees_detection.mutex = PTHREAD_MUTEX_INITIALIZER,
+    .obstacles_suivis.mutex = PTHREAD_MUTEX_INITIALIZER,
+    .sensor_data.mutex = PTHREAD_MUTEX_INITIALIZER,
+    .position_carte.mutex = PTHREAD_MUTEX_INITIALIZER,
+    .position_carte.data.arc_id = -1
 };
 
 
@@ -40,7 +46,11 @@ void init_voiture_globals(void) {
     pthread_mutex_init(&g.etat_voiture.mutex, NULL);
     pthread_mutex_init(&g.position_voiture.mutex, NULL);
     pthread_mutex_init(&g.trajectoire.mutex, NULL);
+    pthread_mutex_init(&g.chemins.mutex, NULL);
     pthread_mutex_init(&g.donnees_detection.mutex, NULL);
+    pthread_mutex_init(&g.obstacles_suivis.mutex, NULL);
+    pthread_mutex_init(&g.sensor_data.mutex, NULL);
+    pthread_mutex_init(&g.position_carte.mutex, NULL);
 
     g.itineraire.last_update = TIMESPEC_UNDEFINED;
     g.consigne.last_update = TIMESPEC_UNDEFINED;
@@ -49,6 +59,9 @@ void init_voiture_globals(void) {
     g.position_voiture.last_update = TIMESPEC_UNDEFINED;
     g.trajectoire.last_update = TIMESPEC_UNDEFINED;
     g.donnees_detection.last_update = TIMESPEC_UNDEFINED;
+    g.obstacles_suivis.last_update = TIMESPEC_UNDEFINED;
+    g.sensor_data.last_update = TIMESPEC_UNDEFINED;
+    g.position_carte.last_update = TIMESPEC_UNDEFINED;
 
     initialized = 1;
 }
@@ -57,9 +70,15 @@ void init_voiture_globals(void) {
 
 // Itineraire
 int set_itineraire(const Itineraire* t) {
-    if (check_initialized() != 0 || !t) return -1;
+    static AnnotationItineraire vide;
+    return set_itineraire_annote(t, &vide);
+}
+
+int set_itineraire_annote(const Itineraire* t, const AnnotationItineraire* a) {
+    if (check_initialized() != 0 || !t || !a) return -1;
     pthread_mutex_lock(&g.itineraire.mutex);
     g.itineraire.data = *t;
+    g.itineraire.annotation = *a;
     clock_gettime(CLOCK_MONOTONIC, &g.itineraire.last_update);
     pthread_mutex_unlock(&g.itineraire.mutex);
     return 0;
@@ -73,6 +92,15 @@ int get_itineraire(Itineraire* t) {
     return 0;
 }
 
+int get_itineraire_annote(Itineraire* t, AnnotationItineraire* a) {
+    if (check_initialized() != 0 || !t || !a) return -1;
+    pthread_mutex_lock(&g.itineraire.mutex);
+    *t = g.itineraire.data;
+    *a = g.itineraire.annotation;
+    pthread_mutex_unlock(&g.itineraire.mutex);
+    return 0;
+}
+
 struct timespec get_itineraire_last_update(void) {
     struct timespec ts = TIMESPEC_UNDEFINED;
     pthread_mutex_lock(&g.itineraire.mutex);
@@ -185,13 +213,51 @@ struct timespec get_position_last_update(void) {
     return ts;
 }
 
+// Chemins partagés
+int reserver_chemin(Point** points) {
+    if (check_initialized() != 0 || !points) return -1;
+    int id = -1;
+    pthread_mutex_lock(&g.chemins.mutex);
+    for (int i = 0; i < NB_CHEMINS_PARTAGES; i++) {
+        if (g.chemins.chemin[i].refs == 0) {
+            g.chemins.chemin[i].refs = 1;
+            id = i;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g.chemins.mutex);
+    if (id < 0) {
+        WARN(TAG, "Aucun chemin partagé libre (%d détenus)", NB_CHEMINS_PARTAGES);
+        return -1;
+    }
+    *points = g.chemins.chemin[id].points;
+    return id;
+}
+
+void prendre_chemin(int id) {
+    if (id < 0 || id >= NB_CHEMINS_PARTAGES) return;
+    pthread_mutex_lock(&g.chemins.mutex);
+    g.chemins.chemin[id].refs++;
+    pthread_mutex_unlock(&g.chemins.mutex);
+}
+
+void rendre_chemin(int id) {
+    if (id < 0 || id >= NB_CHEMINS_PARTAGES) return;
+    pthread_mutex_lock(&g.chemins.mutex);
+    if (g.chemins.chemin[id].refs > 0) g.chemins.chemin[id].refs--;
+    pthread_mutex_unlock(&g.chemins.mutex);
+}
+
 // Trajectoire
 int set_trajectoire(const Trajectoire* t) {
     if (check_initialized() != 0 || !t) return -1;
+    prendre_chemin(t->chemin);
     pthread_mutex_lock(&g.trajectoire.mutex);
+    int ancien = g.trajectoire.data.chemin;
     g.trajectoire.data = *t;
     clock_gettime(CLOCK_MONOTONIC, &g.trajectoire.last_update);
     pthread_mutex_unlock(&g.trajectoire.mutex);
+    rendre_chemin(ancien);
     return 0;
 }
 
@@ -199,10 +265,19 @@ int get_trajectoire(Trajectoire* t) {
     if (check_initialized() != 0 || !t) return -1;
     pthread_mutex_lock(&g.trajectoire.mutex);
     *t = g.trajectoire.data;
+    prendre_chemin(t->chemin);
     pthread_mutex_unlock(&g.trajectoire.mutex);
     return 0;
 }
 
+void rendre_trajectoire(Trajectoire* t) {
+    if (!t) return;
+    rendre_chemin(t->chemin);
+    t->chemin = -1;
+    t->points = NULL;
+    t->nb_points = 0;
+}
+
 struct timespec get_trajectoire_last_update(void) {
     struct timespec ts = TIMESPEC_UNDEFINED;
     pthread_mutex_lock(&g.trajectoire.mutex);
@@ -213,10 +288,19 @@ struct timespec get_trajectoire_last_update(void) {
 
 // DonneesDetection
 int set_donnees_detection(const DonneesDetection* t) {
-    if (check_initialized() != 0 || !t) return -1;
+    static DetectionMonde vide;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return set_donnees_detection_horodatees(t, &vide, now);
+}
+
+int set_donnees_detection_horodatees(const DonneesDetection* t, const DetectionMonde* monde,
+                                     struct timespec arrivee) {
+    if (check_initialized() != 0 || !t || !monde) return -1;
     pthread_mutex_lock(&g.donnees_detection.mutex);
     g.donnees_detection.data = *t;
-    clock_gettime(CLOCK_MONOTONIC, &g.donnees_detection.last_update);
+    g.donnees_detection.monde = *monde;
+    g.donnees_detection.last_update = arrivee;
     pthread_mutex_unlock(&g.donnees_detection.mutex);
     return 0;
 }
@@ -229,6 +313,14 @@ int get_donnees_detection(DonneesDetection* t) {
     return 0;
 }
 
+int get_detection_monde(DetectionMonde* t) {
+    if (check_initialized() != 0 || !t) return -1;
+    pthread_mutex_lock(&g.donnees_detection.mutex);
+    *t = g.donnees_detection.monde;
+    pthread_mutex_unlock(&g.donnees_detection.mutex);
+    return 0;
+}
+
 struct timespec get_donnees_detection_last_update(void) {
     struct timespec ts = TIMESPEC_UNDEFINED;
     pthread_mutex_lock(&g.donnees_detection.mutex);
@@ -239,6 +331,32 @@ struct timespec get_donnees_detection_last_update(void) {
 
 
 
+// ObstaclesSuivis
+int set_obstacles_suivis(const ObstaclesSuivis* t) {
+    if (check_initialized() != 0 || !t) return -1;
+    pthread_mutex_lock(&g.obstacles_suivis.mutex);
+    g.obstacles_suivis.data = *t;
+    clock_gettime(CLOCK_MONOTONIC, &g.obstacles_suivis.last_update);
+    pthread_mutex_unlock(&g.obstacles_suivis.mutex);
+    return 0;
+}
+
+int get_obstacles_suivis(ObstaclesSuivis* t) {
+    if (check_initialized() != 0 || !t) return -1;
+    pthread_mutex_lock(&g.obstacles_suivis.mutex);
+    *t = g.obstacles_suivis.data;
+    pthread_mutex_unlock(&g.obstacles_suivis.mutex);
+    return 0;
+}
+
+struct timespec get_obstacles_suivis_last_update(void) {
+    struct timespec ts = TIMESPEC_UNDEFINED;
+    pthread_mutex_lock(&g.obstacles_suivis.mutex);
+    ts = g.obstacles_suivis.last_update;
+    pthread_mutex_unlock(&g.obstacles_suivis.mutex);
+    return ts;
+}
+
 // SensorData
 int set_sensor_data(const SensorData* t) {
     if (check_initialized() != 0 || !t) return -1;
@@ -263,4 +381,31 @@ struct timespec get_sensor_data_last_update(void) {
     ts = g.sensor_data.last_update;
     pthread_mutex_unlock(&g.sensor_data.mutex);
     return ts;
+}
+
+
+// PositionCarte
+int set_position_carte(const PositionCarte* t) {
+    if (check_initialized() != 0 || !t) return -1;
+    pthread_mutex_lock(&g.position_carte.mutex);
+    g.position_carte.data = *t;
+    clock_gettime(CLOCK_MONOTONIC, &g.position_carte.last_update);
+    pthread_mutex_unlock(&g.position_carte.mutex);
+    return 0;
+}
+
+int get_position_carte(PositionCarte* t) {
+    if (check_initialized() != 0 || !t) return -1;
+    pthread_mutex_lock(&g.position_carte.mutex);
+    *t = g.position_carte.data;
+    pthread_mutex_unlock(&g.position_carte.mutex);
+    return 0;
+}
+
+struct timespec get_position_carte_last_update(void) {
+    struct timespec ts = TIMESPEC_UNDEFINED;
+    pthread_mutex_lock(&g.position_carte.mutex);
+    ts = g.position_carte.last_update;
+    pthread_mutex_unlock(&g.position_carte.mutex);
+    return ts;
 }
\ No newline at end of file
@@ -13,8 +13,11 @@ extern const struct timespec TIMESPEC_UNDEFINED;
 /* ==== Prototypes des fonctions ==== */
 
 // Itineraire
-int set_itineraire(const Itineraire* t);
+int set_itineraire(const Itineraire* t);   // sans annotation (aucun intervalle)
+// Itinéraire et son annotation (cf. annotation_itineraire.h), publiés et lus ensemble
+int set_itineraire_annote(const Itineraire* t, const AnnotationItineraire* a);
 int get_itineraire(Itineraire* t);
+int get_itineraire_annote(Itineraire* t, AnnotationItineraire* a);
 struct timespec get_itineraire_last_update(void);
 
 // Consigne
@@ -37,21 +40,44 @@ int set_position(const PositionVoiture* t);
 int get_position(PositionVoiture* t);
 struct timespec get_position_last_update(void);
 
+// Chemins partagés : points écrits une fois par leur producteur, puis lus sans
+// copie à travers les Trajectoire qui pointent dedans. Un chemin n'est réutilisé
+// que lorsque tous ses détenteurs l'ont rendu.
+int reserver_chemin(Point** points);   // identifiant (référence détenue) ou -1 ; MAX_POINTS_CHEMIN points
+void prendre_chemin(int id);
+void rendre_chemin(int id);
+
 // Trajectoire
-int set_trajectoire(const Trajectoire* t);
-int get_trajectoire(Trajectoire* t);
+int set_trajectoire(const Trajectoire* t);   // prend une référence sur t->chemin
+int get_trajectoire(Trajectoire* t);         // idem : rendre_trajectoire() après usage
+void rendre_trajectoire(Trajectoire* t);
 struct timespec get_trajectoire_last_update(void);
 
 // DonneesDetection
-int set_donnees_detection(const DonneesDetection* t);
+int set_donnees_detection(const DonneesDetection* t);   // sans repère monde (pose_valide = 0)
+// Données brutes et leur conversion en repère monde, publiées ensemble ;
+// last_update = instant d'arrivée du datagramme (CLOCK_MONOTONIC) plutôt que l'instant du décodage
+int set_donnees_detection_horodatees(const DonneesDetection* t, const DetectionMonde* monde,
+                                     struct timespec arrivee);
 int get_donnees_detection(DonneesDetection* t);
+int get_detection_monde(DetectionMonde* t);
 struct timespec get_donnees_detection_last_update(void);
 
+// ObstaclesSuivis
+int set_obstacles_suivis(const ObstaclesSuivis* t);
+int get_obstacles_suivis(ObstaclesSuivis* t);
+struct timespec get_obstacles_suivis_last_update(void);
+
 // SensorData
 int set_sensor_data(const SensorData* t);
 int get_sensor_data(SensorData* t);
 struct timespec get_sensor_data_last_update(void);
 
+// PositionCarte
+int set_position_carte(const PositionCarte* t);
+int get_position_carte(PositionCarte* t);
+struct timespec get_position_carte_last_update(void);
+
 void init_voiture_globals(void);
 
 
@@ -60,6 +86,7 @@ void init_voiture_globals(void);
 typedef struct {
     pthread_mutex_t mutex;
     Itineraire data;
+    AnnotationItineraire annotation;
     struct timespec last_update;
 } GlobalItineraire;
 
@@ -93,18 +120,41 @@ typedef struct {
     struct timespec last_update;
 } GlobalTrajectoire;
 
+typedef struct {
+    int refs;                  // 0 : libre
+    Point points[MAX_POINTS_CHEMIN];
+} CheminPartage;
+
+typedef struct {
+    pthread_mutex_t mutex;
+    CheminPartage chemin[NB_CHEMINS_PARTAGES];
+} GlobalChemins;
+
 typedef struct {
     pthread_mutex_t mutex;
     DonneesDetection data;
+    DetectionMonde monde;      // calculé une fois à la réception, à côté de data
     struct timespec last_update;
 } GlobalDonneesDetection;
 
+typedef struct {
+    pthread_mutex_t mutex;
+    ObstaclesSuivis data;
+    struct timespec last_update;
+} GlobalObstaclesSuivis;
+
 typedef struct {
     pthread_mutex_t mutex;
     SensorData data;
     struct timespec last_update;
 } GlobalSensorData;
 
+typedef struct {
+    pthread_mutex_t mutex;
+    PositionCarte data;
+    struct timespec last_update;
+} GlobalPositionCarte;
+
 /* ==== Instance unique de toutes les variables globales ==== */
 typedef struct {
     GlobalItineraire itineraire;
@@ -113,8 +163,11 @@ typedef struct {
     GlobalEtat etat_voiture;
     GlobalPosition position_voiture;
     GlobalTrajectoire trajectoire;
+    GlobalChemins chemins;
     GlobalDonneesDetection donnees_detection;
+    GlobalObstaclesSuivis obstacles_suivis;
     GlobalSensorData sensor_data;
+    GlobalPositionCarte position_carte;
 } GlobalsVoiture;
 extern GlobalsVoiture g;
 